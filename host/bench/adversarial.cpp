@@ -0,0 +1,99 @@
+#include "adversarial.h"
+#include <string.h>
+
+#define ON   255
+#define OFF  0
+
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+const char *adv_pattern_name(adv_pattern_t p)
+{
+    switch (p) {
+        case ADV_FULL:      return "full";
+        case ADV_CHECKER:   return "checker";
+        case ADV_CHECKER2:  return "checker2";
+        case ADV_DIAG_UP:   return "diag_up";
+        case ADV_DIAG_DOWN: return "diag_down";
+        case ADV_COMB:      return "comb";
+        case ADV_STAIRS:    return "stairs";
+        case ADV_SPECKLE:   return "speckle";
+        case ADV_STREAKS:   return "streaks";
+        default:            return "?";
+    }
+}
+
+void adv_render(adv_pattern_t p, int width, int height, uint32_t seed, uint8_t *out)
+{
+    uint32_t rng = seed * 2654435761u + 1;
+    if (rng == 0) rng = 1;
+
+    switch (p) {
+        case ADV_FULL:
+            memset(out, ON, (size_t)width * height);
+            return;
+
+        case ADV_CHECKER:
+        case ADV_CHECKER2: {
+            int sh = p == ADV_CHECKER ? 0 : 1;
+            for (int y = 0; y < height; y++)
+                for (int x = 0; x < width; x++)
+                    out[y * width + x] = (((x >> sh) + (y >> sh)) & 1) ? ON : OFF;
+            return;
+        }
+
+        case ADV_DIAG_UP:
+        case ADV_DIAG_DOWN:
+            for (int y = 0; y < height; y++)
+                for (int x = 0; x < width; x++) {
+                    int d = p == ADV_DIAG_UP ? x + y : x - y + 3 * height;
+                    out[y * width + x] = (d % 3 == 0) ? ON : OFF;
+                }
+            return;
+
+        case ADV_COMB:
+            // Every tooth starts its own label in row 0; all of them are
+            // unioned only when the scan reaches the bar at the bottom
+            for (int y = 0; y < height; y++)
+                for (int x = 0; x < width; x++)
+                    out[y * width + x] = (y >= height - 2 || (x & 1) == 0) ? ON : OFF;
+            return;
+
+        case ADV_STAIRS:
+            // Tooth k starts k rows lower, so each new row opens one more
+            // label beside an older tree; the bottom bar merges them all
+            for (int y = 0; y < height; y++)
+                for (int x = 0; x < width; x++) {
+                    bool tooth = (x & 1) == 0 && y >= (x >> 1) % (height - 2);
+                    out[y * width + x] = (y >= height - 2 || tooth) ? ON : OFF;
+                }
+            return;
+
+        case ADV_SPECKLE:
+            for (int i = 0; i < width * height; i++)
+                out[i] = (xorshift32(&rng) & 3) == 0 ? ON : OFF;
+            return;
+
+        case ADV_STREAKS:
+            memset(out, OFF, (size_t)width * height);
+            for (int n = width * height / 24; n > 0; n--) {
+                uint32_t r = xorshift32(&rng);
+                int x   = (int)(r % (uint32_t)width);
+                int y   = (int)((r >> 8) % (uint32_t)height);
+                int len = 3 + (int)(xorshift32(&rng) % 6);
+                for (int k = 0; k < len && y + k < height; k++) out[(y + k) * width + x] = ON;
+            }
+            return;
+
+        default:
+            memset(out, OFF, (size_t)width * height);
+            return;
+    }
+}
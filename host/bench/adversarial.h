@@ -0,0 +1,32 @@
+#ifndef HOST_ADVERSARIAL_H
+#define HOST_ADVERSARIAL_H
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Worst-case input patterns for the connected-component labeller in
+// detect_blobs(). Each stresses a different part of it: label allocation
+// (and MAX_LABELS exhaustion), union-find merges and tree depth, or the
+// per-pixel neighbour scan. All are fully above BRIGHTNESS_THRESHOLD or at 0
+// so the threshold itself never hides the structure.
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    ADV_FULL = 0,       // Every pixel bright — one label, max pass-2 work
+    ADV_CHECKER,        // 1 px checkerboard — diagonal merges on every pixel
+    ADV_CHECKER2,       // 2 px checkerboard — blocks joined only at corners
+    ADV_DIAG_UP,        // "/" stripes, 1 px on / 2 px off
+    ADV_DIAG_DOWN,      // "\" stripes, 1 px on / 2 px off
+    ADV_COMB,           // 1 px teeth hanging from a bottom bar: width/2 labels merged late
+    ADV_STAIRS,         // Teeth of decreasing length joined at the bottom: merge chains
+    ADV_SPECKLE,        // Rain-like random single pixels (25 % fill): label exhaustion
+    ADV_STREAKS,        // Rain streaks: short random vertical runs
+    ADV_COUNT
+} adv_pattern_t;
+
+const char *adv_pattern_name(adv_pattern_t p);
+
+/** Render pattern `p` (width * height bytes). `seed` varies the random ones. */
+void adv_render(adv_pattern_t p, int width, int height, uint32_t seed, uint8_t *out);
+
+#endif // HOST_ADVERSARIAL_H
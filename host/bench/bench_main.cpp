@@ -0,0 +1,619 @@
+// ---------------------------------------------------------------------------
+// camtest_bench — host throughput benchmark for the detection pipeline
+//
+// Reports ns/frame and frames/s for detect_blobs(), tracker_classify() and
+// triangulate_distance() over synthetic scenes at QVGA, VGA, SVGA and UXGA,
+// plus any recorded inputs passed on the command line (.cfr recordings or
+// single-frame binary PGMs).
+//
+// Stages "labelmap" and "bitplane" time the two detect_blobs() labelling
+// paths directly, whichever one DETECTOR_BITPLANE selects for "detect";
+// "generic" is the label-map path with the unspecialised pass-1 kernel.
+// Label-map runs add a line with the 8/16-bit label width mix and the
+// label-map bytes allocated per frame.
+//
+// --worst instead times detect_blobs() frame by frame on adversarial
+// patterns (bench/adversarial.h) and reports the per-frame maximum in ns and
+// CPU cycles, next to a typical night scene, to bound the frame deadline.
+//
+//   camtest_bench [--res QVGA,VGA,SVGA,UXGA]
+//                 [--stage detect,labelmap,generic,bitplane,track,tri] [--frames N]
+//                 [--min-ms N] [--no-synth] [ride.cfr | frame.pgm ...]
+//   camtest_bench --worst [--res ...] [--frames N] [--min-ms N]
+// ---------------------------------------------------------------------------
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+#include "detector.h"
+#include "triangulation.h"
+
+#include "adversarial.h"
+#include "host_time.h"
+#include "pgm.h"
+#include "rec_file.h"
+#include "synth.h"
+
+typedef struct {
+    const char *name;
+    int width;
+    int height;
+} bench_res_t;
+
+static const bench_res_t k_resolutions[] = {
+    { "QVGA",  320,  240 },
+    { "VGA",   640,  480 },
+    { "SVGA",  800,  600 },
+    { "UXGA", 1600, 1200 },
+};
+#define NUM_RESOLUTIONS (int)(sizeof(k_resolutions) / sizeof(k_resolutions[0]))
+
+// A set of frames sharing one geometry — either rendered or loaded from disk
+typedef struct {
+    char      label[64];
+    char      res_name[16];
+    int       width;
+    int       height;
+    int       count;
+    uint8_t **frames;
+} frame_set_t;
+
+typedef struct {
+    bool     res_enabled[NUM_RESOLUTIONS];
+    bool     run_detect;
+    bool     run_labelmap;
+    bool     run_bitplane;
+    bool     run_generic;
+    bool     run_track;
+    bool     run_tri;
+    bool     no_synth;
+    bool     worst;
+    int      synth_frames;
+    uint64_t min_ns;
+} bench_opts_t;
+
+// Keeps results observable so the optimiser cannot discard benchmark work
+static volatile uint32_t g_sink;
+
+// ---------------------------------------------------------------------------
+// Reporting
+// ---------------------------------------------------------------------------
+static void print_header(void)
+{
+    printf("%-8s %-14s %-6s %9s %8s %12s %12s\n",
+           "stage", "input", "res", "size", "frames", "ns/frame", "frames/s");
+}
+
+static void print_row(const char *stage, const frame_set_t *set,
+                      uint64_t total_ns, uint64_t iterations)
+{
+    double ns_per = (double)total_ns / (double)iterations;
+    char size[24];
+    snprintf(size, sizeof(size), "%dx%d", set->width, set->height);
+    printf("%-8s %-14s %-6s %9s %8llu %12.0f %12.1f\n",
+           stage, set->label, set->res_name, size,
+           (unsigned long long)iterations, ns_per, 1e9 / ns_per);
+}
+
+// ---------------------------------------------------------------------------
+// Stage benchmarks
+// ---------------------------------------------------------------------------
+typedef void (*detect_fn_t)(const uint8_t *, int, int, detection_result_t *);
+
+static void bench_detect(const char *stage, detect_fn_t detect,
+                         const frame_set_t *set, const bench_opts_t *opts)
+{
+    detection_result_t result;
+
+    // Warm-up: one pass over the set (page faults, allocator, caches), also
+    // tallying label-map widths for the bandwidth line below
+    int frames8 = 0, promotions = 0;
+    uint64_t map_bytes = 0;
+    uint64_t px = (uint64_t)set->width * (uint64_t)set->height;
+    for (int i = 0; i < set->count; i++) {
+        detect(set->frames[i], set->width, set->height, &result);
+        if (result.label_bits == 8) frames8++;
+        promotions += result.label_promotions;
+        // A promoted frame allocated both maps
+        if (result.label_bits) map_bytes += px * (result.label_bits / 8) + px * result.label_promotions;
+    }
+
+    uint64_t iters = 0;
+    uint64_t start = host_now_ns();
+    uint64_t elapsed;
+    do {
+        for (int i = 0; i < set->count; i++) {
+            detect(set->frames[i], set->width, set->height, &result);
+            g_sink += (uint32_t)result.blob_count;
+        }
+        iters += (uint64_t)set->count;
+        elapsed = host_now_ns() - start;
+    } while (elapsed < opts->min_ns);
+
+    print_row(stage, set, elapsed, iters);
+    if (map_bytes) {
+        printf("%-8s   label map: 8-bit on %d/%d frames, %d promotions, "
+               "%.0f KB/frame (16-bit only: %.0f KB)\n",
+               "", frames8, set->count, promotions,
+               (double)map_bytes / set->count / 1024.0, (double)px * 2 / 1024.0);
+    }
+}
+
+static void bench_track(const frame_set_t *set, const bench_opts_t *opts)
+{
+    // Pre-compute detections so only the tracker is timed
+    detection_result_t *seq =
+        (detection_result_t *)malloc(sizeof(detection_result_t) * set->count);
+    if (!seq) return;
+    for (int i = 0; i < set->count; i++) {
+        detect_blobs(set->frames[i], set->width, set->height, &seq[i]);
+    }
+
+    detection_result_t *work =
+        (detection_result_t *)malloc(sizeof(detection_result_t) * set->count);
+    if (!work) {
+        free(seq);
+        return;
+    }
+
+    tracker_state_t tracker;
+    tracker_reset(&tracker);
+
+    // tracker_classify() edits results in place, so each pass runs on a
+    // fresh copy of the sequence; the copy is kept outside the timed region.
+    uint64_t iters = 0;
+    uint64_t total = 0;
+    do {
+        memcpy(work, seq, sizeof(detection_result_t) * set->count);
+        uint64_t t0 = host_now_ns();
+        for (int i = 0; i < set->count; i++) {
+            tracker_classify(&tracker, &work[i]);
+        }
+        total += host_now_ns() - t0;
+        g_sink += (uint32_t)work[set->count - 1].blobs[0].classification;
+        iters += (uint64_t)set->count;
+    } while (total < opts->min_ns / 4);
+
+    print_row("track", set, total, iters);
+    free(work);
+    free(seq);
+}
+
+static void bench_tri(const frame_set_t *set, const bench_opts_t *opts)
+{
+    // Pair every detected primary blob with a secondary centroid shifted by
+    // a plausible disparity — one triangulate_distance() call per blob.
+    enum { MAX_PAIRS = 4096 };
+    static uint16_t pairs[MAX_PAIRS][4];
+    int n = 0;
+    uint32_t rng = 0xC0FFEEu;
+
+    for (int i = 0; i < set->count && n < MAX_PAIRS; i++) {
+        detection_result_t r;
+        detect_blobs(set->frames[i], set->width, set->height, &r);
+        for (int b = 0; b < r.blob_count && n < MAX_PAIRS; b++) {
+            rng = rng * 1664525u + 1013904223u;
+            pairs[n][0] = r.blobs[b].cx;
+            pairs[n][1] = r.blobs[b].cy;
+            pairs[n][2] = (uint16_t)(r.blobs[b].cx + 1 + (rng >> 26));
+            pairs[n][3] = (uint16_t)(r.blobs[b].cy + ((rng >> 20) & 3));
+            n++;
+        }
+    }
+    if (n == 0) {
+        // Blob-free input: still time the function on synthetic pairs
+        for (; n < 64; n++) {
+            rng = rng * 1664525u + 1013904223u;
+            pairs[n][0] = (uint16_t)(rng % (uint32_t)set->width);
+            pairs[n][1] = (uint16_t)((rng >> 12) % (uint32_t)set->height);
+            pairs[n][2] = (uint16_t)(pairs[n][0] + 1 + (rng >> 26));
+            pairs[n][3] = pairs[n][1];
+        }
+    }
+
+    uint64_t iters = 0;
+    uint64_t start = host_now_ns();
+    uint64_t elapsed;
+    float acc = 0.0f;
+    do {
+        for (int i = 0; i < n; i++) {
+            acc += triangulate_distance(pairs[i][0], pairs[i][1],
+                                        pairs[i][2], pairs[i][3]);
+        }
+        iters += (uint64_t)n;
+        elapsed = host_now_ns() - start;
+    } while (elapsed < opts->min_ns / 4);
+    g_sink += (uint32_t)acc;
+
+    print_row("tri", set, elapsed, iters);
+}
+
+static void run_set(const frame_set_t *set, const bench_opts_t *opts)
+{
+    if (opts->run_detect)   bench_detect("detect", detect_blobs, set, opts);
+    if (opts->run_labelmap) bench_detect("labelmap", detect_blobs_labelmap, set, opts);
+    if (opts->run_generic)  bench_detect("generic", detect_blobs_labelmap_generic, set, opts);
+    if (opts->run_bitplane) bench_detect("bitplane", detect_blobs_bitplane, set, opts);
+    if (opts->run_track)  bench_track(set, opts);
+    if (opts->run_tri)    bench_tri(set, opts);
+}
+
+// ---------------------------------------------------------------------------
+// Frame set construction
+// ---------------------------------------------------------------------------
+static bool frame_set_alloc(frame_set_t *set, int width, int height, int count)
+{
+    set->width  = width;
+    set->height = height;
+    set->count  = count;
+    set->frames = (uint8_t **)calloc((size_t)count, sizeof(uint8_t *));
+    if (!set->frames) return false;
+    for (int i = 0; i < count; i++) {
+        set->frames[i] = (uint8_t *)malloc((size_t)width * height);
+        if (!set->frames[i]) return false;
+    }
+    return true;
+}
+
+static void frame_set_free(frame_set_t *set)
+{
+    if (!set->frames) return;
+    for (int i = 0; i < set->count; i++) free(set->frames[i]);
+    free(set->frames);
+    set->frames = NULL;
+}
+
+static void run_synthetic(const bench_opts_t *opts)
+{
+    for (int r = 0; r < NUM_RESOLUTIONS; r++) {
+        if (!opts->res_enabled[r]) continue;
+        const bench_res_t *res = &k_resolutions[r];
+
+        for (int s = 0; s < SYNTH_SCENE_COUNT; s++) {
+            frame_set_t set;
+            memset(&set, 0, sizeof(set));
+            snprintf(set.label, sizeof(set.label), "%s",
+                     synth_scene_name((synth_scene_t)s));
+            snprintf(set.res_name, sizeof(set.res_name), "%s", res->name);
+
+            if (!frame_set_alloc(&set, res->width, res->height, opts->synth_frames)) {
+                fprintf(stderr, "out of memory at %s\n", res->name);
+                frame_set_free(&set);
+                return;
+            }
+            for (int i = 0; i < set.count; i++) {
+                synth_render((synth_scene_t)s, (uint32_t)i * 8, res->width,
+                             res->height, set.frames[i]);
+            }
+            run_set(&set, opts);
+            frame_set_free(&set);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Worst-case frames
+// ---------------------------------------------------------------------------
+
+// CPU cycle source: perf_event when the kernel allows it, else the x86 TSC
+// (constant-rate reference cycles), else none
+typedef struct {
+    int         fd;
+    const char *source;
+} cycle_counter_t;
+
+static void cycle_counter_open(cycle_counter_t *c)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    c->fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (c->fd >= 0) {
+        c->source = "perf cycles";
+        return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    c->source = "tsc";
+#else
+    c->source = NULL;
+#endif
+}
+
+static uint64_t cycle_counter_read(const cycle_counter_t *c)
+{
+    if (c->fd >= 0) {
+        uint64_t v = 0;
+        if (read(c->fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) return 0;
+        return v;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+typedef struct {
+    uint64_t min_ns, med_ns, max_ns;
+    uint64_t max_cycles;
+    uint64_t frames;
+    int      blobs;       // Blobs reported for the slowest frame
+} worst_stats_t;
+
+// Time every detect_blobs() call individually until min_ns has elapsed
+static void time_frames(const frame_set_t *set, const bench_opts_t *opts,
+                        const cycle_counter_t *cc, worst_stats_t *ws)
+{
+    detection_result_t result;
+    for (int i = 0; i < set->count; i++) {
+        detect_blobs(set->frames[i], set->width, set->height, &result);
+    }
+
+    std::vector<uint64_t> ns;
+    uint64_t total = 0;
+    memset(ws, 0, sizeof(*ws));
+    do {
+        for (int i = 0; i < set->count; i++) {
+            uint64_t c0 = cycle_counter_read(cc);
+            uint64_t t0 = host_now_ns();
+            detect_blobs(set->frames[i], set->width, set->height, &result);
+            uint64_t dt = host_now_ns() - t0;
+            uint64_t dc = cycle_counter_read(cc) - c0;
+
+            g_sink += (uint32_t)result.blob_count;
+            ns.push_back(dt);
+            total += dt;
+            if (dt >= ws->max_ns) {
+                ws->max_ns = dt;
+                ws->blobs  = result.blob_count;
+            }
+            if (dc > ws->max_cycles) ws->max_cycles = dc;
+        }
+    } while (total < opts->min_ns);
+
+    std::sort(ns.begin(), ns.end());
+    ws->frames = ns.size();
+    ws->min_ns = ns.front();
+    ws->med_ns = ns[ns.size() / 2];
+}
+
+static void print_worst_row(const char *label, const bench_res_t *res,
+                            const worst_stats_t *ws, const cycle_counter_t *cc,
+                            uint64_t typical_med_ns)
+{
+    char cycles[24] = "-";
+    if (cc->source) snprintf(cycles, sizeof(cycles), "%llu", (unsigned long long)ws->max_cycles);
+    printf("%-12s %-6s %7llu %10.3f %10.3f %10.3f %14s %6.1fx %5d\n",
+           label, res->name, (unsigned long long)ws->frames,
+           ws->min_ns / 1e6, ws->med_ns / 1e6, ws->max_ns / 1e6, cycles,
+           typical_med_ns ? (double)ws->max_ns / (double)typical_med_ns : 0.0,
+           ws->blobs);
+}
+
+static void run_worst(const bench_opts_t *opts)
+{
+    cycle_counter_t cc;
+    cycle_counter_open(&cc);
+
+    printf("detect_blobs() per-frame times; cycles from %s; "
+           "'vs typ' = max / median of the headlights scene\n",
+           cc.source ? cc.source : "(no cycle counter)");
+    printf("%-12s %-6s %7s %10s %10s %10s %14s %7s %5s\n", "pattern", "res", "frames",
+           "min ms", "median ms", "max ms", "max cycles", "vs typ", "blobs");
+
+    for (int r = 0; r < NUM_RESOLUTIONS; r++) {
+        if (!opts->res_enabled[r]) continue;
+        const bench_res_t *res = &k_resolutions[r];
+
+        frame_set_t set;
+        memset(&set, 0, sizeof(set));
+        if (!frame_set_alloc(&set, res->width, res->height, opts->synth_frames)) {
+            fprintf(stderr, "out of memory at %s\n", res->name);
+            frame_set_free(&set);
+            return;
+        }
+
+        // Reference: the typical scene the deadline is normally sized for
+        for (int i = 0; i < set.count; i++) {
+            synth_render(SYNTH_SCENE_HEADLIGHTS, (uint32_t)i * 8, res->width, res->height,
+                         set.frames[i]);
+        }
+        worst_stats_t typ;
+        time_frames(&set, opts, &cc, &typ);
+        print_worst_row("headlights", res, &typ, &cc, typ.med_ns);
+
+        const char *worst_name = NULL;
+        uint64_t worst_ns = 0, worst_cycles = 0;
+        for (int p = 0; p < ADV_COUNT; p++) {
+            for (int i = 0; i < set.count; i++) {
+                adv_render((adv_pattern_t)p, res->width, res->height, (uint32_t)i, set.frames[i]);
+            }
+            worst_stats_t ws;
+            time_frames(&set, opts, &cc, &ws);
+            print_worst_row(adv_pattern_name((adv_pattern_t)p), res, &ws, &cc, typ.med_ns);
+            if (ws.max_ns > worst_ns) {
+                worst_ns     = ws.max_ns;
+                worst_cycles = ws.max_cycles;
+                worst_name   = adv_pattern_name((adv_pattern_t)p);
+            }
+        }
+        printf("%s worst case: %s, %.3f ms", res->name, worst_name, worst_ns / 1e6);
+        if (cc.source) printf(", %llu cycles", (unsigned long long)worst_cycles);
+        printf("\n\n");
+        frame_set_free(&set);
+    }
+    if (cc.fd >= 0) close(cc.fd);
+}
+
+static void set_label_from_path(frame_set_t *set, const char *path)
+{
+    const char *base = strrchr(path, '/');
+    snprintf(set->label, sizeof(set->label), "%s", base ? base + 1 : path);
+    snprintf(set->res_name, sizeof(set->res_name), "file");
+    for (int r = 0; r < NUM_RESOLUTIONS; r++) {
+        if (k_resolutions[r].width == set->width && k_resolutions[r].height == set->height) {
+            snprintf(set->res_name, sizeof(set->res_name), "%s", k_resolutions[r].name);
+        }
+    }
+}
+
+// Decode a whole .cfr recording into memory so decode cost is not timed
+static void run_recording(const char *path, const bench_opts_t *opts)
+{
+    rec_file_t rf;
+    if (!rec_open(path, &rf) || rf.frame_count == 0) {
+        fprintf(stderr, "cannot open recording %s\n", path);
+        return;
+    }
+
+    frame_set_t set;
+    memset(&set, 0, sizeof(set));
+    if (frame_set_alloc(&set, rec_width(&rf), rec_height(&rf), (int)rf.frame_count)) {
+        bool ok = true;
+        for (int i = 0; i < set.count && ok; i++) {
+            const uint8_t *px = rec_frame_pixels(&rf, (uint32_t)i, set.frames[i]);
+            if (!px) ok = false;
+            else if (px != set.frames[i]) memcpy(set.frames[i], px, (size_t)set.width * set.height);
+        }
+        if (ok) {
+            set_label_from_path(&set, path);
+            run_set(&set, opts);
+        } else {
+            fprintf(stderr, "%s: corrupt frame payload\n", path);
+        }
+    } else {
+        fprintf(stderr, "out of memory loading %s\n", path);
+    }
+    frame_set_free(&set);
+    rec_close(&rf);
+}
+
+static void run_recorded(const char *path, const bench_opts_t *opts)
+{
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".cfr") == 0) {
+        run_recording(path, opts);
+        return;
+    }
+
+    pgm_image_t img;
+    if (!pgm_load(path, &img)) {
+        fprintf(stderr, "cannot load %s (expect .cfr or binary P5 PGM)\n", path);
+        return;
+    }
+
+    frame_set_t set;
+    memset(&set, 0, sizeof(set));
+    set.width  = img.width;
+    set.height = img.height;
+    set.count  = 1;
+    set.frames = &img.pixels;
+    set_label_from_path(&set, path);
+
+    run_set(&set, opts);
+    pgm_free(&img);
+}
+
+// ---------------------------------------------------------------------------
+// Command line
+// ---------------------------------------------------------------------------
+
+// True if `name` appears as a whole entry in a comma-separated list
+static bool list_has(const char *list, const char *name)
+{
+    size_t n = strlen(name);
+    const char *p = list;
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len == n && strncasecmp(p, name, n) == 0) return true;
+        if (!end) break;
+        p = end + 1;
+    }
+    return false;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--res QVGA,VGA,SVGA,UXGA] [--stage detect,labelmap,generic,bitplane,track,tri]\n"
+            "          [--frames N] [--min-ms N] [--no-synth] [ride.cfr | frame.pgm ...]\n"
+            "       %s --worst [--res ...] [--frames N] [--min-ms N]\n",
+            argv0, argv0);
+}
+
+int main(int argc, char **argv)
+{
+    bench_opts_t opts;
+    memset(&opts, 0, sizeof(opts));
+    for (int r = 0; r < NUM_RESOLUTIONS; r++) opts.res_enabled[r] = true;
+    opts.run_detect   = opts.run_track = opts.run_tri = true;
+    opts.synth_frames = 16;
+    opts.min_ns       = 300ull * 1000000ull;
+
+    int first_file = argc;
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strcmp(a, "--res") == 0 && i + 1 < argc) {
+            const char *list = argv[++i];
+            for (int r = 0; r < NUM_RESOLUTIONS; r++) {
+                opts.res_enabled[r] = list_has(list, k_resolutions[r].name);
+            }
+        } else if (strcmp(a, "--stage") == 0 && i + 1 < argc) {
+            const char *list = argv[++i];
+            opts.run_detect   = list_has(list, "detect");
+            opts.run_labelmap = list_has(list, "labelmap");
+            opts.run_bitplane = list_has(list, "bitplane");
+            opts.run_generic  = list_has(list, "generic");
+            opts.run_track  = list_has(list, "track");
+            opts.run_tri    = list_has(list, "tri");
+        } else if (strcmp(a, "--no-synth") == 0) {
+            opts.no_synth = true;
+        } else if (strcmp(a, "--worst") == 0) {
+            opts.worst = true;
+        } else if (strcmp(a, "--frames") == 0 && i + 1 < argc) {
+            opts.synth_frames = atoi(argv[++i]);
+            if (opts.synth_frames < 1) opts.synth_frames = 1;
+        } else if (strcmp(a, "--min-ms") == 0 && i + 1 < argc) {
+            opts.min_ns = (uint64_t)atoi(argv[++i]) * 1000000ull;
+        } else if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else if (a[0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            first_file = i;
+            break;
+        }
+    }
+
+    if (opts.worst) {
+        run_worst(&opts);
+        return 0;
+    }
+
+    print_header();
+    if (!opts.no_synth) {
+        run_synthetic(&opts);
+    }
+    for (int i = first_file; i < argc; i++) {
+        run_recorded(argv[i], &opts);
+    }
+    return 0;
+}
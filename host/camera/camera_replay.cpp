@@ -0,0 +1,68 @@
+#include "camera_replay.h"
+#include <stdlib.h>
+#include <string.h>
+
+static esp_err_t replay_init(void *ctx)
+{
+    camera_replay_t *cr = (camera_replay_t *)ctx;
+    cr->next = 0;
+    return cr->file.frame_count > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+static camera_fb_t *replay_capture(void *ctx)
+{
+    camera_replay_t *cr = (camera_replay_t *)ctx;
+    if (cr->next >= cr->file.frame_count) {
+        if (!cr->loop || cr->file.frame_count == 0) return NULL;
+        cr->next = 0;
+    }
+
+    uint32_t i = cr->next++;
+    const uint8_t *px = rec_frame_pixels(&cr->file, i, cr->scratch);
+    if (!px) return NULL;
+
+    int w = rec_width(&cr->file), h = rec_height(&cr->file);
+    uint64_t ts = cr->file.index[i].timestamp_us;
+
+    // The driver API hands out a mutable buffer; consumers only read it
+    cr->fb.buf     = (uint8_t *)px;
+    cr->fb.len     = (size_t)w * h;
+    cr->fb.width   = (size_t)w;
+    cr->fb.height  = (size_t)h;
+    cr->fb.format  = PIXFORMAT_GRAYSCALE;
+    cr->fb.timestamp.tv_sec  = (time_t)(ts / 1000000u);
+    cr->fb.timestamp.tv_usec = (suseconds_t)(ts % 1000000u);
+    return &cr->fb;
+}
+
+static void replay_release(void *ctx, camera_fb_t *fb)
+{
+    (void)ctx;
+    (void)fb;
+}
+
+bool camera_replay_open(camera_replay_t *cr, const char *path, bool loop)
+{
+    memset(cr, 0, sizeof(*cr));
+    if (!rec_open(path, &cr->file)) return false;
+
+    cr->scratch = (uint8_t *)malloc((size_t)rec_width(&cr->file) * rec_height(&cr->file));
+    if (!cr->scratch) {
+        rec_close(&cr->file);
+        return false;
+    }
+    cr->loop            = loop;
+    cr->backend.name    = "replay";
+    cr->backend.init    = replay_init;
+    cr->backend.capture = replay_capture;
+    cr->backend.release = replay_release;
+    cr->backend.ctx     = cr;
+    return true;
+}
+
+void camera_replay_close(camera_replay_t *cr)
+{
+    rec_close(&cr->file);
+    free(cr->scratch);
+    cr->scratch = NULL;
+}
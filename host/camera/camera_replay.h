@@ -0,0 +1,28 @@
+#ifndef HOST_CAMERA_REPLAY_H
+#define HOST_CAMERA_REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "camera.h"
+#include "rec_file.h"
+
+// ---------------------------------------------------------------------------
+// Capture backend replaying a .cfr recording through mmap.
+// RAW frames are handed out in place; compressed frames are decoded into a
+// per-backend buffer. fb->timestamp carries the recorded capture time.
+// ---------------------------------------------------------------------------
+typedef struct {
+    camera_backend_t backend;   // Pass &backend to camera_set_backend()
+    rec_file_t       file;
+    uint32_t         next;      // Next frame index to serve
+    bool             loop;      // Wrap to frame 0 at the end instead of failing
+    uint8_t         *scratch;   // Decode buffer, width * height
+    camera_fb_t      fb;        // The single outstanding frame
+} camera_replay_t;
+
+/** Open `path` and fill in the backend. Returns false if the file is invalid. */
+bool camera_replay_open(camera_replay_t *cr, const char *path, bool loop);
+void camera_replay_close(camera_replay_t *cr);
+
+#endif // HOST_CAMERA_REPLAY_H
@@ -0,0 +1,68 @@
+#include "camera_synth.h"
+#include <stdlib.h>
+#include <string.h>
+
+static esp_err_t synth_init(void *ctx)
+{
+    camera_synth_t *cs = (camera_synth_t *)ctx;
+    cs->frame = 0;
+    return ESP_OK;
+}
+
+static camera_fb_t *synth_capture(void *ctx)
+{
+    camera_synth_t *cs = (camera_synth_t *)ctx;
+    const scene_params_t *p = &cs->scene.params;
+    uint32_t n = cs->frame++;
+    scene_render(&cs->scene, n, cs->view, cs->pixels, NULL);
+
+    uint64_t ts = (uint64_t)((double)n * 1e6 / p->fps);
+    cs->fb.buf     = cs->pixels;
+    cs->fb.len     = (size_t)p->width * p->height;
+    cs->fb.width   = (size_t)p->width;
+    cs->fb.height  = (size_t)p->height;
+    cs->fb.format  = PIXFORMAT_GRAYSCALE;
+    cs->fb.timestamp.tv_sec  = (time_t)(ts / 1000000u);
+    cs->fb.timestamp.tv_usec = (suseconds_t)(ts % 1000000u);
+    return &cs->fb;
+}
+
+static void synth_release(void *ctx, camera_fb_t *fb)
+{
+    (void)ctx;
+    (void)fb;
+}
+
+bool camera_synth_open_params(camera_synth_t *cs, const scene_params_t *params,
+                              scene_view_t view)
+{
+    memset(cs, 0, sizeof(*cs));
+    if (params->width <= 0 || params->height <= 0 || params->fps <= 0.0f) return false;
+
+    cs->pixels = (uint8_t *)malloc((size_t)params->width * params->height);
+    if (!cs->pixels) return false;
+
+    scene_build(&cs->scene, params);
+    cs->view            = view;
+    cs->backend.name    = "synth";
+    cs->backend.init    = synth_init;
+    cs->backend.capture = synth_capture;
+    cs->backend.release = synth_release;
+    cs->backend.ctx     = cs;
+    return true;
+}
+
+bool camera_synth_open(camera_synth_t *cs, synth_scene_t preset,
+                       int width, int height, float fps)
+{
+    scene_params_t p;
+    synth_params(preset, width, height, &p);
+    p.fps = fps;
+    return camera_synth_open_params(cs, &p, SCENE_VIEW_PRIMARY);
+}
+
+void camera_synth_close(camera_synth_t *cs)
+{
+    free(cs->pixels);
+    cs->pixels = NULL;
+}
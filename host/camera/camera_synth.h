@@ -0,0 +1,35 @@
+#ifndef HOST_CAMERA_SYNTH_H
+#define HOST_CAMERA_SYNTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "camera.h"
+#include "scene.h"
+#include "synth.h"
+
+// ---------------------------------------------------------------------------
+// Capture backend rendering a procedural night scene (host/scene/scene.h).
+// Frame n is stamped n / fps seconds after start, so replay pacing and
+// FPS-dependent logic behave as on a sensor running at the scene's fps.
+// ---------------------------------------------------------------------------
+typedef struct {
+    camera_backend_t backend;   // Pass &backend to camera_set_backend()
+    scene_t          scene;
+    scene_view_t     view;      // Which camera of the stereo rig to render
+    uint32_t         frame;     // Next frame number to render
+    uint8_t         *pixels;
+    camera_fb_t      fb;
+} camera_synth_t;
+
+/** Render one view of an arbitrary scene. */
+bool camera_synth_open_params(camera_synth_t *cs, const scene_params_t *params,
+                              scene_view_t view);
+
+/** Render the primary view of a named preset at width x height, `fps`. */
+bool camera_synth_open(camera_synth_t *cs, synth_scene_t preset,
+                       int width, int height, float fps);
+
+void camera_synth_close(camera_synth_t *cs);
+
+#endif // HOST_CAMERA_SYNTH_H
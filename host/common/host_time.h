@@ -0,0 +1,15 @@
+#ifndef HOST_TIME_H
+#define HOST_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+
+/** Monotonic wall-clock time in nanoseconds. */
+static inline uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+#endif // HOST_TIME_H
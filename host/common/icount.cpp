@@ -0,0 +1,208 @@
+#include "icount.h"
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// perf_event backend
+// ---------------------------------------------------------------------------
+static int perf_open_instructions(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static bool perf_probe(void)
+{
+    int fd = perf_open_instructions();
+    if (fd < 0) return false;
+    close(fd);
+    return true;
+}
+
+// Child side: count region() and write the result down the pipe
+static void perf_child(icount_fn_t region, void *user, int out_fd)
+{
+    uint64_t count = UINT64_MAX;
+    int fd = perf_open_instructions();
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        region(user);
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) count = UINT64_MAX;
+        close(fd);
+    }
+    if (write(out_fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) _exit(1);
+}
+
+static bool perf_measure(icount_fn_t setup, icount_fn_t region, void *user,
+                         uint64_t *instructions)
+{
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        if (setup) setup(user);
+        perf_child(region, user, fds[1]);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    uint64_t count = UINT64_MAX;
+    ssize_t n = read(fds[0], &count, sizeof(count));
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (n != (ssize_t)sizeof(count) || count == UINT64_MAX) return false;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return false;
+    *instructions = count;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// ptrace single-step backend
+//
+// The child stops itself with SIGSTOP immediately before and after the
+// region; the parent single-steps everything in between.
+// ---------------------------------------------------------------------------
+static bool ptrace_probe(void)
+{
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0) _exit(1);
+        raise(SIGSTOP);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    bool ok = WIFSTOPPED(status);
+    if (ok) ok = ptrace(PTRACE_SINGLESTEP, pid, NULL, NULL) == 0;
+    kill(pid, SIGKILL);
+    waitpid(pid, &status, 0);
+    return ok;
+}
+
+static bool ptrace_measure(icount_fn_t setup, icount_fn_t region, void *user,
+                           uint64_t *instructions)
+{
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        if (setup) setup(user);
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0) _exit(1);
+        raise(SIGSTOP);
+        region(user);
+        raise(SIGSTOP);
+        _exit(0);
+    }
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status) ||
+        WSTOPSIG(status) != SIGSTOP) {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+        return false;
+    }
+
+    uint64_t steps = 0;
+    bool ok = false;
+    for (;;) {
+        if (ptrace(PTRACE_SINGLESTEP, pid, NULL, NULL) != 0) break;
+        if (waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status)) break;
+        int sig = WSTOPSIG(status);
+        if (sig == SIGSTOP) {
+            ok = true;
+            break;
+        }
+        if (sig != SIGTRAP) break;   // The region itself crashed
+        steps++;
+    }
+
+    kill(pid, SIGKILL);
+    waitpid(pid, &status, 0);
+    if (ok) *instructions = steps;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+static void empty_region(void *) {}
+
+const char *icount_backend_name(icount_backend_t b)
+{
+    switch (b) {
+        case ICOUNT_PERF:   return "perf";
+        case ICOUNT_PTRACE: return "ptrace";
+        default:            return "none";
+    }
+}
+
+icount_backend_t icount_backend_from_name(const char *name)
+{
+    if (strcmp(name, "perf") == 0)   return ICOUNT_PERF;
+    if (strcmp(name, "ptrace") == 0) return ICOUNT_PTRACE;
+    if (strcmp(name, "auto") == 0) {
+        if (icount_available(ICOUNT_PERF))   return ICOUNT_PERF;
+        if (icount_available(ICOUNT_PTRACE)) return ICOUNT_PTRACE;
+    }
+    return ICOUNT_NONE;
+}
+
+bool icount_available(icount_backend_t b)
+{
+    switch (b) {
+        case ICOUNT_PERF:   return perf_probe();
+        case ICOUNT_PTRACE: return ptrace_probe();
+        default:            return false;
+    }
+}
+
+bool icount_measure(icount_backend_t b, icount_fn_t setup, icount_fn_t region,
+                    void *user, uint64_t *instructions)
+{
+    static uint64_t overhead[3];
+    static bool     calibrated[3];
+
+    bool (*measure)(icount_fn_t, icount_fn_t, void *, uint64_t *);
+    switch (b) {
+        case ICOUNT_PERF:   measure = perf_measure;   break;
+        case ICOUNT_PTRACE: measure = ptrace_measure; break;
+        default:            return false;
+    }
+
+    if (!calibrated[b]) {
+        if (!measure(NULL, empty_region, NULL, &overhead[b])) return false;
+        calibrated[b] = true;
+    }
+
+    uint64_t raw;
+    if (!measure(setup, region, user, &raw)) return false;
+    *instructions = raw > overhead[b] ? raw - overhead[b] : 0;
+    return true;
+}
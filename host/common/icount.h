@@ -0,0 +1,39 @@
+#ifndef HOST_ICOUNT_H
+#define HOST_ICOUNT_H
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Deterministic retired-instruction counting for a region of code.
+//
+// The region runs in a forked child so counters, ptrace state and any
+// statics it touches never leak into the caller. Two backends:
+//   perf   — PERF_COUNT_HW_INSTRUCTIONS (user space only) via perf_event_open
+//   ptrace — single-steps the child and counts steps; slow (~100k instr/s)
+//            but needs no PMU, so it works in VMs and containers
+// Fixed marker overhead (measured on an empty region) is subtracted.
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    ICOUNT_NONE   = 0,
+    ICOUNT_PERF   = 1,
+    ICOUNT_PTRACE = 2,
+} icount_backend_t;
+
+typedef void (*icount_fn_t)(void *user);
+
+const char *icount_backend_name(icount_backend_t b);
+
+/** "auto" picks the first available backend; returns ICOUNT_NONE if none is. */
+icount_backend_t icount_backend_from_name(const char *name);
+
+bool icount_available(icount_backend_t b);
+
+/**
+ * In a child process: run setup(user) uncounted (may be NULL), then count
+ * the instructions retired by region(user). Returns false on failure.
+ */
+bool icount_measure(icount_backend_t b, icount_fn_t setup, icount_fn_t region,
+                    void *user, uint64_t *instructions);
+
+#endif // HOST_ICOUNT_H
@@ -0,0 +1,75 @@
+#include "pgm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+// Read one whitespace/comment-separated header integer
+static bool read_header_int(FILE *f, int *out)
+{
+    int c = fgetc(f);
+    while (c != EOF) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') c = fgetc(f);
+        } else if (!isspace(c)) {
+            break;
+        }
+        c = fgetc(f);
+    }
+    if (c == EOF || !isdigit(c)) return false;
+
+    int v = 0;
+    while (c != EOF && isdigit(c)) {
+        v = v * 10 + (c - '0');
+        c = fgetc(f);
+    }
+    *out = v;
+    return true;   // Single whitespace after the value was consumed above
+}
+
+bool pgm_load(const char *path, pgm_image_t *img)
+{
+    img->width = img->height = 0;
+    img->pixels = NULL;
+
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    int w, h, maxval;
+    if (fgetc(f) != 'P' || fgetc(f) != '5' ||
+        !read_header_int(f, &w) || !read_header_int(f, &h) ||
+        !read_header_int(f, &maxval) || maxval != 255 || w <= 0 || h <= 0) {
+        fclose(f);
+        return false;
+    }
+
+    size_t n = (size_t)w * (size_t)h;
+    uint8_t *px = (uint8_t *)malloc(n);
+    if (!px || fread(px, 1, n, f) != n) {
+        free(px);
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+
+    img->width  = w;
+    img->height = h;
+    img->pixels = px;
+    return true;
+}
+
+bool pgm_save(const char *path, const uint8_t *pixels, int width, int height)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P5\n%d %d\n255\n", width, height);
+    size_t n = (size_t)width * (size_t)height;
+    bool ok = fwrite(pixels, 1, n, f) == n;
+    return (fclose(f) == 0) && ok;
+}
+
+void pgm_free(pgm_image_t *img)
+{
+    free(img->pixels);
+    img->pixels = NULL;
+    img->width = img->height = 0;
+}
@@ -0,0 +1,26 @@
+#ifndef HOST_PGM_H
+#define HOST_PGM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ---------------------------------------------------------------------------
+// Binary PGM (P5, maxval 255) load/save — the simplest way to hand recorded
+// grayscale frames to the host tools.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int      width;
+    int      height;
+    uint8_t *pixels;   // width * height bytes, owned — release with pgm_free()
+} pgm_image_t;
+
+/** Load a P5 PGM file. Returns false on I/O or format error. */
+bool pgm_load(const char *path, pgm_image_t *img);
+
+/** Write a P5 PGM file. Returns false on I/O error. */
+bool pgm_save(const char *path, const uint8_t *pixels, int width, int height);
+
+void pgm_free(pgm_image_t *img);
+
+#endif // HOST_PGM_H
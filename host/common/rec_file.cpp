@@ -0,0 +1,217 @@
+#include "rec_file.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+bool rec_open(const char *path, rec_file_t *rf)
+{
+    memset(rf, 0, sizeof(*rf));
+    rf->fd = -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (size_t)st.st_size < sizeof(frec_file_header_t) + sizeof(frec_trailer_t)) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    // Frames are usually replayed front to back
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    const uint8_t *base = (const uint8_t *)map;
+    const frec_file_header_t *h = (const frec_file_header_t *)base;
+    const frec_trailer_t *t =
+        (const frec_trailer_t *)(base + size - sizeof(frec_trailer_t));
+
+    bool ok = h->magic == FREC_MAGIC && h->version == FREC_VERSION &&
+              h->header_size == sizeof(frec_file_header_t) &&
+              h->width > 0 && h->height > 0 &&
+              t->magic == FREC_TRAILER_MAGIC &&
+              t->index_offset % 8 == 0 &&
+              t->index_offset + (uint64_t)t->frame_count * sizeof(frec_index_entry_t)
+                  + sizeof(frec_trailer_t) == size;
+    if (!ok) {
+        munmap(map, size);
+        close(fd);
+        return false;
+    }
+
+    rf->fd          = fd;
+    rf->base        = base;
+    rf->size        = size;
+    rf->header      = h;
+    rf->index       = (const frec_index_entry_t *)(base + t->index_offset);
+    rf->frame_count = t->frame_count;
+    return true;
+}
+
+void rec_close(rec_file_t *rf)
+{
+    if (rf->base) munmap((void *)rf->base, rf->size);
+    if (rf->fd >= 0) close(rf->fd);
+    memset(rf, 0, sizeof(*rf));
+    rf->fd = -1;
+}
+
+bool rec_frame(const rec_file_t *rf, uint32_t i, rec_frame_t *out)
+{
+    if (i >= rf->frame_count) return false;
+
+    uint64_t off = rf->index[i].offset;
+    if (off % 8 != 0 || off + sizeof(frec_frame_header_t) > rf->size) return false;
+
+    const frec_frame_header_t *fh = (const frec_frame_header_t *)(rf->base + off);
+    if (off + sizeof(*fh) + fh->payload_size > rf->size) return false;
+
+    out->header  = fh;
+    out->payload = rf->base + off + sizeof(*fh);
+    return true;
+}
+
+const uint8_t *rec_frame_pixels(const rec_file_t *rf, uint32_t i, uint8_t *scratch)
+{
+    rec_frame_t fr;
+    if (!rec_frame(rf, i, &fr)) return NULL;
+
+    int w = rec_width(rf), h = rec_height(rf);
+    if (fr.header->codec == FREC_CODEC_RAW) {
+        if (fr.header->payload_size != (uint32_t)(w * h)) return NULL;
+        return fr.payload;
+    }
+    return frec_decode(fr.header, fr.payload, w, h, scratch) ? scratch : NULL;
+}
+
+uint32_t rec_seek_time(const rec_file_t *rf, uint64_t t_us)
+{
+    uint32_t lo = 0, hi = rf->frame_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (rf->index[mid].timestamp_us <= t_us) lo = mid + 1;
+        else                                      hi = mid;
+    }
+    return lo > 0 ? lo - 1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+static bool write_padded(rec_writer_t *w, const void *data, size_t n)
+{
+    static const uint8_t zeros[8] = {0};
+    if (n && fwrite(data, 1, n, w->f) != n) return false;
+    size_t pad = frec_align(n) - n;
+    if (pad && fwrite(zeros, 1, pad, w->f) != pad) return false;
+    w->offset += n + pad;
+    return true;
+}
+
+bool rec_writer_open(rec_writer_t *w, const char *path, int width, int height,
+                     uint32_t fps_milli)
+{
+    memset(w, 0, sizeof(*w));
+    if (width <= 0 || height <= 0 || width > 0xFFFF || height > 0xFFFF) return false;
+
+    w->f = fopen(path, "wb");
+    if (!w->f) return false;
+
+    w->header.magic       = FREC_MAGIC;
+    w->header.version     = FREC_VERSION;
+    w->header.header_size = sizeof(frec_file_header_t);
+    w->header.width       = (uint16_t)width;
+    w->header.height      = (uint16_t)height;
+    w->header.fps_milli   = fps_milli;
+
+    size_t bound = frec_encode_bound(FREC_CODEC_RLE, width, height);
+    size_t bp    = frec_encode_bound(FREC_CODEC_BITPLANE, width, height);
+    w->scratch_size = bound > bp ? bound : bp;
+    w->scratch = (uint8_t *)malloc(w->scratch_size);
+
+    if (!w->scratch || !write_padded(w, &w->header, sizeof(w->header))) {
+        fclose(w->f);
+        free(w->scratch);
+        memset(w, 0, sizeof(*w));
+        return false;
+    }
+    return true;
+}
+
+bool rec_writer_add(rec_writer_t *w, const uint8_t *pixels, uint64_t timestamp_us,
+                    const frec_meta_t *meta, frec_codec_t codec, uint8_t threshold)
+{
+    if (w->header.frame_count == w->index_cap) {
+        uint32_t cap = w->index_cap ? w->index_cap * 2 : 256;
+        frec_index_entry_t *idx = (frec_index_entry_t *)
+            realloc(w->index, cap * sizeof(frec_index_entry_t));
+        if (!idx) return false;
+        w->index = idx;
+        w->index_cap = cap;
+    }
+
+    frec_frame_header_t fh;
+    memset(&fh, 0, sizeof(fh));
+    fh.timestamp_us = timestamp_us;
+    fh.codec        = (uint8_t)codec;
+    fh.threshold    = threshold;
+    if (meta) fh.meta = *meta;
+
+    const uint8_t *payload = pixels;
+    size_t n = (size_t)w->header.width * w->header.height;
+    if (codec != FREC_CODEC_RAW) {
+        n = frec_encode(codec, pixels, w->header.width, w->header.height,
+                        threshold, &fh.fill, w->scratch);
+        if (n == 0) return false;
+        payload = w->scratch;
+    }
+    fh.payload_size = (uint32_t)n;
+
+    frec_index_entry_t *e = &w->index[w->header.frame_count];
+    e->offset       = w->offset;
+    e->timestamp_us = timestamp_us;
+
+    // Header is 24 bytes (8-aligned) so only the payload needs padding
+    if (fwrite(&fh, 1, sizeof(fh), w->f) != sizeof(fh)) return false;
+    w->offset += sizeof(fh);
+    if (!write_padded(w, payload, n)) return false;
+
+    w->header.frame_count++;
+    return true;
+}
+
+bool rec_writer_close(rec_writer_t *w)
+{
+    if (!w->f) return false;
+
+    frec_trailer_t t;
+    t.index_offset = w->offset;
+    t.frame_count  = w->header.frame_count;
+    t.magic        = FREC_TRAILER_MAGIC;
+    w->header.index_offset = w->offset;
+
+    size_t idx_bytes = (size_t)w->header.frame_count * sizeof(frec_index_entry_t);
+    bool ok = (idx_bytes == 0 || fwrite(w->index, 1, idx_bytes, w->f) == idx_bytes) &&
+              fwrite(&t, 1, sizeof(t), w->f) == sizeof(t) &&
+              fseek(w->f, 0, SEEK_SET) == 0 &&
+              fwrite(&w->header, 1, sizeof(w->header), w->f) == sizeof(w->header);
+
+    ok = (fclose(w->f) == 0) && ok;
+    free(w->index);
+    free(w->scratch);
+    memset(w, 0, sizeof(*w));
+    return ok;
+}
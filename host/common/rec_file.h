@@ -0,0 +1,72 @@
+#ifndef HOST_REC_FILE_H
+#define HOST_REC_FILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "frame_record.h"
+
+// ---------------------------------------------------------------------------
+// .cfr reader (mmap, zero-copy) and writer for host tools.
+// See src/frame_record.h for the container layout.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int                        fd;
+    const uint8_t             *base;     // Whole file, mapped read-only
+    size_t                     size;
+    const frec_file_header_t  *header;
+    const frec_index_entry_t  *index;    // header->frame_count entries
+    uint32_t                   frame_count;
+} rec_file_t;
+
+typedef struct {
+    const frec_frame_header_t *header;
+    const uint8_t             *payload;  // Points into the mapping
+} rec_frame_t;
+
+/** Map a recording and validate its header, index and trailer. */
+bool rec_open(const char *path, rec_file_t *rf);
+void rec_close(rec_file_t *rf);
+
+static inline int rec_width(const rec_file_t *rf)  { return rf->header->width; }
+static inline int rec_height(const rec_file_t *rf) { return rf->header->height; }
+
+/** Locate frame `i` without decoding. Returns false if out of range or corrupt. */
+bool rec_frame(const rec_file_t *rf, uint32_t i, rec_frame_t *out);
+
+/**
+ * Pixels of frame `i`. RAW frames are returned in place (no copy); other
+ * codecs are decoded into `scratch` (width * height bytes), which is returned.
+ * Returns NULL on error.
+ */
+const uint8_t *rec_frame_pixels(const rec_file_t *rf, uint32_t i, uint8_t *scratch);
+
+/** Index of the last frame with timestamp <= t_us (0 if t_us precedes all). */
+uint32_t rec_seek_time(const rec_file_t *rf, uint64_t t_us);
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+typedef struct {
+    FILE               *f;
+    frec_file_header_t  header;
+    frec_index_entry_t *index;
+    uint32_t            index_cap;
+    uint64_t            offset;       // Current write position
+    uint8_t            *scratch;      // Encode buffer
+    size_t              scratch_size;
+} rec_writer_t;
+
+bool rec_writer_open(rec_writer_t *w, const char *path, int width, int height,
+                     uint32_t fps_milli);
+
+/** Append a frame. `meta` may be NULL. */
+bool rec_writer_add(rec_writer_t *w, const uint8_t *pixels, uint64_t timestamp_us,
+                    const frec_meta_t *meta, frec_codec_t codec, uint8_t threshold);
+
+/** Write the seek index and trailer, patch the header, close the file. */
+bool rec_writer_close(rec_writer_t *w);
+
+#endif // HOST_REC_FILE_H
@@ -0,0 +1,71 @@
+// ---------------------------------------------------------------------------
+// Fuzz target: adaptive brightness threshold (auto_threshold.h)
+//
+// Byte 0 is the target bright share (per mille), byte 1 the configured
+// brightness_threshold. Every following 17 bytes are one frame: a flags byte
+// (bit 0 daylight, bit 1 switch the target off for this frame) and 16
+// histogram bins, each byte scaled by 64 samples. Checks that the threshold
+// is 0 exactly when off, never leaves the range spanned by the base and the
+// clamp limits, moves at most AUTO_THRESHOLD_MAX_STEP levels per frame,
+// holds on daylight / empty frames, and settles on the cut when a frame is
+// repeated.
+// ---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "auto_threshold.h"
+#include "config.h"
+
+#define FRAME_BYTES  (1 + SCENE_HIST_BINS)
+
+static int iabs(int v) { return v < 0 ? -v : v; }
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 2) return 0;
+    uint16_t permille = data[0];   // 0 .. 255, under DAY_BRIGHT_PERMILLE
+    uint8_t  base     = data[1] ? data[1] : 1;
+    int lo = base < AUTO_THRESHOLD_MIN ? base : AUTO_THRESHOLD_MIN;
+    int hi = base > AUTO_THRESHOLD_MAX ? base : AUTO_THRESHOLD_MAX;
+
+    auto_threshold_t a;
+    auto_threshold_init(&a, base);
+    scene_stats_t st = {};
+
+    for (size_t i = 2; i + FRAME_BYTES <= size; i += FRAME_BYTES) {
+        uint8_t flags = data[i];
+        st.samples = 0;
+        for (int b = 0; b < SCENE_HIST_BINS; b++) {
+            st.hist[b] = (uint32_t)data[i + 1 + b] * 64;
+            st.samples += st.hist[b];
+        }
+        bool daylight = flags & 1;
+        uint16_t pm   = (flags & 2) ? 0 : permille;
+
+        bool    was_on = a.permille == pm && pm != 0;
+        uint8_t before = a.threshold;
+        uint8_t t = auto_threshold_update(&a, &st, pm, base, daylight);
+
+        if (t != a.threshold) abort();
+        if (pm == 0) {
+            if (t != 0) abort();
+            continue;
+        }
+        if (t < lo || t > hi) abort();
+        if (a.target < lo || a.target > hi) abort();
+        if (!was_on) continue;   // (Re)started from base this frame
+        if (daylight || st.samples == 0) {
+            if (t != before) abort();
+        } else if (iabs((int)t - (int)before) > AUTO_THRESHOLD_MAX_STEP + 1) {
+            abort();
+        }
+    }
+
+    // A scene that holds still is tracked to its cut
+    if (permille != 0 && st.samples != 0) {
+        for (int n = 0; n < 64; n++) auto_threshold_update(&a, &st, permille, base, false);
+        if (iabs((int)a.threshold - (int)a.target) > 1) abort();
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// ---------------------------------------------------------------------------
+// Fuzz target: detect_blobs() on arbitrary geometry and pixel data
+//
+// Input layout:
+//   [0..1] width  (little-endian, taken mod FUZZ_MAX_DIM + 1, may be 0)
+//   [2..3] height (same)
+//   [4.. ] pixels — tiled to fill width * height; an empty tail gives a
+//          black frame
+// Checks the result invariants every caller relies on, that the specialised
+// and generic label-map kernels agree exactly, and that the label-map and
+// bitplane paths agree whenever the frame has too few bright pixels to
+// exhaust the label table. A degraded-quality pass (load_shed.h), picked
+// from the width bytes, must keep the same invariants within its limits.
+// ---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "detector.h"
+
+#define FUZZ_MAX_DIM     1600
+#define FUZZ_MAX_PIXELS  (1600 * 1200)
+
+static void check_result(const detection_result_t *r, int width, int height)
+{
+    if (r->blob_count < 0 || r->blob_count > MAX_BLOBS) abort();
+    if (r->scene_brightness > 255) abort();
+    if (r->label_bits != 0 && r->label_bits != 8 && r->label_bits != 16) abort();
+    if (r->label_promotions != (r->label_bits == 16)) abort();
+    for (int i = 0; i < r->blob_count; i++) {
+        const blob_t *b = &r->blobs[i];
+        if (b->cx >= width || b->cy >= height) abort();
+        if (b->pixel_count < MIN_BLOB_PIXELS) abort();
+        if (b->brightness_sum < b->pixel_count * (uint32_t)BRIGHTNESS_THRESHOLD) abort();
+        if (b->saturated > b->pixel_count) abort();
+        if (b->classification != BLOB_CLASS_UNKNOWN || b->dx != 0 || b->dy != 0) abort();
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 4) return 0;
+    int width  = (int)((data[0] | (data[1] << 8)) % (FUZZ_MAX_DIM + 1));
+    int height = (int)((data[2] | (data[3] << 8)) % (FUZZ_MAX_DIM + 1));
+    if ((size_t)width * (size_t)height > FUZZ_MAX_PIXELS) return 0;
+
+    detect_quality_t q = DETECT_QUALITY_FULL;
+    q.roi_percent = (uint8_t)(data[0] % 101);
+    q.row_step    = (uint8_t)(1 + (data[1] & 3));
+    q.merge       = (uint8_t)(data[1] >> 7);
+    q.max_blobs   = (uint8_t)((data[1] >> 2) % (MAX_BLOBS + 1));
+    data += 4;
+    size -= 4;
+
+    size_t n = (size_t)width * (size_t)height;
+    // Exact-size allocation so ASan catches any read past the frame
+    uint8_t *frame = (uint8_t *)calloc(n ? n : 1, 1);
+    if (!frame) return 0;
+    for (size_t i = 0; i < n; i++) frame[i] = size ? data[i % size] : 0;
+
+    size_t bright = 0;
+    for (size_t i = 0; i < n; i++) bright += frame[i] >= BRIGHTNESS_THRESHOLD;
+
+    detection_result_t r, rg, rb, rq;
+    detect_blobs_labelmap(frame, width, height, &r);
+    detect_blobs_labelmap_generic(frame, width, height, &rg);
+    detect_blobs_bitplane(frame, width, height, &rb);
+    detect_blobs_bitplane_q(frame, width, height, &q, &rq);
+    free(frame);
+
+    if (memcmp(&r, &rg, sizeof(r)) != 0) abort();
+    if (bright < 512) {
+        if (r.blob_count != rb.blob_count || r.scene_brightness != rb.scene_brightness) abort();
+        if (memcmp(r.blobs, rb.blobs, sizeof(blob_t) * (size_t)r.blob_count) != 0) abort();
+    }
+
+    check_result(&r, width, height);
+    check_result(&rb, width, height);
+    check_result(&rq, width, height);
+    if (rq.blob_count > q.max_blobs) abort();
+    return 0;
+}
@@ -0,0 +1,87 @@
+// ---------------------------------------------------------------------------
+// Fuzz target: exposure control loop (exposure_ctrl.h)
+//
+// Every 5 input bytes are one detection result: flags (bit 0 frame washed
+// out, bit 1 day mode), blob count, the most clipped blob's saturated
+// pixels (little-endian uint16) and the bright share (per mille, 0-255).
+// Checks that the level stays in range and splits into valid sensor units,
+// that it only moves after the settle frames and in the direction the
+// frame asks for, and that day mode hands the sensor back.
+// ---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "exposure_ctrl.h"
+#include "config.h"
+
+#define LEVEL_MIN  ((uint32_t)EXPOSURE_AEC_MIN)
+#define LEVEL_MAX  ((uint32_t)EXPOSURE_AEC_MAX * (1 + EXPOSURE_GAIN_MAX))
+
+static void check_split(uint32_t level, const camera_exposure_t *e)
+{
+    if (!e->manual) abort();
+    if (e->gain > EXPOSURE_GAIN_MAX || e->aec_lines > EXPOSURE_AEC_MAX) abort();
+    uint32_t got = (uint32_t)e->aec_lines * (1 + e->gain);
+    if (got > level || got + e->gain < level) abort();   // Rounded down by < 1 + gain
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    exposure_ctrl_t x;
+    exposure_ctrl_init(&x);
+    x.enabled = true;   // Whatever EXPOSURE_CTRL ships as
+
+    static detection_result_t r;
+    uint32_t quiet = 0;   // Judged-or-settling frames since the last write
+    for (size_t i = 0; i + 5 <= size; i += 5) {
+        memset(&r, 0, sizeof(r));
+        bool day_mode = data[i] & 2;
+        r.status      = (data[i] & 1) ? DETECT_STATUS_DAYLIGHT : DETECT_STATUS_OK;
+        r.blob_count  = data[i + 1] % (MAX_BLOBS + 1);
+        uint32_t worst = (uint32_t)(data[i + 2] | data[i + 3] << 8);
+        for (int b = 0; b < r.blob_count; b++) {
+            r.blobs[b].saturated   = b == 0 ? worst : worst / (uint32_t)(b + 1);
+            r.blobs[b].pixel_count = r.blobs[b].saturated + 16;
+        }
+        if (r.blob_count == 0) worst = 0;
+        r.scene.bright_permille = data[i + 4];
+
+        bool     was_manual = x.manual;
+        uint32_t before     = x.level;
+        bool changed = exposure_ctrl_update(&x, &r, day_mode);
+
+        if (changed != x.changed) abort();
+        if (x.level < LEVEL_MIN || x.level > LEVEL_MAX) abort();
+        if (day_mode) {
+            if (x.manual || (changed && x.out.manual)) abort();
+            if (changed != was_manual || x.level != before) abort();
+            continue;
+        }
+        if (r.status == DETECT_STATUS_DAYLIGHT) {
+            if (changed || x.manual != was_manual) abort();
+            continue;
+        }
+        if (!x.manual) abort();
+        if (!was_manual) {   // Takes over at the old level
+            if (!changed || x.level != before) abort();
+            check_split(x.level, &x.out);
+            quiet = 0;
+            continue;
+        }
+        check_split(x.level, &x.out);
+
+        if (changed) {
+            if (quiet < EXPOSURE_SETTLE_FRAMES) abort();
+            bool hot = worst > EXPOSURE_SAT_HIGH_PX ||
+                       r.scene.bright_permille > EXPOSURE_BRIGHT_HIGH_PERMILLE;
+            if (hot  && x.level >= before) abort();
+            if (!hot && x.level <= before) abort();
+            quiet = 0;
+        } else {
+            quiet++;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+// ---------------------------------------------------------------------------
+// Fuzz target: frame-drop accounting (camera_frame_clock_update, camera.h)
+//
+// Byte 0 picks how much slower than the nominal 25 fps the sensor really
+// runs (0 = nominal, up to ~3.5x the period), as the OV2640 does at long
+// exposure. Every following byte is one dequeued frame: bits 0-1 are the
+// sensor frames skipped before it, bits 2-6 its timestamp jitter (within
+// +-3% of the period), bit 7 a deliberate pause (a day-mode sleep of 12
+// more frames, announced with camera_frame_clock_pause()). Checks that
+// drops are never over-reported, so a stream without skips reports none
+// however slow the sensor, that a pause reports none, and that a frame's
+// age is the dequeue delay.
+// ---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "camera.h"
+
+#define NOMINAL_US  40000u   // 25 fps
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 1) return 0;
+    camera_frame_clock_t c;
+    camera_frame_clock_reset(&c, NOMINAL_US);
+
+    const int64_t period = NOMINAL_US + (int64_t)data[0] * 400;
+    int64_t  frame = 1000;   // Sensor frame index (timestamps must be nonzero)
+    uint64_t skipped = 0, reported = 0;
+    for (size_t i = 1; i < size; i++) {
+        uint32_t skips = data[i] & 3;
+        int64_t  jitter = ((int64_t)((data[i] >> 2) & 31) - 16) * period / 512;
+        bool     pause  = data[i] & 0x80;
+        frame += 1 + skips;
+        if (pause) {
+            frame += 12;
+            camera_frame_clock_pause(&c);
+        } else if (i > 1) {
+            skipped += skips;   // The first frame has nothing before it
+        }
+
+        int64_t ts = frame * period + jitter;
+        camera_fb_t fb = {};
+        fb.timestamp.tv_sec  = (long)(ts / 1000000);
+        fb.timestamp.tv_usec = (long)(ts % 1000000);
+
+        camera_frame_info_t info;
+        camera_frame_clock_update(&c, &fb, ts + 5000, &info);
+        if (info.age_us != 5000) abort();
+        if (i == 1 && info.dropped != 0) abort();
+        if (pause && info.dropped != 0) abort();
+        if (i > 1 && info.dropped > skips) abort();
+        if (c.period_us < NOMINAL_US) abort();
+        reported += info.dropped;
+    }
+    if (reported > skipped) abort();
+    return 0;
+}
@@ -0,0 +1,64 @@
+// ---------------------------------------------------------------------------
+// Fuzz target: load-shedding governor (load_shed.h)
+//
+// Every 6 input bytes are one frame: detect time, track time and frame age,
+// each a little-endian uint16 in units of 32 us (0 .. ~2.1 s). Checks that
+// the level stays in range and moves at most one step per frame, that it
+// only steps down after LOAD_SHED_MISS_FRAMES misses in a row and only
+// steps up after a calm spell, and that the counters add up.
+// ---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "load_shed.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    load_shed_t s;
+    load_shed_init(&s);
+
+    uint32_t frames = 0, miss_run = 0, ok_run = 0;
+    for (size_t i = 0; i + 6 <= size; i += 6) {
+        uint32_t stage_us[LOAD_STAGE_COUNT];
+        stage_us[LOAD_STAGE_CAPTURE] = 0;
+        stage_us[LOAD_STAGE_DETECT]  = (uint32_t)(data[i]     | data[i + 1] << 8) * 32;
+        stage_us[LOAD_STAGE_TRACK]   = (uint32_t)(data[i + 2] | data[i + 3] << 8) * 32;
+        uint32_t age_us              = (uint32_t)(data[i + 4] | data[i + 5] << 8) * 32;
+
+        uint8_t before = s.level;
+        bool changed = load_shed_update(&s, stage_us, age_us);
+        frames++;
+
+        if (s.missed) { miss_run++; ok_run = 0; }
+        else          { ok_run++;   miss_run = 0; }
+
+        if (s.level >= LOAD_SHED_LEVELS) abort();
+        if (changed != (s.level != before) || changed != s.changed) abort();
+        if (s.level > before) {
+            if (s.level != before + 1 || miss_run < LOAD_SHED_MISS_FRAMES) abort();
+            miss_run = 0;
+        }
+        if (s.level < before) {
+            if (s.level + 1 != before || ok_run < LOAD_SHED_CALM_FRAMES) abort();
+            ok_run = 0;
+        }
+        if (s.latency_us != age_us + stage_us[LOAD_STAGE_DETECT] + stage_us[LOAD_STAGE_TRACK]) abort();
+        if (s.calm_needed < LOAD_SHED_CALM_FRAMES || s.calm_needed > LOAD_SHED_CALM_FRAMES * 8) abort();
+    }
+
+    uint32_t total = 0;
+    for (int l = 0; l < LOAD_SHED_LEVELS; l++) total += s.frames_at[l];
+    if (total != frames) abort();
+    if (s.level != s.steps_down - s.steps_up) abort();
+
+    detect_quality_t q;
+    for (int l = 0; l < LOAD_SHED_LEVELS; l++) {
+        load_shed_quality((load_shed_level_t)l, &q);
+        if (q.roi_percent == 0 || q.roi_percent > 100 || q.row_step < 1) abort();
+        if (q.max_blobs == 0 || q.max_blobs > MAX_BLOBS) abort();
+    }
+    load_shed_quality(LOAD_SHED_NONE, &q);
+    if (q.roi_percent != 100 || q.row_step != 1 || !q.merge || q.max_blobs != MAX_BLOBS) abort();
+    return 0;
+}
@@ -0,0 +1,53 @@
+// ---------------------------------------------------------------------------
+// Fuzz target: tracker_classify() over arbitrary detection sequences
+//
+// The input is consumed as a sequence of frames:
+//   [count] then count * 6 bytes: [cx_lo][cx_hi][cy_lo][cy_hi][pc_lo][pc_hi]
+// with count taken mod MAX_BLOBS + 1. Blob fields are otherwise unconstrained
+// so the tracker sees sizes and positions detect_blobs() would never emit.
+// ---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "detector.h"
+
+static bool valid_class(blob_class_t c)
+{
+    return c == BLOB_CLASS_UNKNOWN || c == BLOB_CLASS_STATIC_LIGHT ||
+           c == BLOB_CLASS_VEHICLE;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    tracker_state_t state;
+    tracker_reset(&state);
+
+    size_t i = 0;
+    while (i < size) {
+        detection_result_t r;
+        memset(&r, 0, sizeof(r));
+        r.blob_count = data[i++] % (MAX_BLOBS + 1);
+
+        for (int b = 0; b < r.blob_count; b++) {
+            uint8_t f[6] = {0};
+            for (int k = 0; k < 6 && i < size; k++) f[k] = data[i++];
+            r.blobs[b].cx          = (uint16_t)(f[0] | (f[1] << 8));
+            r.blobs[b].cy          = (uint16_t)(f[2] | (f[3] << 8));
+            r.blobs[b].pixel_count = (uint32_t)(f[4] | (f[5] << 8)) * 4u;
+        }
+
+        tracker_classify(&state, &r);
+
+        if (state.count < 0 || state.count > MAX_BLOBS) abort();
+        for (int b = 0; b < r.blob_count; b++) {
+            if (!valid_class(r.blobs[b].classification)) abort();
+        }
+        for (int s = 0; s < state.count; s++) {
+            if (!valid_class(state.confirmed_class[s]) ||
+                !valid_class(state.pending_class[s])) abort();
+        }
+    }
+    return 0;
+}
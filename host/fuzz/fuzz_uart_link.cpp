@@ -0,0 +1,57 @@
+// ---------------------------------------------------------------------------
+// Fuzz target: UART packet parser (uart_link_parser_feed)
+//
+// The input is an arbitrary received byte stream, delivered in chunks whose
+// sizes come from the stream itself to mimic short UART reads. Every decoded
+// packet must carry at most MAX_BLOBS_TX blobs, and a re-encoded packet must
+// parse back to the same blobs.
+// ---------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uart_link.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    uart_link_parser_t parser;
+    uart_link_parser_reset(&parser);
+
+    uart_blob_t blobs[MAX_BLOBS_TX];
+    int count = -1;
+
+    for (size_t i = 0; i < size; i++) {
+        uart_link_status_t st = uart_link_parser_feed(&parser, data[i], blobs, &count);
+        if (parser.len < 0 || parser.len >= UART_PACKET_SIZE) abort();
+        if (st != UART_LINK_PACKET) continue;
+        if (count < 0 || count > MAX_BLOBS_TX) abort();
+
+        // Round trip: encode what we decoded and parse it again
+        detection_result_t r;
+        memset(&r, 0, sizeof(r));
+        r.blob_count = count;
+        for (int b = 0; b < count; b++) {
+            r.blobs[b].cx          = blobs[b].cx;
+            r.blobs[b].cy          = blobs[b].cy;
+            r.blobs[b].pixel_count = blobs[b].pixel_count;
+        }
+        uint8_t pkt[UART_PACKET_SIZE];
+        if (uart_link_encode(&r, pkt) != UART_PACKET_SIZE) abort();
+
+        uart_link_parser_t p2;
+        uart_link_parser_reset(&p2);
+        uart_blob_t again[MAX_BLOBS_TX];
+        int n2 = -1;
+        int packets = 0;
+        for (int k = 0; k < UART_PACKET_SIZE; k++) {
+            if (uart_link_parser_feed(&p2, pkt[k], again, &n2) == UART_LINK_PACKET) packets++;
+        }
+        if (packets != 1 || n2 != count) abort();
+        for (int b = 0; b < count; b++) {
+            if (again[b].cx != blobs[b].cx || again[b].cy != blobs[b].cy ||
+                again[b].pixel_count != blobs[b].pixel_count) abort();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+// ---------------------------------------------------------------------------
+// Standalone driver for the fuzz targets when libFuzzer is unavailable
+// (e.g. GCC builds). Replays every corpus file given on the command line
+// (files or directories), optionally followed by a simple mutation loop, and
+// flags inputs slower than a threshold.
+//
+//   fuzz_<target> [-runs=N] [-seed=N] [-slow_ms=N] corpus_dir_or_file ...
+//
+// Accepts the libFuzzer-style flags above so the same ctest / script
+// command lines work for both builds; other -flags are ignored.
+// ---------------------------------------------------------------------------
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "host_time.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+#define MUTATE_MAX_SIZE  (64 * 1024)
+
+static unsigned long s_slow_ms = 1000;
+static int           s_slow_count;
+
+// Input currently under test, dumped to ./crash-input on a fatal signal so
+// mutation-found crashes can be replayed
+static const uint8_t *s_cur_data;
+static size_t         s_cur_size;
+
+static void on_fatal(int sig)
+{
+    int fd = open("crash-input", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        if (s_cur_size && write(fd, s_cur_data, s_cur_size) < 0) { /* nothing to do */ }
+        close(fd);
+    }
+    static const char msg[] = "fatal signal: input written to ./crash-input\n";
+    if (write(2, msg, sizeof(msg) - 1) < 0) { /* nothing to do */ }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static bool read_file(const char *path, std::vector<uint8_t> *out)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    out->clear();
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->insert(out->end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+static void run_one(const char *label, const std::vector<uint8_t> &input)
+{
+    s_cur_data = input.data();
+    s_cur_size = input.size();
+    uint64_t t0 = host_now_ns();
+    LLVMFuzzerTestOneInput(input.empty() ? NULL : input.data(), input.size());
+    uint64_t ms = (host_now_ns() - t0) / 1000000ull;
+    if (ms >= s_slow_ms) {
+        fprintf(stderr, "SLOW %s: %llu ms (%zu bytes)\n", label,
+                (unsigned long long)ms, input.size());
+        s_slow_count++;
+    }
+}
+
+static void collect(const char *path, std::vector<std::string> *files)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "cannot stat %s\n", path);
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        files->push_back(path);
+        return;
+    }
+    DIR *d = opendir(path);
+    if (!d) return;
+    struct dirent *e;
+    std::vector<std::string> names;
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        names.push_back(std::string(path) + "/" + e->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    for (const std::string &n : names) files->push_back(n);
+}
+
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+// Byte flips, inserts, erases and splices of corpus inputs
+static void mutate(std::vector<uint8_t> *in, uint32_t *rng)
+{
+    int ops = 1 + (int)(xorshift32(rng) % 4);
+    for (int k = 0; k < ops; k++) {
+        uint32_t r = xorshift32(rng);
+        size_t pos = in->empty() ? 0 : r % in->size();
+        switch ((r >> 24) % 4) {
+            case 0:
+                if (!in->empty()) (*in)[pos] ^= (uint8_t)(1u << ((r >> 16) & 7));
+                break;
+            case 1:
+                if (!in->empty()) (*in)[pos] = (uint8_t)(r >> 8);
+                break;
+            case 2:
+                if (in->size() < MUTATE_MAX_SIZE) in->insert(in->begin() + (long)pos, (uint8_t)(r >> 8));
+                break;
+            default:
+                if (!in->empty()) in->erase(in->begin() + (long)pos);
+                break;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long runs = 0;
+    uint32_t seed = 1;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if      (strncmp(a, "-runs=", 6) == 0)    runs = atol(a + 6);
+        else if (strncmp(a, "-seed=", 6) == 0)    seed = (uint32_t)strtoul(a + 6, NULL, 0);
+        else if (strncmp(a, "-slow_ms=", 9) == 0) s_slow_ms = strtoul(a + 9, NULL, 0);
+        else if (a[0] == '-')                     continue;
+        else                                      collect(a, &files);
+    }
+    if (seed == 0) seed = 1;
+
+    signal(SIGSEGV, on_fatal);
+    signal(SIGABRT, on_fatal);
+    signal(SIGFPE,  on_fatal);
+    signal(SIGBUS,  on_fatal);
+
+    std::vector<std::vector<uint8_t>> corpus;
+    for (const std::string &path : files) {
+        std::vector<uint8_t> data;
+        if (!read_file(path.c_str(), &data)) {
+            fprintf(stderr, "cannot read %s\n", path.c_str());
+            return 2;
+        }
+        run_one(path.c_str(), data);
+        corpus.push_back(data);
+    }
+    if (corpus.empty()) corpus.push_back(std::vector<uint8_t>());
+
+    for (long r = 0; r < runs; r++) {
+        std::vector<uint8_t> in = corpus[xorshift32(&seed) % corpus.size()];
+        mutate(&in, &seed);
+        char label[32];
+        snprintf(label, sizeof(label), "mutation %ld", r);
+        run_one(label, in);
+    }
+
+    printf("%zu corpus inputs, %ld mutations, %d slow\n", files.size(), runs, s_slow_count);
+    return s_slow_count ? 1 : 0;
+}
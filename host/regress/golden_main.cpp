@@ -0,0 +1,645 @@
+// ---------------------------------------------------------------------------
+// camtest_golden — golden-output regression harness for detect_blobs() and
+// tracker_classify()
+//
+// Runs every corpus entry (synthetic scenes and .cfr recordings) through the
+// detector and tracker and diffs every detection_result_t field against the
+// checked-in golden files, within per-field tolerances. Entries run in
+// parallel worker processes (the detector keeps its union-find table in a
+// static, so workers are forked rather than threaded).
+//
+// On the first divergence in an entry a minimal reproducer is written:
+//   detector field differs -> <entry>_f<N>.pgm  (the single frame)
+//   tracker field differs  -> <entry>_f<N>.cfr  (frames since the last
+//                                                  tracker reset, max 32)
+// plus <entry>_f<N>.txt with the expected and actual records.
+//
+//   camtest_golden [--corpus FILE] [--golden DIR] [--out DIR] [--jobs N]
+//                  [--update] [--filter NAME]
+//   camtest_golden --frame frame.pgm       print one frame's record
+// ---------------------------------------------------------------------------
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "detector.h"
+
+#include "pgm.h"
+#include "rec_file.h"
+#include "scene.h"
+#include "synth.h"
+
+#ifndef CAMTEST_REGRESS_DIR
+#define CAMTEST_REGRESS_DIR "."
+#endif
+
+#define GOLDEN_MAGIC        "# camtest golden v1"
+#define REPRO_WINDOW_MAX    32
+
+// ---------------------------------------------------------------------------
+// detection_result_t field table — add new fields here
+// ---------------------------------------------------------------------------
+typedef int64_t (*field_get_t)(const detection_result_t *r, int blob);
+
+typedef struct {
+    const char *name;
+    bool        per_blob;   // false: one value per frame
+    bool        tracker;    // true: written by tracker_classify()
+    field_get_t get;
+} field_def_t;
+
+static const field_def_t k_fields[] = {
+    { "blob_count",       false, false, [](const detection_result_t *r, int) -> int64_t { return r->blob_count; } },
+    { "scene_brightness", false, false, [](const detection_result_t *r, int) -> int64_t { return r->scene_brightness; } },
+    { "status",           false, false, [](const detection_result_t *r, int) -> int64_t { return r->status; } },
+    { "cx",               true,  false, [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].cx; } },
+    { "cy",               true,  false, [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].cy; } },
+    { "pixel_count",      true,  false, [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].pixel_count; } },
+    { "brightness_sum",   true,  false, [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].brightness_sum; } },
+    { "saturated",        true,  false, [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].saturated; } },
+    { "classification",   true,  true,  [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].classification; } },
+    { "dx",               true,  true,  [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].dx; } },
+    { "dy",               true,  true,  [](const detection_result_t *r, int b) -> int64_t { return r->blobs[b].dy; } },
+};
+#define NUM_FIELDS (int)(sizeof(k_fields) / sizeof(k_fields[0]))
+
+typedef struct {
+    int64_t abs;      // Allowed absolute difference
+    double  rel_pct;  // Allowed difference as a percentage of the golden value
+} tolerance_t;
+
+// ---------------------------------------------------------------------------
+// Corpus
+// ---------------------------------------------------------------------------
+typedef struct {
+    std::string name;
+    std::string source;    // "synth:PRESET:WxH[:key=val,...]" or "rec:path.cfr"
+    int         frames;    // -1 = whole recording
+} corpus_entry_t;
+
+typedef struct {
+    std::vector<corpus_entry_t> entries;
+    tolerance_t                 tol[NUM_FIELDS];
+    std::string                 dir;          // Corpus file directory
+} corpus_t;
+
+static int field_index(const char *name)
+{
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        if (strcmp(k_fields[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Format per line:  entry NAME SOURCE FRAMES   |   tol FIELD VALUE[%]
+static bool corpus_load(const char *path, corpus_t *c)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open corpus %s\n", path);
+        return false;
+    }
+    for (int i = 0; i < NUM_FIELDS; i++) c->tol[i] = { 0, 0.0 };
+    const char *slash = strrchr(path, '/');
+    c->dir = slash ? std::string(path, (size_t)(slash - path)) : std::string(".");
+
+    char line[512];
+    int lineno = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char kw[32], a[256], b[256];
+        int frames = -1;
+        int n = sscanf(line, "%31s %255s %255s %d", kw, a, b, &frames);
+        if (n <= 0) continue;
+
+        if (strcmp(kw, "entry") == 0 && n >= 3) {
+            c->entries.push_back({ a, b, n == 4 ? frames : -1 });
+        } else if (strcmp(kw, "tol") == 0 && n == 3) {
+            int fi = field_index(a);
+            if (fi < 0) {
+                fprintf(stderr, "%s:%d: unknown field '%s'\n", path, lineno, a);
+                ok = false;
+                continue;
+            }
+            size_t len = strlen(b);
+            if (len > 0 && b[len - 1] == '%') c->tol[fi].rel_pct = atof(b);
+            else                              c->tol[fi].abs     = atoll(b);
+        } else {
+            fprintf(stderr, "%s:%d: cannot parse\n", path, lineno);
+            ok = false;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Frame sources
+// ---------------------------------------------------------------------------
+typedef struct {
+    bool       is_rec;
+    scene_t    scene;
+    rec_file_t rec;
+    int        width;
+    int        height;
+    int        frames;
+} source_t;
+
+// Apply "key=val,key=val" overrides to scene parameters
+static bool apply_overrides(scene_params_t *p, const char *spec)
+{
+    std::string s(spec);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t end = s.find(',', pos);
+        if (end == std::string::npos) end = s.size();
+        std::string kv = s.substr(pos, end - pos);
+        size_t eq = kv.find('=');
+        if (eq == std::string::npos) return false;
+        std::string k = kv.substr(0, eq);
+        double v = atof(kv.c_str() + eq + 1);
+
+        if      (k == "seed")      p->seed = (uint32_t)v;
+        else if (k == "vehicles")  p->vehicles = (int)v;
+        else if (k == "lamps")     p->streetlamps = (int)v;
+        else if (k == "dual_led")  p->dual_led_prob = (float)v;
+        else if (k == "wet")       p->wet_road = v != 0.0;
+        else if (k == "noise")     p->noise_sigma = (float)v;
+        else if (k == "washout")   p->washout_prob = (float)v;
+        else if (k == "lean")      p->lean_deg = (float)v;
+        else if (k == "ego_speed") p->ego_speed_mps = (float)v;
+        else if (k == "exposure")  p->exposure = (float)v;
+        else return false;
+        pos = end + 1;
+    }
+    return true;
+}
+
+static bool source_open(source_t *src, const corpus_t *c, const corpus_entry_t *e)
+{
+    memset(src, 0, sizeof(*src));
+    const char *spec = e->source.c_str();
+
+    if (strncmp(spec, "rec:", 4) == 0) {
+        std::string path = spec + 4;
+        if (path[0] != '/') path = c->dir + "/" + path;
+        if (!rec_open(path.c_str(), &src->rec)) return false;
+        src->is_rec = true;
+        src->width  = rec_width(&src->rec);
+        src->height = rec_height(&src->rec);
+        src->frames = (int)src->rec.frame_count;
+        if (e->frames >= 0 && e->frames < src->frames) src->frames = e->frames;
+        return true;
+    }
+
+    char preset[32], size[32], overrides[256] = "";
+    if (sscanf(spec, "synth:%31[^:]:%31[^:]:%255s", preset, size, overrides) < 2) return false;
+    int scene = synth_scene_from_name(preset);
+    int w, h;
+    if (scene < 0 || sscanf(size, "%dx%d", &w, &h) != 2) return false;
+
+    scene_params_t p;
+    synth_params((synth_scene_t)scene, w, h, &p);
+    if (overrides[0] && !apply_overrides(&p, overrides)) return false;
+
+    scene_build(&src->scene, &p);
+    src->width  = w;
+    src->height = h;
+    src->frames = e->frames > 0 ? e->frames : 1;
+    return true;
+}
+
+static const uint8_t *source_frame(source_t *src, int i, uint8_t *buf)
+{
+    if (src->is_rec) return rec_frame_pixels(&src->rec, (uint32_t)i, buf);
+    scene_render(&src->scene, (uint32_t)i, SCENE_VIEW_PRIMARY, buf, NULL);
+    return buf;
+}
+
+static void source_close(source_t *src)
+{
+    if (src->is_rec) rec_close(&src->rec);
+}
+
+// ---------------------------------------------------------------------------
+// Records
+// ---------------------------------------------------------------------------
+typedef std::map<std::string, int64_t> kv_t;
+
+typedef struct {
+    kv_t              frame;
+    std::vector<kv_t> blobs;
+} record_t;
+
+static record_t record_from_result(const detection_result_t *r)
+{
+    record_t rec;
+    for (int f = 0; f < NUM_FIELDS; f++) {
+        if (!k_fields[f].per_blob) rec.frame[k_fields[f].name] = k_fields[f].get(r, 0);
+    }
+    for (int b = 0; b < r->blob_count; b++) {
+        kv_t kv;
+        for (int f = 0; f < NUM_FIELDS; f++) {
+            if (k_fields[f].per_blob) kv[k_fields[f].name] = k_fields[f].get(r, b);
+        }
+        rec.blobs.push_back(kv);
+    }
+    return rec;
+}
+
+// Fields the record lacks (a golden from before the field existed) are skipped
+static void record_write(FILE *f, int frame, const record_t *rec)
+{
+    fprintf(f, "frame %d", frame);
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        if (k_fields[i].per_blob || !rec->frame.count(k_fields[i].name)) continue;
+        fprintf(f, " %s=%lld", k_fields[i].name, (long long)rec->frame.at(k_fields[i].name));
+    }
+    fprintf(f, "\n");
+    for (const kv_t &kv : rec->blobs) {
+        fprintf(f, "  blob");
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            if (!k_fields[i].per_blob || !kv.count(k_fields[i].name)) continue;
+            fprintf(f, " %s=%lld", k_fields[i].name, (long long)kv.at(k_fields[i].name));
+        }
+        fprintf(f, "\n");
+    }
+}
+
+static void parse_kv(const char *s, kv_t *out)
+{
+    char key[64];
+    long long v;
+    int used;
+    while (sscanf(s, " %63[^=]=%lld%n", key, &v, &used) == 2) {
+        (*out)[key] = v;
+        s += used;
+    }
+}
+
+static bool golden_load(const char *path, std::vector<record_t> *out)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[1024];
+    bool ok = fgets(line, sizeof(line), f) &&
+              strncmp(line, GOLDEN_MAGIC, strlen(GOLDEN_MAGIC)) == 0;
+    while (ok && fgets(line, sizeof(line), f)) {
+        int frame, used;
+        if (sscanf(line, "frame %d%n", &frame, &used) == 1) {
+            if (frame != (int)out->size()) ok = false;
+            out->push_back(record_t());
+            parse_kv(line + used, &out->back().frame);
+        } else if (strncmp(line, "  blob", 6) == 0 && !out->empty()) {
+            out->back().blobs.push_back(kv_t());
+            parse_kv(line + 6, &out->back().blobs.back());
+        } else if (line[0] != '#' && line[0] != '\n') {
+            ok = false;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Comparison
+// ---------------------------------------------------------------------------
+static bool within(const tolerance_t *t, int64_t expected, int64_t actual)
+{
+    int64_t diff = expected > actual ? expected - actual : actual - expected;
+    double rel = t->rel_pct * 0.01 * (double)(expected < 0 ? -expected : expected);
+    return diff <= t->abs || (double)diff <= rel;
+}
+
+// Returns the first diverging field (index into k_fields) or -1 if equal.
+// Fields missing from the golden record are not checked.
+static int compare(const corpus_t *c, const record_t *exp, const record_t *act,
+                   int *blob_out, int64_t *e_out, int64_t *a_out)
+{
+    for (int f = 0; f < NUM_FIELDS; f++) {
+        if (k_fields[f].per_blob) continue;
+        auto it = exp->frame.find(k_fields[f].name);
+        if (it == exp->frame.end()) continue;
+        int64_t a = act->frame.at(k_fields[f].name);
+        if (!within(&c->tol[f], it->second, a)) {
+            *blob_out = -1;
+            *e_out = it->second;
+            *a_out = a;
+            return f;
+        }
+    }
+    size_t n = exp->blobs.size() < act->blobs.size() ? exp->blobs.size() : act->blobs.size();
+    for (size_t b = 0; b < n; b++) {
+        for (int f = 0; f < NUM_FIELDS; f++) {
+            if (!k_fields[f].per_blob) continue;
+            auto it = exp->blobs[b].find(k_fields[f].name);
+            if (it == exp->blobs[b].end()) continue;
+            int64_t a = act->blobs[b].at(k_fields[f].name);
+            if (!within(&c->tol[f], it->second, a)) {
+                *blob_out = (int)b;
+                *e_out = it->second;
+                *a_out = a;
+                return f;
+            }
+        }
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Worker — one corpus entry, runs in a child process
+// ---------------------------------------------------------------------------
+typedef struct {
+    const corpus_t *corpus;
+    std::string     golden_dir;
+    std::string     out_dir;
+    bool            update;
+} run_opts_t;
+
+static void write_repro(const run_opts_t *o, const corpus_entry_t *e, source_t *src,
+                        int frame, bool tracker_field, const std::vector<record_t> &exp,
+                        const record_t &act, FILE *report)
+{
+    char base[1024];
+    snprintf(base, sizeof(base), "%s/%s_f%d", o->out_dir.c_str(), e->name.c_str(), frame);
+    size_t n = (size_t)src->width * src->height;
+    std::vector<uint8_t> buf(n);
+
+    char path[1100];
+    if (!tracker_field) {
+        // Detector output depends only on this frame
+        snprintf(path, sizeof(path), "%s.pgm", base);
+        const uint8_t *px = source_frame(src, frame, buf.data());
+        if (px && pgm_save(path, px, src->width, src->height)) {
+            fprintf(report, "  reproducer: %s\n", path);
+        }
+    } else {
+        // Tracker output depends on history: replay from the last empty frame
+        // (tracker_classify() resets itself on an empty result)
+        int start = frame;
+        while (start > 0 && frame - start < REPRO_WINDOW_MAX - 1 &&
+               exp[(size_t)start - 1].frame.count("blob_count") &&
+               exp[(size_t)start - 1].frame.at("blob_count") != 0) {
+            start--;
+        }
+        snprintf(path, sizeof(path), "%s.cfr", base);
+        rec_writer_t w;
+        bool ok = rec_writer_open(&w, path, src->width, src->height, 25000);
+        for (int i = start; ok && i <= frame; i++) {
+            const uint8_t *px = source_frame(src, i, buf.data());
+            ok = px && rec_writer_add(&w, px, (uint64_t)(i - start) * 40000u, NULL,
+                                      FREC_CODEC_RLE, 0);
+        }
+        bool fresh = start == 0 || (exp[(size_t)start - 1].frame.count("blob_count") &&
+                                    exp[(size_t)start - 1].frame.at("blob_count") == 0);
+        if (rec_writer_close(&w) && ok) {
+            fprintf(report, "  reproducer: %s (frames %d..%d%s)\n", path, start, frame,
+                    fresh ? "" : ", window capped: tracker history truncated");
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s.txt", base);
+    FILE *f = fopen(path, "w");
+    if (f) {
+        fprintf(f, "# expected\n");
+        record_write(f, frame, &exp[(size_t)frame]);
+        fprintf(f, "# actual\n");
+        record_write(f, frame, &act);
+        fclose(f);
+    }
+}
+
+static int run_entry(const run_opts_t *o, const corpus_entry_t *e, FILE *report)
+{
+    source_t src;
+    if (!source_open(&src, o->corpus, e)) {
+        fprintf(report, "ERROR %s: cannot open source '%s'\n", e->name.c_str(), e->source.c_str());
+        return 2;
+    }
+
+    std::string gpath = o->golden_dir + "/" + e->name + ".golden";
+    std::vector<record_t> expected;
+    if (!o->update && !golden_load(gpath.c_str(), &expected)) {
+        fprintf(report, "ERROR %s: missing or corrupt %s (run with --update)\n",
+                e->name.c_str(), gpath.c_str());
+        source_close(&src);
+        return 2;
+    }
+    if (!o->update && (int)expected.size() != src.frames) {
+        fprintf(report, "FAIL  %s: golden has %zu frames, corpus has %d\n",
+                e->name.c_str(), expected.size(), src.frames);
+        source_close(&src);
+        return 1;
+    }
+
+    FILE *gf = NULL;
+    if (o->update) {
+        gf = fopen(gpath.c_str(), "w");
+        if (!gf) {
+            fprintf(report, "ERROR %s: cannot write %s\n", e->name.c_str(), gpath.c_str());
+            source_close(&src);
+            return 2;
+        }
+        fprintf(gf, GOLDEN_MAGIC " entry=%s source=%s\n", e->name.c_str(), e->source.c_str());
+    }
+
+    std::vector<uint8_t> buf((size_t)src.width * src.height);
+    tracker_state_t tracker;
+    tracker_reset(&tracker);
+    int rc = 0;
+
+    for (int i = 0; i < src.frames; i++) {
+        const uint8_t *px = source_frame(&src, i, buf.data());
+        if (!px) {
+            fprintf(report, "ERROR %s: frame %d unreadable\n", e->name.c_str(), i);
+            rc = 2;
+            break;
+        }
+        detection_result_t r;
+        detect_blobs(px, src.width, src.height, &r);
+        tracker_classify(&tracker, &r);
+        record_t act = record_from_result(&r);
+
+        if (o->update) {
+            record_write(gf, i, &act);
+            continue;
+        }
+
+        int blob;
+        int64_t ev, av;
+        int f = compare(o->corpus, &expected[(size_t)i], &act, &blob, &ev, &av);
+        if (f >= 0) {
+            if (blob >= 0) {
+                fprintf(report, "FAIL  %s: frame %d blob %d %s expected %lld got %lld\n",
+                        e->name.c_str(), i, blob, k_fields[f].name, (long long)ev, (long long)av);
+            } else {
+                fprintf(report, "FAIL  %s: frame %d %s expected %lld got %lld\n",
+                        e->name.c_str(), i, k_fields[f].name, (long long)ev, (long long)av);
+            }
+            write_repro(o, e, &src, i, k_fields[f].tracker, expected, act, report);
+            rc = 1;
+            break;
+        }
+    }
+
+    if (gf) fclose(gf);
+    if (rc == 0) {
+        fprintf(report, "%s %s (%d frames)\n", o->update ? "WROTE" : "ok   ",
+                e->name.c_str(), src.frames);
+    }
+    source_close(&src);
+    return rc;
+}
+
+// ---------------------------------------------------------------------------
+// Process pool
+// ---------------------------------------------------------------------------
+typedef struct {
+    pid_t       pid;
+    int         fd;      // Read end of the child's report pipe
+    std::string output;
+} child_t;
+
+static void drain(child_t *c)
+{
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(c->fd, buf, sizeof(buf))) > 0) c->output.append(buf, (size_t)n);
+}
+
+static int run_all(const run_opts_t *o, const std::vector<const corpus_entry_t *> &todo, int jobs)
+{
+    std::vector<child_t> running;
+    size_t next = 0;
+    int failures = 0, errors = 0;
+
+    while (next < todo.size() || !running.empty()) {
+        while (next < todo.size() && (int)running.size() < jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                perror("pipe");
+                return 2;
+            }
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return 2;
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                FILE *report = fdopen(fds[1], "w");
+                int rc = run_entry(o, todo[next], report);
+                fclose(report);
+                _exit(rc);
+            }
+            close(fds[1]);
+            running.push_back({ pid, fds[0], std::string() });
+            next++;
+        }
+
+        // Reports are short, but drain every child so none blocks on a full pipe
+        int status;
+        pid_t done = waitpid(-1, &status, 0);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            perror("waitpid");
+            return 2;
+        }
+        for (size_t i = 0; i < running.size(); i++) {
+            if (running[i].pid != done) continue;
+            drain(&running[i]);
+            close(running[i].fd);
+            fputs(running[i].output.c_str(), stdout);
+            int rc = WIFEXITED(status) ? WEXITSTATUS(status) : 3;
+            if (rc == 1) failures++;
+            else if (rc != 0) {
+                if (rc == 3) printf("CRASH worker for entry (signal %d)\n", WTERMSIG(status));
+                errors++;
+            }
+            running.erase(running.begin() + (long)i);
+            break;
+        }
+    }
+
+    printf("%zu entries, %d failed, %d errors\n", todo.size(), failures, errors);
+    return (failures || errors) ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Command line
+// ---------------------------------------------------------------------------
+static int print_frame(const char *path)
+{
+    pgm_image_t img;
+    if (!pgm_load(path, &img)) {
+        fprintf(stderr, "cannot load %s\n", path);
+        return 2;
+    }
+    detection_result_t r;
+    detect_blobs(img.pixels, img.width, img.height, &r);
+    record_t rec = record_from_result(&r);
+    record_write(stdout, 0, &rec);
+    pgm_free(&img);
+    return 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: camtest_golden [--corpus FILE] [--golden DIR] [--out DIR] [--jobs N]\n"
+            "                      [--update] [--filter NAME]\n"
+            "       camtest_golden --frame frame.pgm\n");
+}
+
+int main(int argc, char **argv)
+{
+    std::string corpus_path = CAMTEST_REGRESS_DIR "/corpus.txt";
+    std::string golden_dir;
+    std::string out_dir = ".";
+    const char *filter = NULL;
+    bool update = false;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool has_val = i + 1 < argc;
+        if      (strcmp(a, "--corpus") == 0 && has_val) corpus_path = argv[++i];
+        else if (strcmp(a, "--golden") == 0 && has_val) golden_dir = argv[++i];
+        else if (strcmp(a, "--out") == 0 && has_val)    out_dir = argv[++i];
+        else if (strcmp(a, "--jobs") == 0 && has_val)   jobs = atol(argv[++i]);
+        else if (strcmp(a, "--filter") == 0 && has_val) filter = argv[++i];
+        else if (strcmp(a, "--frame") == 0 && has_val)  return print_frame(argv[++i]);
+        else if (strcmp(a, "--update") == 0)            update = true;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (jobs < 1) jobs = 1;
+
+    corpus_t corpus;
+    if (!corpus_load(corpus_path.c_str(), &corpus)) return 2;
+    if (golden_dir.empty()) golden_dir = corpus.dir + "/golden";
+
+    std::vector<const corpus_entry_t *> todo;
+    for (const corpus_entry_t &e : corpus.entries) {
+        if (!filter || e.name.find(filter) != std::string::npos) todo.push_back(&e);
+    }
+
+    run_opts_t o = { &corpus, golden_dir, out_dir, update };
+    return run_all(&o, todo, (int)jobs);
+}
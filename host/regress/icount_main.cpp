@@ -0,0 +1,364 @@
+// ---------------------------------------------------------------------------
+// camtest_icount — instruction-count regression gate
+//
+// Counts retired instructions per frame for detect_blobs(),
+// tracker_classify() and the stereo stage (pipeline_stereo_match() +
+// triangulation) over fixed synthetic scenes, and compares them against a
+// stored baseline. Unlike camtest_bench timings, the counts are
+// deterministic for a given compiler and flags, so a small threshold is
+// usable on a shared CI box.
+//
+//   camtest_icount [--baseline FILE] [--update] [--threshold PCT]
+//                  [--backend auto|perf|ptrace] [--frames N] [--filter NAME]
+//
+// --frames sets the detect job length (default 2); tracker and stereo jobs
+// run TRACK_FRAME_FACTOR times as many frames.
+//
+// Exit status: 0 pass, 1 regression, 2 error, 77 skipped (no counter
+// backend, or the baseline was recorded with a different compiler config).
+// ---------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "detector.h"
+#include "pipeline.h"
+#include "uart_link.h"
+
+#include "icount.h"
+#include "scene.h"
+#include "synth.h"
+
+#ifndef CAMTEST_REGRESS_DIR
+#define CAMTEST_REGRESS_DIR "."
+#endif
+#ifndef CAMTEST_ICOUNT_CONFIG
+#define CAMTEST_ICOUNT_CONFIG "unknown"
+#endif
+
+#define ICOUNT_MAGIC        "# camtest icount v1"
+#define ICOUNT_EXIT_SKIP    77
+
+// Scenes measured by the gate. QQVGA keeps the ptrace backend affordable
+// (~100k instructions/s); per-pixel work scales linearly, so regressions
+// still show. The cheap per-blob stages run TRACK_FRAME_FACTOR times as many
+// frames so the tracker gets past its confirmation window.
+static const synth_scene_t k_scenes[] = {
+    SYNTH_SCENE_DARK,
+    SYNTH_SCENE_HEADLIGHTS,
+    SYNTH_SCENE_CITY,
+    SYNTH_SCENE_WET,
+};
+#define NUM_SCENES  (int)(sizeof(k_scenes) / sizeof(k_scenes[0]))
+#define GATE_WIDTH  160
+#define GATE_HEIGHT 120
+#define TRACK_FRAME_FACTOR 8
+
+typedef enum {
+    STAGE_DETECT = 0,
+    STAGE_TRACK  = 1,
+    STAGE_STEREO = 2,
+    STAGE_COUNT
+} stage_t;
+
+static const char *const k_stage_names[STAGE_COUNT] = { "detect", "track", "stereo" };
+
+// ---------------------------------------------------------------------------
+// Measured job — inputs are prepared in the counting child, uncounted
+// ---------------------------------------------------------------------------
+typedef struct {
+    synth_scene_t scene;
+    stage_t       stage;
+    int           width;
+    int           height;
+    int           frames;
+
+    std::vector<std::vector<uint8_t>> pri;
+    std::vector<detection_result_t>   pri_results;
+    std::vector<uart_blob_t>          sec_blobs;   // frames * MAX_BLOBS_TX
+    std::vector<int>                  sec_counts;
+    uint32_t                          sink;
+} job_t;
+
+static void job_setup(void *user)
+{
+    job_t *j = (job_t *)user;
+    scene_params_t params;
+    synth_params(j->scene, j->width, j->height, &params);
+    scene_t *s = (scene_t *)malloc(sizeof(scene_t));
+    scene_build(s, &params);
+
+    size_t npx = (size_t)j->width * (size_t)j->height;
+    std::vector<uint8_t> sec(npx);
+    j->pri.assign(j->frames, std::vector<uint8_t>(npx));
+    j->pri_results.resize(j->frames);
+    j->sec_blobs.assign((size_t)j->frames * MAX_BLOBS_TX, uart_blob_t());
+    j->sec_counts.assign(j->frames, 0);
+
+    for (int f = 0; f < j->frames; f++) {
+        scene_render(s, (uint32_t)f, SCENE_VIEW_PRIMARY, j->pri[f].data(), NULL);
+        if (j->stage == STAGE_DETECT) continue;
+
+        detect_blobs(j->pri[f].data(), j->width, j->height, &j->pri_results[f]);
+        if (j->stage != STAGE_STEREO) continue;
+
+        detection_result_t sr;
+        scene_render(s, (uint32_t)f, SCENE_VIEW_SECONDARY, sec.data(), NULL);
+        detect_blobs(sec.data(), j->width, j->height, &sr);
+        int n = sr.blob_count < MAX_BLOBS_TX ? sr.blob_count : MAX_BLOBS_TX;
+        for (int i = 0; i < n; i++) {
+            uart_blob_t *ub = &j->sec_blobs[(size_t)f * MAX_BLOBS_TX + i];
+            ub->cx          = sr.blobs[i].cx;
+            ub->cy          = sr.blobs[i].cy;
+            ub->pixel_count = (uint16_t)(sr.blobs[i].pixel_count > 0xFFFF
+                                         ? 0xFFFF : sr.blobs[i].pixel_count);
+        }
+        j->sec_counts[f] = n;
+    }
+    free(s);
+}
+
+static void job_region(void *user)
+{
+    job_t *j = (job_t *)user;
+    uint32_t sink = 0;
+
+    switch (j->stage) {
+        case STAGE_DETECT: {
+            detection_result_t r;
+            for (int f = 0; f < j->frames; f++) {
+                detect_blobs(j->pri[f].data(), j->width, j->height, &r);
+                sink += (uint32_t)r.blob_count;
+            }
+            break;
+        }
+        case STAGE_TRACK: {
+            tracker_state_t t;
+            tracker_reset(&t);
+            for (int f = 0; f < j->frames; f++) {
+                tracker_classify(&t, &j->pri_results[f]);
+                sink += (uint32_t)t.count;
+            }
+            break;
+        }
+        case STAGE_STEREO:
+            for (int f = 0; f < j->frames; f++) {
+                stereo_match_t m = pipeline_stereo_match(
+                    &j->pri_results[f], &j->sec_blobs[(size_t)f * MAX_BLOBS_TX],
+                    j->sec_counts[f]);
+                sink += (uint32_t)m.pri + (uint32_t)(m.distance_m * 10.0f);
+            }
+            break;
+        default:
+            break;
+    }
+    j->sink = sink;
+}
+
+// ---------------------------------------------------------------------------
+// Baseline file
+//   # camtest icount v1
+//   # config <compiler-id>-<version> <build type>
+//   <scene> <stage> <WxH> <frames> <instructions per frame>
+// ---------------------------------------------------------------------------
+typedef struct {
+    std::string                     config;
+    std::map<std::string, uint64_t> per_frame;   // "scene stage WxH" -> instr/frame
+} baseline_t;
+
+static std::string make_key(const char *scene, const char *stage, int w, int h)
+{
+    char key[96];
+    snprintf(key, sizeof(key), "%s %s %dx%d", scene, stage, w, h);
+    return key;
+}
+
+static bool baseline_load(const char *path, baseline_t *b)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[256];
+    bool ok = fgets(line, sizeof(line), f) && strncmp(line, ICOUNT_MAGIC, strlen(ICOUNT_MAGIC)) == 0;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "# config ", 9) == 0) {
+            b->config = line + 9;
+            continue;
+        }
+        if (line[0] == '#' || line[0] == '\0') continue;
+
+        char scene[32], stage[32], res[32];
+        int frames;
+        unsigned long long per_frame;
+        if (sscanf(line, "%31s %31s %31s %d %llu", scene, stage, res, &frames, &per_frame) != 5) {
+            fprintf(stderr, "%s: bad line: %s\n", path, line);
+            ok = false;
+            break;
+        }
+        b->per_frame[std::string(scene) + " " + stage + " " + res] = per_frame;
+    }
+    fclose(f);
+    return ok;
+}
+
+typedef struct {
+    std::string key;
+    int         frames;
+    uint64_t    per_frame;
+} measurement_t;
+
+static bool baseline_save(const char *path, const std::vector<measurement_t> &m,
+                          icount_backend_t backend)
+{
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "%s\n", ICOUNT_MAGIC);
+    fprintf(f, "# config %s\n", CAMTEST_ICOUNT_CONFIG);
+    fprintf(f, "# recorded with the %s backend; regenerate with camtest_icount --update\n",
+            icount_backend_name(backend));
+    for (const measurement_t &x : m) {
+        // key is "scene stage WxH"; frames goes between res and the count
+        fprintf(f, "%s %d %llu\n", x.key.c_str(), x.frames, (unsigned long long)x.per_frame);
+    }
+    fclose(f);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Main
+// ---------------------------------------------------------------------------
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: camtest_icount [--baseline FILE] [--update] [--threshold PCT]\n"
+            "                      [--backend auto|perf|ptrace] [--frames N] [--filter NAME]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *baseline_path = CAMTEST_REGRESS_DIR "/icount_baseline.txt";
+    const char *backend_name  = "auto";
+    const char *filter        = NULL;
+    bool        update        = false;
+    double      threshold     = 2.0;
+    int         frames        = 2;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool has_val = i + 1 < argc;
+        if      (strcmp(a, "--baseline") == 0 && has_val)  baseline_path = argv[++i];
+        else if (strcmp(a, "--backend") == 0 && has_val)   backend_name  = argv[++i];
+        else if (strcmp(a, "--filter") == 0 && has_val)    filter        = argv[++i];
+        else if (strcmp(a, "--threshold") == 0 && has_val) threshold     = atof(argv[++i]);
+        else if (strcmp(a, "--frames") == 0 && has_val)    frames        = atoi(argv[++i]);
+        else if (strcmp(a, "--update") == 0)               update        = true;
+        else { usage(); return 2; }
+    }
+    if (frames < 1) frames = 1;
+
+    icount_backend_t backend = icount_backend_from_name(backend_name);
+    if (backend == ICOUNT_NONE || !icount_available(backend)) {
+        printf("SKIP: no instruction counter available (backend '%s')\n", backend_name);
+        return ICOUNT_EXIT_SKIP;
+    }
+
+    baseline_t base;
+    bool have_base = baseline_load(baseline_path, &base);
+    if (!update) {
+        if (!have_base) {
+            fprintf(stderr, "cannot read baseline %s (run with --update to create it)\n",
+                    baseline_path);
+            return 2;
+        }
+        if (base.config != CAMTEST_ICOUNT_CONFIG) {
+            printf("SKIP: baseline recorded with '%s', this build is '%s'\n",
+                   base.config.c_str(), CAMTEST_ICOUNT_CONFIG);
+            return ICOUNT_EXIT_SKIP;
+        }
+    }
+
+    printf("backend %s, config %s, threshold %.1f%%\n",
+           icount_backend_name(backend), CAMTEST_ICOUNT_CONFIG, threshold);
+    printf("%-12s %-7s %-8s %7s %14s %14s %8s\n",
+           "scene", "stage", "res", "frames", "instr/frame", "baseline", "delta");
+
+    std::vector<measurement_t> results;
+    int regressions = 0, missing = 0;
+
+    for (int s = 0; s < NUM_SCENES; s++) {
+        const char *scene_name = synth_scene_name(k_scenes[s]);
+        if (filter && !strstr(scene_name, filter)) continue;
+
+        for (int st = 0; st < STAGE_COUNT; st++) {
+            job_t job;
+            job.scene  = k_scenes[s];
+            job.stage  = (stage_t)st;
+            job.width  = GATE_WIDTH;
+            job.height = GATE_HEIGHT;
+            job.frames = st == STAGE_DETECT ? frames : frames * TRACK_FRAME_FACTOR;
+            job.sink   = 0;
+
+            uint64_t total;
+            if (!icount_measure(backend, job_setup, job_region, &job, &total)) {
+                fprintf(stderr, "%s %s: measurement failed\n", scene_name, k_stage_names[st]);
+                return 2;
+            }
+
+            measurement_t m;
+            m.key       = make_key(scene_name, k_stage_names[st], job.width, job.height);
+            m.frames    = job.frames;
+            m.per_frame = total / (uint64_t)job.frames;
+            results.push_back(m);
+
+            char res[16];
+            snprintf(res, sizeof(res), "%dx%d", job.width, job.height);
+            auto it = base.per_frame.find(m.key);
+            if (it == base.per_frame.end()) {
+                printf("%-12s %-7s %-8s %7d %14llu %14s %8s\n", scene_name, k_stage_names[st],
+                       res, job.frames, (unsigned long long)m.per_frame, "-", "new");
+                missing++;
+                continue;
+            }
+
+            double delta = it->second
+                ? 100.0 * ((double)m.per_frame - (double)it->second) / (double)it->second
+                : 0.0;
+            const char *verdict = "";
+            if (delta > threshold) {
+                verdict = "  REGRESSION";
+                regressions++;
+            } else if (delta < -threshold) {
+                verdict = "  improved";
+            }
+            printf("%-12s %-7s %-8s %7d %14llu %14llu %+7.2f%%%s\n", scene_name,
+                   k_stage_names[st], res, job.frames, (unsigned long long)m.per_frame,
+                   (unsigned long long)it->second, delta, verdict);
+        }
+    }
+
+    if (update) {
+        if (filter) {
+            fprintf(stderr, "--update with --filter would drop other entries; refusing\n");
+            return 2;
+        }
+        if (!baseline_save(baseline_path, results, backend)) {
+            fprintf(stderr, "cannot write %s\n", baseline_path);
+            return 2;
+        }
+        printf("baseline written to %s\n", baseline_path);
+        return 0;
+    }
+
+    if (missing) printf("%d entries have no baseline (run with --update)\n", missing);
+    if (regressions) {
+        printf("FAIL: %d stage(s) regressed by more than %.1f%%\n", regressions, threshold);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,360 @@
+#include "scene.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+#include <vector>
+
+#include "config.h"
+
+// ---------------------------------------------------------------------------
+// Deterministic randomness — every value derives from (seed, frame, view)
+// ---------------------------------------------------------------------------
+static uint32_t hash3(uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t h = a * 0x9E3779B1u ^ (b + 0x7F4A7C15u) * 0x85EBCA77u ^ (c + 0x165667B1u) * 0xC2B2AE3Du;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h ? h : 1u;
+}
+
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+// Uniform in [0, 1)
+static float randf(uint32_t *s)
+{
+    return (float)(xorshift32(s) >> 8) * (1.0f / 16777216.0f);
+}
+
+// ---------------------------------------------------------------------------
+// Parameters and scene construction
+// ---------------------------------------------------------------------------
+void scene_default_params(scene_params_t *p)
+{
+    memset(p, 0, sizeof(*p));
+    p->seed          = 1;
+    p->width         = FRAME_WIDTH;
+    p->height        = FRAME_HEIGHT;
+    p->fps           = 25.0f;
+    p->hfov_deg      = STEREO_HFOV_DEG;
+    p->baseline_m    = STEREO_BASELINE_M;
+    p->cam_height_m  = 1.0f;
+    p->ego_speed_mps = 8.0f;
+    p->vehicles      = 2;
+    p->dual_led_prob = 0.25f;
+    p->streetlamps   = 6;
+    p->noise_sigma   = 3.0f;
+    p->exposure      = 1.0f;
+}
+
+void scene_build(scene_t *s, const scene_params_t *params)
+{
+    memset(s, 0, sizeof(*s));
+    s->params = *params;
+
+    float hfov_rad = params->hfov_deg * (float)M_PI / 180.0f;
+    s->focal_px = ((float)params->width * 0.5f) / tanf(hfov_rad * 0.5f);
+    s->z_near = 4.0f;
+    s->z_far  = 120.0f;
+    float range = s->z_far - s->z_near;
+
+    uint32_t rng = hash3(params->seed, 0xB01D, 0);
+
+    // Oncoming vehicles in the opposite lane, each with two headlights
+    for (int v = 0; v < params->vehicles && s->light_count + 2 <= SCENE_MAX_LIGHTS; v++) {
+        float lane_x    = -(2.5f + 2.0f * randf(&rng));
+        float z0        = s->z_near + range * randf(&rng);
+        float vz        = -(5.0f + 15.0f * randf(&rng));
+        float intensity = 3.0f + randf(&rng);
+        for (int side = -1; side <= 1; side += 2) {
+            scene_light_t *l = &s->lights[s->light_count++];
+            l->kind      = SCENE_LIGHT_HEADLIGHT;
+            l->x         = lane_x + 0.75f * (float)side;
+            l->y         = params->cam_height_m - 0.65f;
+            l->z0        = z0;
+            l->vz        = vz;
+            l->radius_m  = 0.09f;
+            l->intensity = intensity;
+            l->die_sep_m = randf(&rng) < params->dual_led_prob ? 0.12f : 0.0f;
+        }
+    }
+
+    // Streetlamps alternating along both road edges, evenly spaced in depth
+    int per_side = (params->streetlamps + 1) / 2;
+    float spacing = per_side > 0 ? range / (float)per_side : range;
+    for (int i = 0; i < params->streetlamps && s->light_count < SCENE_MAX_LIGHTS; i++) {
+        scene_light_t *l = &s->lights[s->light_count++];
+        float side = (i & 1) ? 1.0f : -1.0f;
+        l->kind      = SCENE_LIGHT_STREETLAMP;
+        l->x         = side * (4.5f + 2.0f * randf(&rng));
+        l->y         = params->cam_height_m - 6.0f;
+        l->z0        = s->z_near + spacing * ((float)(i / 2) + 0.3f * randf(&rng));
+        l->vz        = 0.0f;
+        l->radius_m  = 0.25f;
+        l->intensity = 1.5f + 0.5f * randf(&rng);
+        l->die_sep_m = 0.0f;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Geometry
+// ---------------------------------------------------------------------------
+static float light_z(const scene_t *s, const scene_light_t *l, float t)
+{
+    float range = s->z_far - s->z_near;
+    float z = fmodf(l->z0 - s->z_near + (l->vz - s->params.ego_speed_mps) * t, range);
+    if (z < 0.0f) z += range;
+    return s->z_near + z;
+}
+
+static float lean_at(const scene_t *s, float t)
+{
+    const scene_params_t *p = &s->params;
+    if (p->lean_amp_deg == 0.0f || p->lean_period_s <= 0.0f) return p->lean_deg;
+    return p->lean_deg + p->lean_amp_deg * sinf(2.0f * (float)M_PI * t / p->lean_period_s);
+}
+
+// World point -> image coordinates of one camera at rig roll `lean_deg`.
+// Returns false behind the lens.
+static bool project(const scene_t *s, scene_view_t view, float lean_deg,
+                    float x, float y, float z, float *u, float *v)
+{
+    if (z <= 0.1f) return false;
+
+    // Roll the world into the leaning rig frame
+    float th = lean_deg * (float)M_PI / 180.0f;
+    float c = cosf(th), sn = sinf(th);
+    float xr =  x * c + y * sn;
+    float yr = -x * sn + y * c;
+
+    float cam_x = (view == SCENE_VIEW_PRIMARY ? 0.5f : -0.5f) * s->params.baseline_m;
+    *u = s->focal_px * (xr - cam_x) / z + (float)s->params.width  * 0.5f;
+    *v = s->focal_px * yr / z           + (float)s->params.height * 0.5f;
+    return true;
+}
+
+static bool frame_washed_out(const scene_t *s, uint32_t seq)
+{
+    if (s->params.washout_prob <= 0.0f) return false;
+    uint32_t h = hash3(s->params.seed, seq, 0xA5A5);
+    return (float)(h >> 8) * (1.0f / 16777216.0f) < s->params.washout_prob;
+}
+
+// ---------------------------------------------------------------------------
+// Rasterisation
+// ---------------------------------------------------------------------------
+
+// Saturating additive splat of a flat core with an anisotropic Gaussian halo.
+// Rows above y_min are left untouched (used to confine road reflections).
+static void splat(uint8_t *out, int width, int height, float cx, float cy,
+                  float core_r, float sx, float sy, float core_val, float glow_amp,
+                  int y_min)
+{
+    int ex = (int)(core_r + 3.5f * sx) + 1;
+    int ey = (int)(core_r + 3.5f * sy) + 1;
+    int x0 = (int)cx - ex, x1 = (int)cx + ex;
+    int y0 = (int)cy - ey, y1 = (int)cy + ey;
+    if (x0 < 0) x0 = 0;
+    if (y0 < y_min) y0 = y_min;
+    if (x1 > width  - 1) x1 = width  - 1;
+    if (y1 > height - 1) y1 = height - 1;
+    if (x0 > x1 || y0 > y1) return;
+
+    float inv_sx = 1.0f / sx, inv_sy = 1.0f / sy;
+    float r2 = core_r * core_r;
+    for (int y = y0; y <= y1; y++) {
+        float dy = (float)y - cy;
+        uint8_t *row = &out[y * width];
+        for (int x = x0; x <= x1; x++) {
+            float dx = (float)x - cx;
+            float val;
+            if (dx * dx + dy * dy <= r2) {
+                val = core_val;
+            } else {
+                // Distance outside the core, scaled per axis
+                float d  = sqrtf(dx * dx + dy * dy);
+                float k  = (d - core_r) / d;
+                float gx = dx * k * inv_sx, gy = dy * k * inv_sy;
+                val = glow_amp * expf(-0.5f * (gx * gx + gy * gy));
+            }
+            int sum = (int)row[x] + (int)(val + 0.5f);
+            row[x] = (uint8_t)(sum > 255 ? 255 : sum);
+        }
+    }
+}
+
+static void draw_light(const scene_t *s, const scene_light_t *l, float t,
+                       scene_view_t view, uint8_t *out)
+{
+    const scene_params_t *p = &s->params;
+    float z = light_z(s, l, t);
+    float gain = l->intensity * p->exposure;
+    float lean = lean_at(s, t);
+
+    int dies = l->die_sep_m > 0.0f ? 2 : 1;
+    for (int d = 0; d < dies; d++) {
+        float dx = dies == 2 ? (d ? 0.5f : -0.5f) * l->die_sep_m : 0.0f;
+        float u, v;
+        if (!project(s, view, lean, l->x + dx, l->y, z, &u, &v)) continue;
+
+        float r_px = s->focal_px * l->radius_m / z / (float)dies;
+        float core = 255.0f * gain;
+        if (r_px < 0.75f) {
+            // Sub-pixel emitter: same energy spread over the minimum footprint
+            core *= (r_px / 0.75f) * (r_px / 0.75f);
+            r_px  = 0.75f;
+        }
+        float sigma = 1.0f + 1.5f * r_px;
+        splat(out, p->width, p->height, u, v, r_px, sigma, sigma,
+              core > 255.0f ? 255.0f : core, 0.55f * core, 0);
+
+        if (p->wet_road) {
+            // Mirror image in the road surface: dimmer, vertically smeared
+            float ru, rv;
+            if (project(s, view, lean, l->x + dx, 2.0f * p->cam_height_m - l->y, z, &ru, &rv)) {
+                float rc = 0.35f * core;
+                splat(out, p->width, p->height, ru, rv, r_px * 0.5f, sigma, sigma * 4.0f,
+                      rc > 255.0f ? 255.0f : rc, 0.35f * rc, p->height * 3 / 4);
+            }
+        }
+    }
+}
+
+// Frame-index and absolute-time entry points share these; `t` is seconds
+static void truth_impl(const scene_t *s, float t, uint64_t t_us, uint32_t seq,
+                       scene_truth_t *truth)
+{
+    const scene_params_t *p = &s->params;
+    float lean = lean_at(s, t);
+
+    memset(truth, 0, sizeof(*truth));
+    truth->frame        = seq;
+    truth->timestamp_us = t_us;
+    truth->washed_out   = frame_washed_out(s, seq);
+
+    for (int i = 0; i < s->light_count; i++) {
+        const scene_light_t *l = &s->lights[i];
+        scene_truth_obj_t *o = &truth->obj[truth->count];
+        float z = light_z(s, l, t);
+
+        memset(o, 0, sizeof(*o));
+        o->id         = (uint16_t)i;
+        o->cls        = l->kind == SCENE_LIGHT_HEADLIGHT ? 2 : 1;
+        o->distance_m = z;
+        o->radius_px  = s->focal_px * l->radius_m / z;
+
+        bool pv = project(s, SCENE_VIEW_PRIMARY,   lean, l->x, l->y, z, &o->pri_x, &o->pri_y);
+        bool sv = project(s, SCENE_VIEW_SECONDARY, lean, l->x, l->y, z, &o->sec_x, &o->sec_y);
+        if (pv && o->pri_x >= 0.0f && o->pri_x < (float)p->width &&
+            o->pri_y >= 0.0f && o->pri_y < (float)p->height) o->visible |= 1;
+        if (sv && o->sec_x >= 0.0f && o->sec_x < (float)p->width &&
+            o->sec_y >= 0.0f && o->sec_y < (float)p->height) o->visible |= 2;
+        truth->count++;
+    }
+}
+
+static void render_impl(const scene_t *s, float t, uint32_t seq, scene_view_t view,
+                        uint8_t *out)
+{
+    const scene_params_t *p = &s->params;
+    int n = p->width * p->height;
+
+    // Background: sky level plus sensor noise. Each 32-bit draw supplies four
+    // uniform bytes whose sum approximates a Gaussian (sigma ≈ 147.8 counts).
+    bool washed = frame_washed_out(s, seq);
+    float bg = washed ? 240.0f : 10.0f * p->exposure;
+    float k  = p->noise_sigma / 147.8f;
+    uint32_t rng = hash3(p->seed, seq, 0x5EED0000u + (uint32_t)view);
+    for (int i = 0; i < n; i++) {
+        uint32_t r = xorshift32(&rng);
+        int sum = (int)(r & 0xFF) + (int)((r >> 8) & 0xFF) +
+                  (int)((r >> 16) & 0xFF) + (int)(r >> 24) - 510;
+        int v = (int)(bg + (float)sum * k + 0.5f);
+        out[i] = (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+    if (washed) return;
+
+    for (int i = 0; i < s->light_count; i++) {
+        draw_light(s, &s->lights[i], t, view, out);
+    }
+}
+
+void scene_truth(const scene_t *s, uint32_t frame, scene_truth_t *truth)
+{
+    const scene_params_t *p = &s->params;
+    truth_impl(s, (float)frame / p->fps,
+               (uint64_t)((double)frame * 1e6 / (double)p->fps), frame, truth);
+}
+
+void scene_render(const scene_t *s, uint32_t frame, scene_view_t view,
+                  uint8_t *out, scene_truth_t *truth)
+{
+    if (truth) scene_truth(s, frame, truth);
+    render_impl(s, (float)frame / s->params.fps, frame, view, out);
+}
+
+void scene_truth_at(const scene_t *s, uint64_t t_us, uint32_t seq, scene_truth_t *truth)
+{
+    truth_impl(s, (float)((double)t_us * 1e-6), t_us, seq, truth);
+}
+
+void scene_render_at(const scene_t *s, uint64_t t_us, uint32_t seq, scene_view_t view,
+                     uint8_t *out)
+{
+    render_impl(s, (float)((double)t_us * 1e-6), seq, view, out);
+}
+
+// ---------------------------------------------------------------------------
+// Parallel sequence rendering
+// ---------------------------------------------------------------------------
+void scene_render_sequence(const scene_t *s, uint32_t first, uint32_t count,
+                           int threads, bool stereo, scene_frame_cb_t cb, void *user)
+{
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    size_t frame_bytes = (size_t)s->params.width * s->params.height;
+    int views = stereo ? 2 : 1;
+
+    // Each batch renders `batch` frames in parallel, then hands them out in order
+    uint32_t batch = (uint32_t)threads * 2;
+    std::vector<uint8_t>       pixels((size_t)batch * views * frame_bytes);
+    std::vector<scene_truth_t> truths(batch);
+
+    for (uint32_t base = 0; base < count; base += batch) {
+        uint32_t n = count - base < batch ? count - base : batch;
+
+        std::vector<std::thread> pool;
+        for (int tid = 0; tid < threads; tid++) {
+            pool.emplace_back([&, tid]() {
+                for (uint32_t j = (uint32_t)tid; j < n; j += (uint32_t)threads) {
+                    uint8_t *pri = &pixels[(size_t)j * views * frame_bytes];
+                    scene_render(s, first + base + j, SCENE_VIEW_PRIMARY, pri, &truths[j]);
+                    if (stereo) {
+                        scene_render(s, first + base + j, SCENE_VIEW_SECONDARY,
+                                     pri + frame_bytes, NULL);
+                    }
+                }
+            });
+        }
+        for (std::thread &th : pool) th.join();
+
+        for (uint32_t j = 0; j < n; j++) {
+            const uint8_t *pri = &pixels[(size_t)j * views * frame_bytes];
+            cb(first + base + j, pri, stereo ? pri + frame_bytes : NULL, &truths[j], user);
+        }
+    }
+}
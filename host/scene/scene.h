@@ -0,0 +1,135 @@
+#ifndef HOST_SCENE_H
+#define HOST_SCENE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ---------------------------------------------------------------------------
+// Procedural night-scene generator
+//
+// A scene is a set of light emitters in a 3D road frame that is rendered into
+// grayscale frames for either camera of the stereo rig. Every frame is a pure
+// function of (scene, frame number, view), so frames can be rendered in any
+// order and on any thread and still come out bit-identical for a given seed.
+//
+// Coordinates (metres), centred on the midpoint of the stereo baseline:
+//   x  right, y  down, z  forward. The road surface is at y = +cam_height_m.
+// The primary camera sits at x = +baseline/2 (RIGHT), the secondary at
+// x = -baseline/2 (LEFT), matching the sign convention in triangulation.h.
+// ---------------------------------------------------------------------------
+
+#define SCENE_MAX_LIGHTS   64
+#define SCENE_MAX_TRUTH    SCENE_MAX_LIGHTS
+
+typedef enum {
+    SCENE_VIEW_PRIMARY   = 0,
+    SCENE_VIEW_SECONDARY = 1,
+} scene_view_t;
+
+typedef struct {
+    uint32_t seed;
+    int      width;
+    int      height;
+    float    fps;
+    float    hfov_deg;         // Horizontal field of view of both cameras
+    float    baseline_m;       // Lens-to-lens distance
+    float    cam_height_m;     // Lens height above the road
+    float    ego_speed_mps;    // Forward speed of the bike
+    float    lean_deg;         // Rig roll angle (baseline tilt), + = right
+    float    lean_amp_deg;     // Weave: lean oscillates by this much around lean_deg
+    float    lean_period_s;    // ... with this period (ignored when amp is 0)
+    int      vehicles;         // Oncoming vehicles, each with a headlight pair
+    float    dual_led_prob;    // Chance each headlight shows two separate dies
+    int      streetlamps;      // Lamps along both road edges
+    bool     wet_road;         // Mirror every light into the bottom quarter
+    float    noise_sigma;      // Sensor noise standard deviation (DN)
+    float    washout_prob;     // Fraction of frames fully washed out
+    float    exposure;         // Scales every emitter and the sky (1.0 nominal)
+} scene_params_t;
+
+typedef enum {
+    SCENE_LIGHT_HEADLIGHT  = 0,
+    SCENE_LIGHT_STREETLAMP = 1,
+} scene_light_kind_t;
+
+typedef struct {
+    scene_light_kind_t kind;
+    float x, y, z0;            // Position at t = 0
+    float vz;                  // Own forward velocity (negative = approaching)
+    float radius_m;            // Emitter core radius
+    float intensity;           // Core radiance; 1.0 just saturates at exposure 1
+    float die_sep_m;           // > 0: two dies this far apart horizontally
+} scene_light_t;
+
+typedef struct {
+    scene_params_t params;
+    float          focal_px;
+    float          z_near;     // Lights wrap from z_near back to z_far
+    float          z_far;
+    int            light_count;
+    scene_light_t  lights[SCENE_MAX_LIGHTS];
+} scene_t;
+
+// Ground truth for one emitter in one frame. Classes use the blob_class_t
+// values (1 = STATIC_LIGHT, 2 = VEHICLE) so results compare directly.
+typedef struct {
+    uint16_t id;               // Index into scene_t::lights
+    uint8_t  cls;
+    uint8_t  visible;          // Bit 0: in primary view, bit 1: in secondary
+    float    pri_x, pri_y;     // Projected centroid, primary image
+    float    sec_x, sec_y;     // Projected centroid, secondary image
+    float    distance_m;       // Depth along the optical axis
+    float    radius_px;        // Projected core radius (primary)
+} scene_truth_obj_t;
+
+typedef struct {
+    uint32_t          frame;
+    uint64_t          timestamp_us;
+    bool              washed_out;
+    int               count;
+    scene_truth_obj_t obj[SCENE_MAX_TRUTH];
+} scene_truth_t;
+
+/** Defaults: SVGA, 25 fps, 62° HFOV, rig geometry from config.h, light traffic. */
+void scene_default_params(scene_params_t *p);
+
+/** Place lights deterministically from params->seed. */
+void scene_build(scene_t *s, const scene_params_t *params);
+
+/**
+ * Render one view of frame `frame` into `out` (width * height bytes).
+ * `truth` may be NULL; when given it is filled for both views.
+ */
+void scene_render(const scene_t *s, uint32_t frame, scene_view_t view,
+                  uint8_t *out, scene_truth_t *truth);
+
+/** Ground truth only — cheap, no pixels touched. */
+void scene_truth(const scene_t *s, uint32_t frame, scene_truth_t *truth);
+
+/**
+ * Render one view at an arbitrary scene time instead of a frame index, for
+ * cameras that do not share params.fps (see host/sim). `seq` is the
+ * camera's own frame counter; it seeds sensor noise and the washout draw.
+ * scene_render(s, n, ...) is scene_render_at(s, n / fps, n, ...).
+ */
+void scene_render_at(const scene_t *s, uint64_t t_us, uint32_t seq, scene_view_t view,
+                     uint8_t *out);
+
+/** Ground truth at an arbitrary scene time (truth->frame = seq). */
+void scene_truth_at(const scene_t *s, uint64_t t_us, uint32_t seq, scene_truth_t *truth);
+
+/**
+ * Called in frame order by scene_render_sequence(). `sec` is NULL when the
+ * sequence is rendered mono.
+ */
+typedef void (*scene_frame_cb_t)(uint32_t frame, const uint8_t *pri, const uint8_t *sec,
+                                 const scene_truth_t *truth, void *user);
+
+/**
+ * Render frames [first, first + count) on `threads` worker threads
+ * (0 = all cores) and deliver them to `cb` in order.
+ */
+void scene_render_sequence(const scene_t *s, uint32_t first, uint32_t count,
+                           int threads, bool stereo, scene_frame_cb_t cb, void *user);
+
+#endif // HOST_SCENE_H
@@ -0,0 +1,65 @@
+#include "synth.h"
+#include <string.h>
+
+static const char *const k_names[SYNTH_SCENE_COUNT] = {
+    "dark", "headlights", "city", "wet", "washout",
+};
+
+const char *synth_scene_name(synth_scene_t scene)
+{
+    return (unsigned)scene < SYNTH_SCENE_COUNT ? k_names[scene] : "?";
+}
+
+int synth_scene_from_name(const char *name)
+{
+    for (int s = 0; s < SYNTH_SCENE_COUNT; s++) {
+        if (strcmp(name, k_names[s]) == 0) return s;
+    }
+    return -1;
+}
+
+void synth_params(synth_scene_t scene, int width, int height, scene_params_t *p)
+{
+    scene_default_params(p);
+    p->seed   = 1000u + (uint32_t)scene;
+    p->width  = width;
+    p->height = height;
+
+    switch (scene) {
+        case SYNTH_SCENE_DARK:
+            p->vehicles    = 0;
+            p->streetlamps = 0;
+            break;
+        case SYNTH_SCENE_HEADLIGHTS:
+            p->vehicles    = 1;
+            p->streetlamps = 4;
+            break;
+        case SYNTH_SCENE_CITY:
+            p->vehicles      = 6;
+            p->streetlamps   = 24;
+            p->dual_led_prob = 0.5f;
+            p->ego_speed_mps = 6.0f;
+            break;
+        case SYNTH_SCENE_WET:
+            p->vehicles    = 2;
+            p->streetlamps = 6;
+            p->wet_road    = true;
+            break;
+        case SYNTH_SCENE_WASHOUT:
+            p->washout_prob = 1.0f;
+            break;
+        default:
+            break;
+    }
+}
+
+void synth_render(synth_scene_t scene, uint32_t frame, int width, int height,
+                  uint8_t *out)
+{
+    scene_params_t p;
+    synth_params(scene, width, height, &p);
+
+    scene_t s;
+    scene_build(&s, &p);
+    scene_render(&s, frame, SCENE_VIEW_PRIMARY, out, NULL);
+}
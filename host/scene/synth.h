@@ -0,0 +1,38 @@
+#ifndef HOST_SYNTH_H
+#define HOST_SYNTH_H
+
+#include <stdint.h>
+#include "scene.h"
+
+// ---------------------------------------------------------------------------
+// Named scene presets for benchmarks and quick runs. Each preset is a fixed
+// scene_params_t (see scene.h) with its own seed, so it scales to QVGA..UXGA
+// and output is deterministic for a given (preset, frame, size).
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    SYNTH_SCENE_DARK       = 0,   // Sensor noise only — no blobs
+    SYNTH_SCENE_HEADLIGHTS = 1,   // Rural road: one oncoming car + streetlamps
+    SYNTH_SCENE_CITY       = 2,   // Dense traffic and lamps, many dual-LED merges
+    SYNTH_SCENE_WET        = 3,   // Moderate traffic on a wet road (reflections)
+    SYNTH_SCENE_WASHOUT    = 4,   // Every frame fully washed out
+    SYNTH_SCENE_COUNT
+} synth_scene_t;
+
+/** Short name used in benchmark output ("dark", "headlights", ...). */
+const char *synth_scene_name(synth_scene_t scene);
+
+/** Look up a preset by name; returns -1 if unknown. */
+int synth_scene_from_name(const char *name);
+
+/** Scene parameters of a preset at the given frame size. */
+void synth_params(synth_scene_t scene, int width, int height, scene_params_t *p);
+
+/**
+ * Render frame number `frame` of a preset scene (primary view) into `out`
+ * (row-major, 1 byte per pixel, width * height bytes).
+ */
+void synth_render(synth_scene_t scene, uint32_t frame, int width, int height,
+                  uint8_t *out);
+
+#endif // HOST_SYNTH_H
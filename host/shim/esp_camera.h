@@ -0,0 +1,43 @@
+#ifndef HOST_SHIM_ESP_CAMERA_H
+#define HOST_SHIM_ESP_CAMERA_H
+
+// ---------------------------------------------------------------------------
+// Host shim for esp_camera.h — only the frame-buffer types the capture API
+// exposes. Field names and types match esp32-camera v2.0.x so code written
+// against camera_fb_t builds unchanged on the host.
+// ---------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_YUV420,
+    PIXFORMAT_GRAYSCALE,
+    PIXFORMAT_JPEG,
+    PIXFORMAT_RGB888,
+    PIXFORMAT_RAW,
+    PIXFORMAT_RGB444,
+    PIXFORMAT_RGB555,
+} pixformat_t;
+
+typedef struct {
+    uint8_t       *buf;
+    size_t         len;
+    size_t         width;
+    size_t         height;
+    pixformat_t    format;
+    struct timeval timestamp;
+} camera_fb_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ESP_CAMERA_H
@@ -0,0 +1,3 @@
+#include "esp_timer.h"
+
+host_timer_source_t host_timer_source = NULL;
@@ -0,0 +1,32 @@
+#ifndef HOST_SHIM_ESP_TIMER_H
+#define HOST_SHIM_ESP_TIMER_H
+
+// Host shim for esp_timer.h — microseconds since process start, unless a
+// simulation installs its own clock (see host/sim/camsim.cpp)
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int64_t (*host_timer_source_t)(void);
+
+/** NULL = CLOCK_MONOTONIC. Defined in esp_timer.cpp. */
+extern host_timer_source_t host_timer_source;
+
+static inline int64_t esp_timer_get_time(void)
+{
+    if (host_timer_source) return host_timer_source();
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ESP_TIMER_H
@@ -0,0 +1,797 @@
+// ---------------------------------------------------------------------------
+// camsim — two-camera system simulation on a simulated clock
+//
+// Runs the primary and secondary detection_task loops (pipeline_process_frame,
+// uart_link encode / parse, pipeline_stereo_match) against one procedural
+// scene rendered from both rig viewpoints, joined by a simulated UART. Time
+// is discrete-event: each camera captures on its own sensor frame grid
+// (own fps, clock drift and phase), spends a modelled readout + processing
+// time per frame, and only then sees or sends data. Nothing waits on the
+// wall clock, so hours of riding run in minutes.
+//
+// Reports, against scene ground truth:
+//   - distance accuracy of every reported stereo match
+//   - pairing errors (primary and secondary blob are different lights)
+//   - age of the secondary data the primary used, and pipeline latency
+//   - link statistics (packets lost, superseded, corrupted)
+//   - with a sensor model: exposure, blob size and clipped cores per node
+//
+//   camsim [--scene NAME] [--duration S] [--seed N] [--threads N]
+//          [--pri-fps F] [--sec-fps F] [--pri-proc-ms MS] [--sec-proc-ms MS]
+//          [--jitter-ms MS] [--drift-ppm PPM] [--phase-ms MS]
+//          [--baud B] [--rx-fifo BYTES] [--byte-errors P]
+//          [--lean DEG] [--lean-amp DEG] [--lean-period S]
+//          [--sensor off|auto|ctrl] [--auto-exposure F]
+//          [--csv FILE] [--quiet]
+//
+// --sensor renders each frame at capture time through sim_sensor.h: "auto"
+// leaves both sensors on their own AEC/AGC (--auto-exposure, default 2x the
+// scene's nominal exposure), "ctrl" lets exposure_ctrl.h drive them (even
+// with EXPOSURE_CTRL 0). The default "off" renders ahead at the scene
+// exposure, in parallel.
+//
+// Frames are rendered at FRAME_WIDTH x FRAME_HEIGHT because triangulation
+// derives its focal length from those constants.
+// ---------------------------------------------------------------------------
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "camera.h"
+#include "esp_timer.h"
+#include "pipeline.h"
+#include "uart_link.h"
+
+#include "host_time.h"
+#include "scene.h"
+#include "sim_sensor.h"
+#include "sim_uart.h"
+#include "synth.h"
+
+#define NODE_PRI  0
+#define NODE_SEC  1
+
+// Packets remembered for attributing received bytes back to a secondary
+// frame; far more than can be in flight at any sane baud rate
+#define PACKET_LOG_SIZE  256
+
+// Sensor model: the controller's first setting is the scene's nominal exposure
+#define SIM_UNIT_LINES   EXPOSURE_AEC_START
+
+typedef enum {
+    SIM_SENSOR_OFF  = 0,   // Pre-rendered at the scene exposure
+    SIM_SENSOR_AUTO = 1,   // Sensor model, sensor AEC/AGC only
+    SIM_SENSOR_CTRL = 2,   // Sensor model driven by exposure_ctrl.h
+} sim_sensor_mode_t;
+
+// ---------------------------------------------------------------------------
+// Configuration
+// ---------------------------------------------------------------------------
+typedef struct {
+    synth_scene_t scene;
+    double        duration_s;
+    uint32_t      seed;
+    int           threads;
+    float         fps[2];          // Sensor frame rate per node
+    float         proc_ms[2];      // Mean detect + classify time per node
+    float         jitter_ms;       // Uniform +/- on processing time
+    float         drift_ppm;       // Secondary clock rate error vs primary
+    float         phase_ms;        // Secondary sensor grid offset
+    uint32_t      baud;
+    int           rx_fifo;
+    float         byte_errors;
+    float         lean_deg;
+    float         lean_amp_deg;
+    float         lean_period_s;
+    sim_sensor_mode_t sensor;
+    float         auto_exposure;
+    const char   *csv_path;
+    bool          quiet;
+} sim_config_t;
+
+static void config_defaults(sim_config_t *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->scene         = SYNTH_SCENE_HEADLIGHTS;
+    c->duration_s    = 600.0;
+    c->seed          = 0;          // 0: keep the preset's seed
+    c->threads       = 0;
+    c->fps[NODE_PRI] = 25.0f;
+    c->fps[NODE_SEC] = 25.0f;
+    c->proc_ms[NODE_PRI] = 45.0f;
+    c->proc_ms[NODE_SEC] = 40.0f;
+    c->jitter_ms     = 5.0f;
+    c->drift_ppm     = 50.0f;
+    c->phase_ms      = 13.0f;
+    c->baud          = UART_BAUD;
+    c->rx_fifo       = 256;        // HardwareSerial default RX buffer
+    c->byte_errors   = 0.0f;
+    c->lean_period_s = 6.0f;
+    c->sensor        = SIM_SENSOR_OFF;
+    c->auto_exposure = 2.0f;
+}
+
+// ---------------------------------------------------------------------------
+// Camera node: one detection_task instance with its own clock and schedule
+// ---------------------------------------------------------------------------
+typedef struct {
+    scene_view_t view;
+    double       period_us;       // Sensor frame period on the global clock
+    double       phase_us;
+    double       clock_rate;      // Local clock ticks per global microsecond
+    double       proc_us;
+    double       jitter_us;
+    uint32_t     rng;
+    uint64_t     ready_us;        // Task free to capture again (global)
+    uint32_t     last_seq;        // Sensor index of the last processed frame
+    bool         have_seq;
+    pipeline_t   pipe;
+    sim_sensor_t sensor;
+} sim_node_t;
+
+// One processed frame: capture at cap_us, result available at done_us
+typedef struct {
+    int      node;
+    uint32_t seq;                 // Sensor frame index on the node's grid
+    uint64_t cap_us;
+    uint64_t done_us;
+    uint8_t *pixels;
+} sim_event_t;
+
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+static void node_init(sim_node_t *n, scene_view_t view, float fps, float drift_ppm,
+                      float phase_ms, float proc_ms, float jitter_ms, uint32_t seed)
+{
+    memset(n, 0, sizeof(*n));
+    n->view       = view;
+    n->clock_rate = 1.0 + (double)drift_ppm * 1e-6;
+    n->period_us  = 1e6 / (double)fps / n->clock_rate;
+    n->phase_us   = (double)phase_ms * 1000.0;
+    n->proc_us    = (double)proc_ms * 1000.0;
+    n->jitter_us  = (double)jitter_ms * 1000.0;
+    n->rng        = seed ? seed : 1;
+}
+
+// The task asks for a frame when it becomes free and gets the next one the
+// sensor starts after that; readout takes one frame period, then processing.
+// The schedule never depends on detection output, so it can be planned (and
+// rendered) ahead of processing.
+static sim_event_t node_next_event(sim_node_t *n, int node)
+{
+    double k = ceil(((double)n->ready_us - n->phase_us) / n->period_us);
+    if (k < 0.0) k = 0.0;
+    double cap  = n->phase_us + k * n->period_us;
+    double u    = (double)(xorshift32(&n->rng) >> 8) * (1.0 / 16777216.0);
+    double proc = n->proc_us + n->jitter_us * (2.0 * u - 1.0);
+    if (proc < 0.0) proc = 0.0;
+
+    sim_event_t e;
+    e.node    = node;
+    e.seq     = (uint32_t)k;
+    e.cap_us  = (uint64_t)cap;
+    e.done_us = (uint64_t)(cap + n->period_us + proc);
+    e.pixels  = NULL;
+    n->ready_us = e.done_us;
+    return e;
+}
+
+// ---------------------------------------------------------------------------
+// Simulated clock and capture backend seen by the firmware modules
+// ---------------------------------------------------------------------------
+static int64_t      s_local_now_us;
+static camera_fb_t  s_fb;
+static sim_event_t *s_cur_event;
+static sim_node_t  *s_cur_node;
+static const scene_t *s_scene;        // Set when frames go through the sensor model
+static scene_t      s_render_scene;   // s_scene at the current frame's exposure
+
+static int64_t sim_clock(void)
+{
+    return s_local_now_us;
+}
+
+static esp_err_t sim_cam_init(void *) { return ESP_OK; }
+
+// Sensor model: the frame is exposed with the settings latched at its start
+static void sim_cam_expose(void)
+{
+    float noise_gain;
+    s_render_scene = *s_scene;
+    s_render_scene.params.exposure    *= sim_sensor_frame(&s_cur_node->sensor,
+                                                          s_cur_event->cap_us, &noise_gain);
+    s_render_scene.params.noise_sigma *= noise_gain;
+    scene_render_at(&s_render_scene, s_cur_event->cap_us, s_cur_event->seq,
+                    s_cur_node->view, s_cur_event->pixels);
+}
+
+static camera_fb_t *sim_cam_capture(void *)
+{
+    if (s_scene) sim_cam_expose();
+    uint64_t local = (uint64_t)((double)s_cur_event->cap_us * s_cur_node->clock_rate);
+    s_fb.buf    = s_cur_event->pixels;
+    s_fb.len    = (size_t)FRAME_WIDTH * FRAME_HEIGHT;
+    s_fb.width  = FRAME_WIDTH;
+    s_fb.height = FRAME_HEIGHT;
+    s_fb.format = PIXFORMAT_GRAYSCALE;
+    s_fb.timestamp.tv_sec  = (time_t)(local / 1000000u);
+    s_fb.timestamp.tv_usec = (suseconds_t)(local % 1000000u);
+    return &s_fb;
+}
+
+// Detection ends when the frame is released: the clock jumps from the end
+// of readout to the result time, so the pipeline's stage timing and load
+// shedding see the simulated processing time (which does not shrink with
+// the shed level — the report shows when shedding would have kicked in)
+static void sim_cam_release(void *, camera_fb_t *)
+{
+    s_local_now_us = (int64_t)((double)s_cur_event->done_us * s_cur_node->clock_rate);
+}
+
+// Written after detection, so the register write happens at the result time
+static esp_err_t sim_cam_set_exposure(void *, const camera_exposure_t *e)
+{
+    sim_sensor_write(&s_cur_node->sensor, s_cur_event->done_us, e);
+    return ESP_OK;
+}
+
+// set_exposure is hooked up by --sensor ctrl
+static camera_backend_t s_sim_backend = {
+    "sim", sim_cam_init, sim_cam_capture, sim_cam_release, NULL, NULL, NULL
+};
+
+// ---------------------------------------------------------------------------
+// Statistics
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint64_t pri_frames;
+    uint64_t sec_frames;
+    uint64_t no_sec_data;         // Primary frames with no secondary blobs
+    uint64_t opportunities;       // Vehicle light visible to both, in range
+    uint64_t opp_reported;        // ... and a distance was reported
+    uint64_t reports;             // Valid distances reported
+    uint64_t reports_untracked;   // Primary blob matches no ground-truth light
+    uint64_t mispaired;           // Secondary blob is a different light
+    uint64_t packets_sent;
+    uint64_t packets_parsed;
+    uint64_t packets_superseded;  // Parsed but replaced in the same drain
+    uint64_t packets_corrupt;
+    uint64_t dropped_true[2];     // Sensor frames skipped, from the schedule
+    uint64_t dropped_est[2];      // ... as estimated from fb->timestamp
+    uint64_t blob_frames[2];      // Frames with at least one blob
+    uint64_t blob_px[2];          // Blob pixels (labelling work), summed
+    uint64_t worst_sat[2];        // Most clipped pixels in one blob, summed
+
+    std::vector<float> err_paired;   // |d - truth| / truth, correct pairs
+    std::vector<float> err_all;      // ... every report with a truth match
+    std::vector<float> sec_age_ms;   // Age of the secondary data at use
+    std::vector<float> e2e_ms;       // Result time - oldest input capture
+} sim_stats_t;
+
+static float percentile(std::vector<float> &v, double p)
+{
+    if (v.empty()) return NAN;
+    size_t i = (size_t)(p * (double)(v.size() - 1) + 0.5);
+    std::nth_element(v.begin(), v.begin() + (long)i, v.end());
+    return v[i];
+}
+
+static double mean_of(const std::vector<float> &v)
+{
+    if (v.empty()) return NAN;
+    double s = 0.0;
+    for (float x : v) s += x;
+    return s / (double)v.size();
+}
+
+static double fraction_below(const std::vector<float> &v, float limit)
+{
+    if (v.empty()) return NAN;
+    size_t n = 0;
+    for (float x : v) n += x <= limit;
+    return (double)n / (double)v.size();
+}
+
+// Nearest ground-truth light to an image point in one view, or -1
+static int truth_lookup(const scene_truth_t *t, int view, float x, float y)
+{
+    int best = -1;
+    float best_d2 = 0.0f;
+    for (int i = 0; i < t->count; i++) {
+        const scene_truth_obj_t *o = &t->obj[i];
+        if (!(o->visible & (1 << view))) continue;
+        float ox = view == NODE_PRI ? o->pri_x : o->sec_x;
+        float oy = view == NODE_PRI ? o->pri_y : o->sec_y;
+        float gate = 2.5f * o->radius_px;
+        if (gate < 8.0f) gate = 8.0f;
+        float d2 = (ox - x) * (ox - x) + (oy - y) * (oy - y);
+        if (d2 > gate * gate) continue;
+        if (best < 0 || d2 < best_d2) {
+            best    = i;
+            best_d2 = d2;
+        }
+    }
+    return best;
+}
+
+// ---------------------------------------------------------------------------
+// Simulation state
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint64_t end_offset;          // Transmit offset one past the last byte
+    uint64_t cap_us;
+    uint32_t seq;
+} packet_meta_t;
+
+typedef struct {
+    sim_config_t  cfg;
+    scene_t       scene;
+    sim_node_t    node[2];
+    sim_uart_t    uart;
+    uart_link_parser_t parser;
+    packet_meta_t packets[PACKET_LOG_SIZE];
+    uint64_t      packet_count;
+
+    // Primary-side view of the link, as in detection_task
+    uart_blob_t   sec_blobs[MAX_BLOBS_TX];
+    int           sec_count;
+    uint64_t      sec_cap_us;
+    uint32_t      sec_seq;
+    bool          sec_valid;
+
+    sim_stats_t   stats;
+    FILE         *csv;
+} sim_t;
+
+static const packet_meta_t *packet_for_offset(const sim_t *sim, uint64_t offset)
+{
+    // Packets are logged in transmit order; search back from the newest
+    uint64_t first = sim->packet_count > PACKET_LOG_SIZE
+                   ? sim->packet_count - PACKET_LOG_SIZE : 0;
+    for (uint64_t i = sim->packet_count; i-- > first;) {
+        const packet_meta_t *m = &sim->packets[i % PACKET_LOG_SIZE];
+        if (offset < m->end_offset &&
+            offset + UART_PACKET_SIZE >= m->end_offset) return m;
+    }
+    return NULL;
+}
+
+static void secondary_frame(sim_t *sim, const sim_event_t *e, const detection_result_t *r)
+{
+    uint8_t pkt[UART_PACKET_SIZE];
+    size_t len = uart_link_encode(r, pkt);
+    sim_uart_write(&sim->uart, e->done_us, pkt, len);
+
+    packet_meta_t *m = &sim->packets[sim->packet_count % PACKET_LOG_SIZE];
+    m->end_offset = sim->uart.tx_offset;
+    m->cap_us     = e->cap_us;
+    m->seq        = e->seq;
+    sim->packet_count++;
+    sim->stats.packets_sent++;
+}
+
+// recv_blobs_uart(): drain everything readable, keep the newest packet
+static void primary_receive(sim_t *sim, uint64_t now_us)
+{
+    sim_stats_t *st = &sim->stats;
+    int parsed = 0;
+    uint8_t byte;
+    uint64_t offset;
+    while (sim_uart_read(&sim->uart, now_us, &byte, &offset)) {
+        uart_link_status_t s = uart_link_parser_feed(&sim->parser, byte,
+                                                     sim->sec_blobs, &sim->sec_count);
+        if (s == UART_LINK_PACKET) {
+            parsed++;
+            st->packets_parsed++;
+            const packet_meta_t *m = packet_for_offset(sim, offset);
+            if (m) {
+                sim->sec_cap_us = m->cap_us;
+                sim->sec_seq    = m->seq;
+                sim->sec_valid  = true;
+            }
+        } else if (s == UART_LINK_CORRUPT) {
+            st->packets_corrupt++;
+            sim->sec_count = 0;
+        }
+    }
+    if (parsed > 1) st->packets_superseded += (uint64_t)(parsed - 1);
+}
+
+static void primary_frame(sim_t *sim, const sim_event_t *e, const detection_result_t *r)
+{
+    sim_stats_t *st = &sim->stats;
+    primary_receive(sim, e->done_us);
+
+    stereo_match_t m = pipeline_stereo_match(r, sim->sec_blobs, sim->sec_count);
+
+    scene_truth_t truth;
+    scene_truth_at(&sim->scene, e->cap_us, e->seq, &truth);
+
+    // Was there a vehicle light the system could have ranged?
+    bool opportunity = false;
+    for (int i = 0; i < truth.count && !truth.washed_out; i++) {
+        const scene_truth_obj_t *o = &truth.obj[i];
+        if (o->cls == BLOB_CLASS_VEHICLE && o->visible == 3 &&
+            o->distance_m >= 0.5f && o->distance_m <= 80.0f) opportunity = true;
+    }
+    st->opportunities += opportunity;
+
+    if (sim->sec_count == 0) st->no_sec_data++;
+
+    float sec_age_ms = -1.0f;
+    if (sim->sec_valid) {
+        sec_age_ms = (float)(e->done_us - sim->sec_cap_us) / 1000.0f;
+        st->sec_age_ms.push_back(sec_age_ms);
+    }
+
+    int pri_id = -1, sec_id = -1;
+    float truth_d = -1.0f;
+    if (m.pri >= 0 && m.distance_m > 0.0f) {
+        st->reports++;
+        st->opp_reported += opportunity;
+
+        uint64_t oldest = e->cap_us;
+        if (sim->sec_valid && sim->sec_cap_us < oldest) oldest = sim->sec_cap_us;
+        st->e2e_ms.push_back((float)(e->done_us - oldest) / 1000.0f);
+
+        const blob_t *pb = &r->blobs[m.pri];
+        int pi = truth_lookup(&truth, NODE_PRI, (float)pb->cx, (float)pb->cy);
+
+        // The secondary blob was seen at the secondary's capture time
+        scene_truth_t sec_truth;
+        scene_truth_at(&sim->scene, sim->sec_cap_us, sim->sec_seq, &sec_truth);
+        int si = truth_lookup(&sec_truth, NODE_SEC, (float)sim->sec_blobs[m.sec].cx,
+                              (float)sim->sec_blobs[m.sec].cy);
+
+        if (pi < 0) {
+            st->reports_untracked++;
+        } else {
+            pri_id  = truth.obj[pi].id;
+            sec_id  = si >= 0 ? sec_truth.obj[si].id : -1;
+            truth_d = truth.obj[pi].distance_m;
+            float err = fabsf(m.distance_m - truth_d) / truth_d;
+            st->err_all.push_back(err);
+            if (sec_id == pri_id) {
+                st->err_paired.push_back(err);
+            } else {
+                st->mispaired++;
+            }
+        }
+    }
+
+    if (sim->csv) {
+        fprintf(sim->csv, "%llu,%u,%d,%d,%.1f,%d,%d,%.3f,%d,%d,%.3f\n",
+                (unsigned long long)e->cap_us, e->seq, r->blob_count, sim->sec_count,
+                sec_age_ms, m.pri, m.sec, m.distance_m, pri_id, sec_id, truth_d);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Event loop — plan a batch of events, render it in parallel, process in order
+// ---------------------------------------------------------------------------
+static void render_batch(const scene_t *scene, std::vector<sim_event_t> &batch, int threads)
+{
+    int n = (int)batch.size();
+    auto work = [&](int w) {
+        for (int i = w; i < n; i += threads) {
+            const sim_event_t &e = batch[i];
+            scene_render_at(scene, e.cap_us, e.seq,
+                            e.node == NODE_PRI ? SCENE_VIEW_PRIMARY : SCENE_VIEW_SECONDARY,
+                            e.pixels);
+        }
+    };
+    if (threads <= 1) {
+        work(0);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int w = 0; w < threads; w++) pool.emplace_back(work, w);
+    for (std::thread &t : pool) t.join();
+}
+
+static void process_event(sim_t *sim, sim_event_t *e)
+{
+    sim_node_t *n = &sim->node[e->node];
+    s_cur_event    = e;
+    s_cur_node     = n;
+    s_local_now_us = (int64_t)(((double)e->cap_us + n->period_us) * n->clock_rate);  // Readout done
+
+    detection_result_t r;
+    if (!pipeline_process_frame(&n->pipe, &r)) return;
+
+    if (n->have_seq) sim->stats.dropped_true[e->node] += e->seq - n->last_seq - 1;
+    sim->stats.dropped_est[e->node] += n->pipe.last_frame.dropped;
+    n->last_seq = e->seq;
+    n->have_seq = true;
+
+    if (r.blob_count > 0) {
+        uint32_t worst = 0;
+        for (int i = 0; i < r.blob_count; i++) {
+            sim->stats.blob_px[e->node] += r.blobs[i].pixel_count;
+            if (r.blobs[i].saturated > worst) worst = r.blobs[i].saturated;
+        }
+        sim->stats.worst_sat[e->node] += worst;
+        sim->stats.blob_frames[e->node]++;
+    }
+
+    if (e->node == NODE_SEC) {
+        sim->stats.sec_frames++;
+        secondary_frame(sim, e, &r);
+    } else {
+        sim->stats.pri_frames++;
+        primary_frame(sim, e, &r);
+    }
+}
+
+static void run(sim_t *sim)
+{
+    const sim_config_t *c = &sim->cfg;
+    int threads = c->threads > 0 ? c->threads : (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    int batch_size = threads * 4;
+
+    size_t frame_bytes = (size_t)FRAME_WIDTH * FRAME_HEIGHT;
+    std::vector<uint8_t> pixels((size_t)batch_size * frame_bytes);
+    std::vector<sim_event_t> batch;
+
+    sim_event_t next[2] = { node_next_event(&sim->node[NODE_PRI], NODE_PRI),
+                            node_next_event(&sim->node[NODE_SEC], NODE_SEC) };
+    uint64_t end_us = (uint64_t)(c->duration_s * 1e6);
+    uint64_t next_progress_us = 60000000ull;
+    uint64_t wall0 = host_now_ns();
+
+    for (;;) {
+        batch.clear();
+        while ((int)batch.size() < batch_size) {
+            int k = next[NODE_PRI].done_us <= next[NODE_SEC].done_us ? NODE_PRI : NODE_SEC;
+            if (next[k].done_us > end_us) break;
+            sim_event_t e = next[k];
+            e.pixels = &pixels[batch.size() * frame_bytes];
+            batch.push_back(e);
+            next[k] = node_next_event(&sim->node[k], k);
+        }
+        if (batch.empty()) break;
+
+        if (c->sensor == SIM_SENSOR_OFF) render_batch(&sim->scene, batch, threads);
+        for (sim_event_t &e : batch) process_event(sim, &e);
+
+        uint64_t t = batch.back().done_us;
+        if (!c->quiet && t >= next_progress_us) {
+            double wall = (double)(host_now_ns() - wall0) * 1e-9;
+            fprintf(stderr, "  %6.0f s simulated, %6.1f s wall (%.1fx real time)\n",
+                    (double)t * 1e-6, wall, (double)t * 1e-6 / wall);
+            next_progress_us += 60000000ull;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Report
+// ---------------------------------------------------------------------------
+static void report(sim_t *sim, double wall_s)
+{
+    sim_stats_t *st = &sim->stats;
+    const sim_config_t *c = &sim->cfg;
+
+    printf("scene %s, %.0f s simulated in %.1f s wall (%.1fx real time)\n",
+           synth_scene_name(c->scene), c->duration_s, wall_s, c->duration_s / wall_s);
+    printf("frames: primary %llu (%.2f fps), secondary %llu (%.2f fps)\n",
+           (unsigned long long)st->pri_frames, (double)st->pri_frames / c->duration_s,
+           (unsigned long long)st->sec_frames, (double)st->sec_frames / c->duration_s);
+    printf("sensor frames dropped: primary %llu (estimated %llu), secondary %llu (estimated %llu)\n",
+           (unsigned long long)st->dropped_true[NODE_PRI],
+           (unsigned long long)st->dropped_est[NODE_PRI],
+           (unsigned long long)st->dropped_true[NODE_SEC],
+           (unsigned long long)st->dropped_est[NODE_SEC]);
+    for (int k = 0; k < 2; k++) {
+        const load_shed_t *ls = &sim->node[k].pipe.shed;
+        printf("load shedding, %s: %lu deadline misses, %lu steps down, frames at",
+               k == NODE_PRI ? "primary" : "secondary",
+               (unsigned long)ls->misses, (unsigned long)ls->steps_down);
+        for (int l = 0; l < LOAD_SHED_LEVELS; l++) {
+            printf(" %s %lu", load_shed_level_str((load_shed_level_t)l),
+                   (unsigned long)ls->frames_at[l]);
+        }
+        printf("\n");
+    }
+    for (int k = 0; k < 2 && c->sensor != SIM_SENSOR_OFF; k++) {
+        const sim_sensor_t    *ss = &sim->node[k].sensor;
+        const exposure_ctrl_t *x  = &sim->node[k].pipe.exposure;
+        uint64_t frames = k == NODE_PRI ? st->pri_frames : st->sec_frames;
+        printf("exposure, %s: mean %.2f (%.2f-%.2f) x nominal, %llu writes (%lu down, %lu up); "
+               "blob px/frame %.0f, most clipped blob %.0f px\n",
+               k == NODE_PRI ? "primary" : "secondary",
+               ss->frames ? ss->exposure_sum / (double)ss->frames : 0.0,
+               (double)ss->exposure_min, (double)ss->exposure_max,
+               (unsigned long long)ss->writes, (unsigned long)x->steps_down,
+               (unsigned long)x->steps_up,
+               frames ? (double)st->blob_px[k] / (double)frames : 0.0,
+               st->blob_frames[k] ? (double)st->worst_sat[k] / (double)st->blob_frames[k] : 0.0);
+    }
+
+    printf("\nlink: %llu packets sent, %llu parsed, %llu superseded, %llu corrupt\n",
+           (unsigned long long)st->packets_sent, (unsigned long long)st->packets_parsed,
+           (unsigned long long)st->packets_superseded, (unsigned long long)st->packets_corrupt);
+    printf("      %llu bytes dropped, %llu bytes corrupted; no secondary data on %llu frames\n",
+           (unsigned long long)sim->uart.bytes_dropped,
+           (unsigned long long)sim->uart.bytes_corrupted,
+           (unsigned long long)st->no_sec_data);
+
+    printf("\ndistance reports: %llu (%llu without a ground-truth light, %llu mispaired)\n",
+           (unsigned long long)st->reports, (unsigned long long)st->reports_untracked,
+           (unsigned long long)st->mispaired);
+    if (st->opportunities) {
+        printf("vehicle coverage: %.1f%% of %llu frames with a rangeable vehicle light\n",
+               100.0 * (double)st->opp_reported / (double)st->opportunities,
+               (unsigned long long)st->opportunities);
+    }
+
+    printf("\n%-28s %8s %8s %8s %8s\n", "", "median", "p95", "<=5%", "<=10%");
+    std::vector<float> *errs[2] = { &st->err_paired, &st->err_all };
+    const char *names[2] = { "rel. error (correct pairs)", "rel. error (all)" };
+    for (int i = 0; i < 2; i++) {
+        std::vector<float> &v = *errs[i];
+        double f5 = fraction_below(v, 0.05f), f10 = fraction_below(v, 0.10f);
+        printf("%-28s %7.1f%% %7.1f%% %7.1f%% %7.1f%%\n", names[i],
+               100.0 * percentile(v, 0.5), 100.0 * percentile(v, 0.95),
+               100.0 * f5, 100.0 * f10);
+    }
+
+    printf("\n%-28s %8s %8s %8s %8s\n", "", "mean", "median", "p95", "max");
+    std::vector<float> *lat[2] = { &st->sec_age_ms, &st->e2e_ms };
+    const char *lat_names[2] = { "secondary data age (ms)", "report latency (ms)" };
+    for (int i = 0; i < 2; i++) {
+        std::vector<float> &v = *lat[i];
+        double mean = mean_of(v);
+        float  mx   = v.empty() ? NAN : *std::max_element(v.begin(), v.end());
+        printf("%-28s %8.1f %8.1f %8.1f %8.1f\n", lat_names[i],
+               mean, percentile(v, 0.5), percentile(v, 0.95), mx);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Main
+// ---------------------------------------------------------------------------
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: camsim [--scene NAME] [--duration S] [--seed N] [--threads N]\n"
+            "              [--pri-fps F] [--sec-fps F] [--pri-proc-ms MS] [--sec-proc-ms MS]\n"
+            "              [--jitter-ms MS] [--drift-ppm PPM] [--phase-ms MS]\n"
+            "              [--baud B] [--rx-fifo BYTES] [--byte-errors P]\n"
+            "              [--lean DEG] [--lean-amp DEG] [--lean-period S]\n"
+            "              [--sensor off|auto|ctrl] [--auto-exposure F]\n"
+            "              [--csv FILE] [--quiet]\n");
+}
+
+int main(int argc, char **argv)
+{
+    static sim_t sim;
+    sim_config_t *c = &sim.cfg;
+    config_defaults(c);
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strcmp(a, "--quiet") == 0) {
+            c->quiet = true;
+            continue;
+        }
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!v) {
+            usage();
+            return 2;
+        }
+        i++;
+        if (strcmp(a, "--scene") == 0) {
+            int s = synth_scene_from_name(v);
+            if (s < 0) {
+                fprintf(stderr, "unknown scene '%s'\n", v);
+                return 2;
+            }
+            c->scene = (synth_scene_t)s;
+        }
+        else if (strcmp(a, "--duration") == 0)    c->duration_s = atof(v);
+        else if (strcmp(a, "--seed") == 0)        c->seed = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--threads") == 0)     c->threads = atoi(v);
+        else if (strcmp(a, "--pri-fps") == 0)     c->fps[NODE_PRI] = (float)atof(v);
+        else if (strcmp(a, "--sec-fps") == 0)     c->fps[NODE_SEC] = (float)atof(v);
+        else if (strcmp(a, "--pri-proc-ms") == 0) c->proc_ms[NODE_PRI] = (float)atof(v);
+        else if (strcmp(a, "--sec-proc-ms") == 0) c->proc_ms[NODE_SEC] = (float)atof(v);
+        else if (strcmp(a, "--jitter-ms") == 0)   c->jitter_ms = (float)atof(v);
+        else if (strcmp(a, "--drift-ppm") == 0)   c->drift_ppm = (float)atof(v);
+        else if (strcmp(a, "--phase-ms") == 0)    c->phase_ms = (float)atof(v);
+        else if (strcmp(a, "--baud") == 0)        c->baud = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--rx-fifo") == 0)     c->rx_fifo = atoi(v);
+        else if (strcmp(a, "--byte-errors") == 0) c->byte_errors = (float)atof(v);
+        else if (strcmp(a, "--lean") == 0)        c->lean_deg = (float)atof(v);
+        else if (strcmp(a, "--lean-amp") == 0)    c->lean_amp_deg = (float)atof(v);
+        else if (strcmp(a, "--lean-period") == 0) c->lean_period_s = (float)atof(v);
+        else if (strcmp(a, "--sensor") == 0) {
+            if      (strcmp(v, "off") == 0)  c->sensor = SIM_SENSOR_OFF;
+            else if (strcmp(v, "auto") == 0) c->sensor = SIM_SENSOR_AUTO;
+            else if (strcmp(v, "ctrl") == 0) c->sensor = SIM_SENSOR_CTRL;
+            else {
+                usage();
+                return 2;
+            }
+        }
+        else if (strcmp(a, "--auto-exposure") == 0) c->auto_exposure = (float)atof(v);
+        else if (strcmp(a, "--csv") == 0)         c->csv_path = v;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (c->duration_s <= 0.0 || c->fps[NODE_PRI] <= 0.0f || c->fps[NODE_SEC] <= 0.0f ||
+        c->baud == 0 || c->rx_fifo <= 0 || c->auto_exposure <= 0.0f) {
+        usage();
+        return 2;
+    }
+
+    scene_params_t p;
+    synth_params(c->scene, FRAME_WIDTH, FRAME_HEIGHT, &p);
+    if (c->seed) p.seed = c->seed;
+    p.lean_deg      = c->lean_deg;
+    p.lean_amp_deg  = c->lean_amp_deg;
+    p.lean_period_s = c->lean_period_s;
+    scene_build(&sim.scene, &p);
+
+    node_init(&sim.node[NODE_PRI], SCENE_VIEW_PRIMARY, c->fps[NODE_PRI], 0.0f, 0.0f,
+              c->proc_ms[NODE_PRI], c->jitter_ms, p.seed * 2654435761u);
+    node_init(&sim.node[NODE_SEC], SCENE_VIEW_SECONDARY, c->fps[NODE_SEC], c->drift_ppm,
+              c->phase_ms, c->proc_ms[NODE_SEC], c->jitter_ms, p.seed * 2246822519u + 1);
+    sim_uart_init(&sim.uart, c->baud, c->rx_fifo, c->byte_errors, p.seed ^ 0x0A5A5A5Au);
+    uart_link_parser_reset(&sim.parser);
+
+    if (c->csv_path) {
+        sim.csv = fopen(c->csv_path, "w");
+        if (!sim.csv) {
+            fprintf(stderr, "cannot create %s\n", c->csv_path);
+            return 1;
+        }
+        fprintf(sim.csv, "cap_us,seq,blobs,sec_count,sec_age_ms,match_pri,match_sec,"
+                         "distance_m,truth_id,sec_truth_id,truth_distance_m\n");
+    }
+
+    // Sensors latch a register write at the next frame start
+    if (c->sensor != SIM_SENSOR_OFF) {
+        s_scene = &sim.scene;
+        for (int k = 0; k < 2; k++) {
+            sim_sensor_init(&sim.node[k].sensor, c->auto_exposure, SIM_UNIT_LINES,
+                            (uint64_t)sim.node[k].period_us);
+        }
+        if (c->sensor == SIM_SENSOR_CTRL) s_sim_backend.set_exposure = sim_cam_set_exposure;
+    }
+
+    // Firmware modules read this clock and capture from this backend
+    host_timer_source = sim_clock;
+    camera_set_backend(&s_sim_backend);
+    camera_init();
+    pipeline_init(&sim.node[NODE_PRI].pipe);
+    pipeline_init(&sim.node[NODE_SEC].pipe);
+    for (int k = 0; k < 2; k++) {   // Nominal period = the simulated sensor's
+        camera_frame_clock_reset(&sim.node[k].pipe.frame_clock, (uint32_t)(1e6 / c->fps[k]));
+        // The loop is opt-in on the device (EXPOSURE_CTRL); ctrl runs it regardless
+        if (c->sensor == SIM_SENSOR_CTRL) sim.node[k].pipe.exposure.enabled = true;
+    }
+
+    uint64_t wall0 = host_now_ns();
+    run(&sim);
+    double wall_s = (double)(host_now_ns() - wall0) * 1e-9;
+
+    if (sim.csv) fclose(sim.csv);
+    report(&sim, wall_s);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#include "sim_sensor.h"
+#include <string.h>
+
+void sim_sensor_init(sim_sensor_t *s, float auto_exposure, float unit_lines,
+                     uint64_t latch_us)
+{
+    memset(s, 0, sizeof(*s));
+    s->auto_exposure = auto_exposure;
+    s->unit_lines    = unit_lines;
+    s->latch_us      = latch_us;
+}
+
+void sim_sensor_write(sim_sensor_t *s, uint64_t now_us, const camera_exposure_t *e)
+{
+    s->pending     = *e;
+    s->pending_us  = now_us + s->latch_us;
+    s->has_pending = true;
+    s->writes++;
+}
+
+float sim_sensor_frame(sim_sensor_t *s, uint64_t cap_us, float *noise_gain)
+{
+    if (s->has_pending && cap_us >= s->pending_us) {
+        s->active      = s->pending;
+        s->has_pending = false;
+    }
+
+    float exposure = s->auto_exposure;
+    *noise_gain = 1.0f;
+    if (s->active.manual) {
+        float gain = 1.0f + (float)s->active.gain;
+        exposure    = (float)s->active.aec_lines * gain / s->unit_lines;
+        *noise_gain = gain;
+    }
+
+    if (s->frames == 0 || exposure < s->exposure_min) s->exposure_min = exposure;
+    if (s->frames == 0 || exposure > s->exposure_max) s->exposure_max = exposure;
+    s->exposure_sum += exposure;
+    s->frames++;
+    return exposure;
+}
@@ -0,0 +1,53 @@
+#ifndef HOST_SIM_SENSOR_H
+#define HOST_SIM_SENSOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "camera.h"
+
+// ---------------------------------------------------------------------------
+// Simulated sensor exposure — what camera_set_exposure() does to the image.
+//
+// Exposure time x analog gain (1 + gain index) scales every emitter and the
+// sky (scene_params_t.exposure); unit_lines of it give the scene's nominal
+// exposure 1.0. Gain amplifies sensor noise with the signal. Like the
+// OV2640, the sensor latches a register write at a frame start: a frame
+// that starts less than latch_us after the write still uses the old
+// settings, and a second write before then replaces the first.
+//
+// Until the first manual write, and after a write with manual = 0, the
+// sensor runs its own AEC/AGC, modelled as a fixed auto_exposure: at night
+// the average-brightness loop sits at its ceiling.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    float    auto_exposure;     // Scene exposure under the sensor's AEC/AGC
+    float    unit_lines;        // aec_lines x (1 + gain) for scene exposure 1.0
+    uint64_t latch_us;          // Write -> first frame start using it
+
+    camera_exposure_t active;
+    camera_exposure_t pending;
+    uint64_t pending_us;        // Frames starting at or after this use `pending`
+    bool     has_pending;
+
+    // Statistics
+    uint64_t writes;
+    uint64_t frames;
+    double   exposure_sum;      // Scene exposure, summed over frames
+    float    exposure_min;
+    float    exposure_max;
+} sim_sensor_t;
+
+void sim_sensor_init(sim_sensor_t *s, float auto_exposure, float unit_lines,
+                     uint64_t latch_us);
+
+/** Register write at `now_us` (global simulated time). */
+void sim_sensor_write(sim_sensor_t *s, uint64_t now_us, const camera_exposure_t *e);
+
+/**
+ * Scene exposure for the frame that starts at `cap_us`; `noise_gain`
+ * receives the factor on sensor noise. Frames must come in start order.
+ */
+float sim_sensor_frame(sim_sensor_t *s, uint64_t cap_us, float *noise_gain);
+
+#endif // HOST_SIM_SENSOR_H
@@ -0,0 +1,101 @@
+#include "sim_uart.h"
+#include <string.h>
+
+#define BITS_PER_BYTE  10   // 8N1: start + 8 data + stop
+
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+void sim_uart_init(sim_uart_t *u, uint32_t baud, int rx_capacity,
+                   float byte_error_rate, uint32_t seed)
+{
+    memset(u, 0, sizeof(*u));
+    u->baud            = baud;
+    u->rx_capacity     = rx_capacity;
+    u->byte_error_rate = byte_error_rate;
+    u->rng             = seed ? seed : 1;
+}
+
+static sim_uart_byte_t *slot(sim_uart_t *u, int i)
+{
+    return &u->inflight[(u->head + i) % SIM_UART_MAX_INFLIGHT];
+}
+
+void sim_uart_write(sim_uart_t *u, uint64_t now_us, const uint8_t *data, size_t len)
+{
+    uint64_t byte_ns = (uint64_t)BITS_PER_BYTE * 1000000000ull / u->baud;
+    uint64_t t = now_us * 1000ull;
+    if (u->line_free_ns > t) t = u->line_free_ns;
+
+    for (size_t i = 0; i < len; i++) {
+        uint64_t offset = u->tx_offset++;
+        t += byte_ns;
+        u->bytes_sent++;
+
+        if (u->fifo_count + u->wire_count >= SIM_UART_MAX_INFLIGHT) {
+            u->bytes_dropped++;
+            continue;
+        }
+
+        uint8_t b = data[i];
+        if (u->byte_error_rate > 0.0f &&
+            (float)(xorshift32(&u->rng) >> 8) * (1.0f / 16777216.0f) < u->byte_error_rate) {
+            b ^= (uint8_t)(1u << (xorshift32(&u->rng) & 7));
+            u->bytes_corrupted++;
+        }
+
+        sim_uart_byte_t *s = slot(u, u->fifo_count + u->wire_count);
+        s->arrive_ns = t;
+        s->offset    = offset;
+        s->byte      = b;
+        u->wire_count++;
+    }
+    u->line_free_ns = t;
+}
+
+// Move bytes whose stop bit has completed into the FIFO, dropping on overflow
+static void settle(sim_uart_t *u, uint64_t now_us)
+{
+    uint64_t now_ns = now_us * 1000ull;
+    while (u->wire_count > 0) {
+        sim_uart_byte_t *s = slot(u, u->fifo_count);
+        if (s->arrive_ns > now_ns) break;
+        if (u->fifo_count < u->rx_capacity) {
+            u->fifo_count++;
+        } else {
+            // Remove the byte by shifting the remaining wire bytes down one
+            for (int i = u->fifo_count; i < u->fifo_count + u->wire_count - 1; i++) {
+                *slot(u, i) = *slot(u, i + 1);
+            }
+            u->bytes_dropped++;
+        }
+        u->wire_count--;
+    }
+}
+
+int sim_uart_available(sim_uart_t *u, uint64_t now_us)
+{
+    settle(u, now_us);
+    return u->fifo_count;
+}
+
+bool sim_uart_read(sim_uart_t *u, uint64_t now_us, uint8_t *byte, uint64_t *offset)
+{
+    settle(u, now_us);
+    if (u->fifo_count == 0) return false;
+
+    sim_uart_byte_t *s = slot(u, 0);
+    *byte = s->byte;
+    if (offset) *offset = s->offset;
+    u->head = (u->head + 1) % SIM_UART_MAX_INFLIGHT;
+    u->fifo_count--;
+    u->bytes_read++;
+    return true;
+}
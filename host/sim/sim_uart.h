@@ -0,0 +1,62 @@
+#ifndef HOST_SIM_UART_H
+#define HOST_SIM_UART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Simulated point-to-point UART (8N1) on a shared simulated clock.
+//
+// The transmitter serialises bytes back to back at the configured baud
+// rate; each byte lands in the receiver FIFO when its stop bit completes.
+// Bytes arriving at a full FIFO are dropped, as the ESP32 UART driver does
+// when the application falls behind. An optional per-byte error rate flips
+// one random bit. Every byte keeps its transmit offset so the simulation
+// can attribute received packets back to the frame that produced them.
+// ---------------------------------------------------------------------------
+
+#define SIM_UART_MAX_INFLIGHT  4096
+
+typedef struct {
+    uint64_t arrive_ns;
+    uint64_t offset;           // Index in the transmitted byte stream
+    uint8_t  byte;
+} sim_uart_byte_t;
+
+typedef struct {
+    uint32_t baud;
+    int      rx_capacity;      // Receiver FIFO size in bytes
+    float    byte_error_rate;
+    uint32_t rng;
+
+    uint64_t line_free_ns;     // When the transmitter finishes its last byte
+    uint64_t tx_offset;        // Bytes written so far
+
+    sim_uart_byte_t inflight[SIM_UART_MAX_INFLIGHT];   // Ring: on the wire or in the FIFO
+    int             head;
+    int             wire_count;   // Not yet arrived
+    int             fifo_count;   // Arrived, waiting to be read (precede wire bytes)
+
+    // Statistics
+    uint64_t bytes_sent;
+    uint64_t bytes_read;
+    uint64_t bytes_dropped;    // FIFO overflow or transmit backlog overflow
+    uint64_t bytes_corrupted;
+} sim_uart_t;
+
+void sim_uart_init(sim_uart_t *u, uint32_t baud, int rx_capacity,
+                   float byte_error_rate, uint32_t seed);
+
+/** Queue `len` bytes for transmission starting at `now_us`. */
+void sim_uart_write(sim_uart_t *u, uint64_t now_us, const uint8_t *data, size_t len);
+
+/** Bytes readable at `now_us` (the receiver-side available()). */
+int sim_uart_available(sim_uart_t *u, uint64_t now_us);
+
+/**
+ * Pop one byte that has arrived by `now_us`. Returns false when the FIFO is
+ * empty. `offset` (may be NULL) receives the byte's transmit offset.
+ */
+bool sim_uart_read(sim_uart_t *u, uint64_t now_us, uint8_t *byte, uint64_t *offset);
+
+#endif // HOST_SIM_UART_H
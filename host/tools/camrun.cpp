@@ -0,0 +1,161 @@
+// ---------------------------------------------------------------------------
+// camrun — run the firmware detection pipeline on the host
+//
+// Drives pipeline_process_frame() (capture -> detect -> track) from a
+// recorded or synthetic capture backend, either as fast as possible or paced
+// to the source frame rate.
+//
+//   camrun --rec ride.cfr [--loop]            replay a recording
+//   camrun --synth headlights [--size WxH] [--fps F]
+//   common: [--frames N] [--realtime] [--quiet]
+// ---------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "camera.h"
+#include "pipeline.h"
+
+#include "camera_replay.h"
+#include "camera_synth.h"
+#include "host_time.h"
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: camrun --rec ride.cfr [--loop] | --synth SCENE [--size WxH] [--fps F]\n"
+            "              [--frames N] [--realtime] [--quiet]\n");
+}
+
+static void sleep_until_ns(uint64_t deadline)
+{
+    uint64_t now = host_now_ns();
+    if (deadline <= now) return;
+    uint64_t d = deadline - now;
+    struct timespec ts = { (time_t)(d / 1000000000ull), (long)(d % 1000000000ull) };
+    nanosleep(&ts, NULL);
+}
+
+static void print_frame(const pipeline_t *p, const detection_result_t *r)
+{
+    printf("#%lu fps=%.1f bright=%lu blobs=%d",
+           (unsigned long)p->frame_num, p->current_fps,
+           (unsigned long)r->scene_brightness, r->blob_count);
+    for (int i = 0; i < r->blob_count; i++) {
+        const blob_t *b = &r->blobs[i];
+        printf(" [%u,%u %lu %s]", (unsigned)b->cx, (unsigned)b->cy,
+               (unsigned long)b->pixel_count, blob_class_str(b->classification));
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *rec_path = NULL;
+    int   scene    = -1;
+    int   width    = FRAME_WIDTH;
+    int   height   = FRAME_HEIGHT;
+    float fps      = 25.0f;
+    bool  loop     = false;
+    bool  realtime = false;
+    bool  quiet    = false;
+    long  frames   = -1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        bool has_val = i + 1 < argc;
+        if (strcmp(a, "--rec") == 0 && has_val) {
+            rec_path = argv[++i];
+        } else if (strcmp(a, "--synth") == 0 && has_val) {
+            scene = synth_scene_from_name(argv[++i]);
+            if (scene < 0) {
+                usage();
+                return 2;
+            }
+        } else if (strcmp(a, "--size") == 0 && has_val) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                usage();
+                return 2;
+            }
+        } else if (strcmp(a, "--fps") == 0 && has_val) {
+            fps = (float)atof(argv[++i]);
+        } else if (strcmp(a, "--frames") == 0 && has_val) {
+            frames = atol(argv[++i]);
+        } else if (strcmp(a, "--loop") == 0) {
+            loop = true;
+        } else if (strcmp(a, "--realtime") == 0) {
+            realtime = true;
+        } else if (strcmp(a, "--quiet") == 0) {
+            quiet = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if ((rec_path == NULL) == (scene < 0)) {
+        usage();
+        return 2;
+    }
+
+    // --- Select and start the capture backend ---
+    camera_replay_t replay;
+    camera_synth_t  synth;
+    if (rec_path) {
+        if (!camera_replay_open(&replay, rec_path, loop)) {
+            fprintf(stderr, "cannot open recording %s\n", rec_path);
+            return 1;
+        }
+        if (replay.file.header->fps_milli) fps = replay.file.header->fps_milli / 1000.0f;
+        if (frames < 0 && !loop) frames = (long)replay.file.frame_count;
+        camera_set_backend(&replay.backend);
+    } else {
+        if (!camera_synth_open(&synth, (synth_scene_t)scene, width, height, fps)) {
+            fprintf(stderr, "bad synthetic scene parameters\n");
+            return 1;
+        }
+        camera_set_backend(&synth.backend);
+    }
+    if (frames < 0) frames = 1000;
+
+    if (camera_init() != ESP_OK) return 1;
+
+    // --- Main loop (mirrors detection_task) ---
+    pipeline_t pipe;
+    pipeline_init(&pipe);
+
+    uint64_t frame_ns = (uint64_t)(1e9 / fps);
+    uint64_t start    = host_now_ns();
+    uint64_t busy_ns  = 0;
+    uint64_t worst_ns = 0;
+    long     failures = 0;
+
+    for (long n = 0; n < frames; n++) {
+        if (realtime) sleep_until_ns(start + (uint64_t)n * frame_ns);
+
+        detection_result_t result;
+        uint64_t t0 = host_now_ns();
+        bool ok = pipeline_process_frame(&pipe, &result);
+        uint64_t dt = host_now_ns() - t0;
+        if (!ok) {
+            failures++;
+            if (rec_path && !loop) break;   // End of recording
+            continue;
+        }
+        busy_ns += dt;
+        if (dt > worst_ns) worst_ns = dt;
+        if (!quiet) print_frame(&pipe, &result);
+    }
+
+    uint64_t wall = host_now_ns() - start;
+    unsigned long done = (unsigned long)pipe.frame_num;
+    fprintf(stderr,
+            "frames %lu  failures %ld  wall %.3f s  %.1f frames/s  "
+            "avg %.0f ns/frame  worst %.0f ns/frame\n",
+            done, failures, wall / 1e9, done ? done * 1e9 / wall : 0.0,
+            done ? (double)busy_ns / done : 0.0, (double)worst_ns);
+
+    if (rec_path) camera_replay_close(&replay);
+    else          camera_synth_close(&synth);
+    return 0;
+}
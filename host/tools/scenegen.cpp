@@ -0,0 +1,186 @@
+// ---------------------------------------------------------------------------
+// scenegen — render procedural night scenes to .cfr with ground truth
+//
+//   scenegen [--preset NAME] [--seed N] [--size WxH] [--fps F] [--frames N]
+//            [--threads N] [--vehicles N] [--lamps N] [--dual-led P] [--wet]
+//            [--noise S] [--washout P] [--baseline M] [--ego-speed MPS]
+//            [--lean DEG] [--lean-amp DEG] [--lean-period S] [--exposure X]
+//            [--mono] [--codec raw|rle|bitplane] out_prefix
+//
+// Writes out_prefix.pri.cfr, out_prefix.sec.cfr (unless --mono) and
+// out_prefix.truth.csv with one row per visible light per frame.
+// ---------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "rec_file.h"
+#include "scene.h"
+#include "synth.h"
+
+typedef struct {
+    rec_writer_t pri;
+    rec_writer_t sec;
+    FILE        *truth;
+    frec_codec_t codec;
+    bool         ok;
+} gen_ctx_t;
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: scenegen [--preset NAME] [--seed N] [--size WxH] [--fps F] [--frames N]\n"
+            "                [--threads N] [--vehicles N] [--lamps N] [--dual-led P] [--wet]\n"
+            "                [--noise S] [--washout P] [--baseline M] [--ego-speed MPS]\n"
+            "                [--lean DEG] [--lean-amp DEG] [--lean-period S] [--exposure X] [--mono]\n"
+            "                [--codec raw|rle|bitplane] out_prefix\n");
+}
+
+static void on_frame(uint32_t frame, const uint8_t *pri, const uint8_t *sec,
+                     const scene_truth_t *truth, void *user)
+{
+    gen_ctx_t *g = (gen_ctx_t *)user;
+    if (!g->ok) return;
+
+    frec_meta_t meta;
+    memset(&meta, 0, sizeof(meta));
+    meta.sensor_seq = frame;
+
+    g->ok = rec_writer_add(&g->pri, pri, truth->timestamp_us, &meta,
+                           g->codec, BRIGHTNESS_THRESHOLD);
+    if (g->ok && sec) {
+        g->ok = rec_writer_add(&g->sec, sec, truth->timestamp_us, &meta,
+                               g->codec, BRIGHTNESS_THRESHOLD);
+    }
+
+    for (int i = 0; i < truth->count; i++) {
+        const scene_truth_obj_t *o = &truth->obj[i];
+        if (!o->visible) continue;
+        fprintf(g->truth, "%u,%llu,%d,%u,%u,%u,%.2f,%.2f,%.2f,%.2f,%.3f,%.2f\n",
+                frame, (unsigned long long)truth->timestamp_us, truth->washed_out ? 1 : 0,
+                (unsigned)o->id, (unsigned)o->cls, (unsigned)o->visible,
+                o->pri_x, o->pri_y, o->sec_x, o->sec_y, o->distance_m, o->radius_px);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    scene_params_t p;
+    scene_default_params(&p);
+
+    int  frames  = 250;
+    int  threads = 0;
+    bool mono    = false;
+    frec_codec_t codec = FREC_CODEC_BITPLANE;
+    const char *prefix = NULL;
+
+    // --preset first so later flags override it
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--preset") == 0) {
+            int s = synth_scene_from_name(argv[i + 1]);
+            if (s < 0) {
+                usage();
+                return 2;
+            }
+            synth_params((synth_scene_t)s, p.width, p.height, &p);
+        }
+    }
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--wet") == 0)       { p.wet_road = true; continue; }
+        if (strcmp(a, "--mono") == 0)      { mono = true;       continue; }
+        if (a[0] != '-') {
+            if (prefix || i != argc - 1) {
+                usage();
+                return 2;
+            }
+            prefix = a;
+            continue;
+        }
+        if (!v) {
+            usage();
+            return 2;
+        }
+        i++;
+        if      (strcmp(a, "--preset") == 0)    { /* handled above */ }
+        else if (strcmp(a, "--seed") == 0)      p.seed = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "--size") == 0)      { if (sscanf(v, "%dx%d", &p.width, &p.height) != 2) { usage(); return 2; } }
+        else if (strcmp(a, "--fps") == 0)       p.fps = (float)atof(v);
+        else if (strcmp(a, "--frames") == 0)    frames = atoi(v);
+        else if (strcmp(a, "--threads") == 0)   threads = atoi(v);
+        else if (strcmp(a, "--vehicles") == 0)  p.vehicles = atoi(v);
+        else if (strcmp(a, "--lamps") == 0)     p.streetlamps = atoi(v);
+        else if (strcmp(a, "--dual-led") == 0)  p.dual_led_prob = (float)atof(v);
+        else if (strcmp(a, "--noise") == 0)     p.noise_sigma = (float)atof(v);
+        else if (strcmp(a, "--washout") == 0)   p.washout_prob = (float)atof(v);
+        else if (strcmp(a, "--baseline") == 0)  p.baseline_m = (float)atof(v);
+        else if (strcmp(a, "--ego-speed") == 0) p.ego_speed_mps = (float)atof(v);
+        else if (strcmp(a, "--lean") == 0)      p.lean_deg = (float)atof(v);
+        else if (strcmp(a, "--lean-amp") == 0)  p.lean_amp_deg = (float)atof(v);
+        else if (strcmp(a, "--lean-period") == 0) p.lean_period_s = (float)atof(v);
+        else if (strcmp(a, "--exposure") == 0)  p.exposure = (float)atof(v);
+        else if (strcmp(a, "--codec") == 0) {
+            if      (strcmp(v, "raw") == 0)      codec = FREC_CODEC_RAW;
+            else if (strcmp(v, "rle") == 0)      codec = FREC_CODEC_RLE;
+            else if (strcmp(v, "bitplane") == 0) codec = FREC_CODEC_BITPLANE;
+            else { usage(); return 2; }
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!prefix || frames <= 0 || p.width <= 0 || p.height <= 0 || p.fps <= 0.0f) {
+        usage();
+        return 2;
+    }
+
+    scene_t scene;
+    scene_build(&scene, &p);
+
+    char path[1024];
+    gen_ctx_t g;
+    memset(&g, 0, sizeof(g));
+    g.codec = codec;
+    g.ok    = true;
+    uint32_t fps_milli = (uint32_t)(p.fps * 1000.0f + 0.5f);
+
+    snprintf(path, sizeof(path), "%s.pri.cfr", prefix);
+    if (!rec_writer_open(&g.pri, path, p.width, p.height, fps_milli)) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+    if (!mono) {
+        snprintf(path, sizeof(path), "%s.sec.cfr", prefix);
+        if (!rec_writer_open(&g.sec, path, p.width, p.height, fps_milli)) {
+            fprintf(stderr, "cannot create %s\n", path);
+            return 1;
+        }
+    }
+    snprintf(path, sizeof(path), "%s.truth.csv", prefix);
+    g.truth = fopen(path, "w");
+    if (!g.truth) {
+        fprintf(stderr, "cannot create %s\n", path);
+        return 1;
+    }
+    fprintf(g.truth, "# seed=%u size=%dx%d fps=%.3f baseline_m=%.4f hfov_deg=%.2f "
+                     "lean_deg=%.2f ego_speed_mps=%.2f focal_px=%.3f\n",
+            p.seed, p.width, p.height, p.fps, p.baseline_m, p.hfov_deg,
+            p.lean_deg, p.ego_speed_mps, scene.focal_px);
+    fprintf(g.truth, "frame,timestamp_us,washed_out,id,class,visible,"
+                     "pri_x,pri_y,sec_x,sec_y,distance_m,radius_px\n");
+
+    scene_render_sequence(&scene, 0, (uint32_t)frames, threads, !mono, on_frame, &g);
+
+    bool ok = g.ok;
+    ok = rec_writer_close(&g.pri) && ok;
+    if (!mono) ok = rec_writer_close(&g.sec) && ok;
+    ok = (fclose(g.truth) == 0) && ok;
+    if (!ok) {
+        fprintf(stderr, "write failed\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+# ---------------------------------------------------------------------------
+# Build env:qemu_bench, boot it in Espressif's ESP32 QEMU and collect the
+# BENCH lines. Optionally compare mean cycles/frame against a baseline.
+#
+#   qemu/run_bench.sh [--env ENV] [--port DEV] [--out results.txt]
+#                     [--baseline results.txt] [--threshold PCT]
+#
+# --env selects the build (qemu_bench or qemu_bench_hot); for the latter the
+# IRAM budget of the pinned hot-path symbols is printed after the build.
+# --port flashes a real board instead of booting QEMU and reads its console.
+#
+# Needs: pio (PlatformIO), esptool.py, and qemu-system-xtensa from
+# https://github.com/espressif/qemu (PSRAM support: -m 4M).
+#
+# Cache-miss stalls saved by CAMTEST_HOT_IRAM, on hardware:
+#   qemu/run_bench.sh --port /dev/ttyUSB0 --out flash.txt
+#   qemu/run_bench.sh --port /dev/ttyUSB0 --env qemu_bench_hot --baseline flash.txt
+# The "delta" column is cycles per frame saved (negative) or added.
+#
+# QEMU does not model the flash/PSRAM caches or pipeline stalls, so the
+# cycle counts reflect Xtensa code generation and instruction counts, not
+# memory latency. Under -icount they are deterministic, so compare builds
+# against each other rather than against hardware.
+#
+# Regenerate the embedded corpus (SVGA, mono, bitplane) with the host tools:
+#   for s in headlights city wet; do
+#     build-host/scenegen --preset $s --size 800x600 --frames 4 --mono \
+#         --codec bitplane /tmp/$s && cp /tmp/$s.pri.cfr qemu/corpus/$s.cfr
+#   done
+# ---------------------------------------------------------------------------
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+ENV=qemu_bench
+PORT=""
+OUT=""
+BASELINE=""
+THRESHOLD=2
+TIMEOUT_S="${QEMU_TIMEOUT_S:-600}"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --env)       ENV="$2"; shift 2 ;;
+        --port)      PORT="$2"; shift 2 ;;
+        --out)       OUT="$2"; shift 2 ;;
+        --baseline)  BASELINE="$2"; shift 2 ;;
+        --threshold) THRESHOLD="$2"; shift 2 ;;
+        *) echo "usage: $0 [--env ENV] [--port DEV] [--out FILE] [--baseline FILE] [--threshold PCT]" >&2; exit 2 ;;
+    esac
+done
+
+BUILD="$ROOT/.pio/build/$ENV"
+OUT="${OUT:-$BUILD/bench_results.txt}"
+PIO_HOME="${PLATFORMIO_CORE_DIR:-$HOME/.platformio}"
+BOOT_APP0="$PIO_HOME/packages/framework-arduinoespressif32/tools/partitions/boot_app0.bin"
+TOOLBIN="$PIO_HOME/packages/toolchain-xtensa-esp32/bin"
+
+(cd "$ROOT" && pio run -e "$ENV")
+
+# IRAM budget: size of each hot-path function that landed in IRAM, and the
+# total .iram0.text usage against the 128 KB instruction RAM
+# (IRAM0 is 0x40070000-0x400A0000; flash-mapped code lives at 0x400D0000+)
+if [ -x "$TOOLBIN/xtensa-esp32-elf-nm" ]; then
+    echo "IRAM hot-path symbols ($ENV):"
+    "$TOOLBIN/xtensa-esp32-elf-nm" -S -t d --size-sort -C "$BUILD/firmware.elf" |
+        awk '$3 ~ /^[tT]$/ && $1 + 0 >= 1074200576 && $1 + 0 < 1074397184 &&
+             /uf_find|uf_union|detect_blobs|tracker_classify/ {
+                 sum += $2; printf "  %6d  %s\n", $2, $4 }
+             END { printf "  %6d  total\n", sum }'
+    "$TOOLBIN/xtensa-esp32-elf-size" -A "$BUILD/firmware.elf" |
+        awk '$1 == ".iram0.text" { printf "  .iram0.text %d / 131072 bytes\n", $2 }'
+fi
+
+LOG="$BUILD/bench.log"
+if [ -n "$PORT" ]; then
+    # Real board: flash, then read the console until BENCH_DONE
+    (cd "$ROOT" && pio run -e "$ENV" -t upload --upload-port "$PORT")
+    timeout "$TIMEOUT_S" pio device monitor -p "$PORT" -b 115200 --quiet 2>&1 |
+        tee "$LOG" | sed -u '/BENCH_DONE/q' || true
+else
+
+esptool.py --chip esp32 merge_bin --fill-flash-size 4MB -o "$BUILD/flash.bin" \
+    --flash_mode dio --flash_freq 40m --flash_size 4MB \
+    0x1000  "$BUILD/bootloader.bin" \
+    0x8000  "$BUILD/partitions.bin" \
+    0xe000  "$BOOT_APP0" \
+    0x10000 "$BUILD/firmware.bin"
+
+# QEMU never exits on its own: stop once the firmware prints BENCH_DONE
+timeout "$TIMEOUT_S" qemu-system-xtensa -nographic -machine esp32 -m 4M \
+    -icount shift=0 \
+    -drive file="$BUILD/flash.bin",if=mtd,format=raw \
+    -serial mon:stdio 2>&1 | tee "$LOG" | sed -u '/BENCH_DONE/q' || true
+fi
+
+if ! grep -q BENCH_DONE "$LOG"; then
+    echo "benchmark did not finish (see $LOG)" >&2
+    exit 1
+fi
+grep -E '^(Placement|IRAM)' "$LOG" | tr -d '\r' || true
+grep '^BENCH ' "$LOG" | tr -d '\r' > "$OUT"
+echo "results written to $OUT"
+
+[ -n "$BASELINE" ] || exit 0
+
+# Compare mean cycles per (scene, stage); fail if any grew beyond THRESHOLD %
+printf "%-26s %12s %12s %12s %8s\n" "scene stage" "baseline" "current" "delta" "%"
+awk -v thr="$THRESHOLD" '
+    function field(line, key,   n, i, kv) {
+        n = split(line, kv, " ")
+        for (i = 1; i <= n; i++) if (index(kv[i], key "=") == 1) return substr(kv[i], length(key) + 2)
+        return ""
+    }
+    FNR == NR { base[field($0, "scene") " " field($0, "stage")] = field($0, "mean"); next }
+    {
+        key = field($0, "scene") " " field($0, "stage")
+        cur = field($0, "mean")
+        if (!(key in base) || base[key] == 0) { printf "%-26s %12s %12d %12s      new\n", key, "-", cur, "-"; next }
+        d = 100.0 * (cur - base[key]) / base[key]
+        flag = d > thr ? "  REGRESSION" : ""
+        if (d > thr) bad++
+        printf "%-26s %12d %12d %+12d %+7.2f%%%s\n", key, base[key], cur, cur - base[key], d, flag
+    }
+    END { if (bad) { printf "FAIL: %d stage(s) regressed by more than %s%%\n", bad, thr; exit 1 } print "PASS" }
+' "$BASELINE" "$OUT"
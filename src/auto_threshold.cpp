@@ -0,0 +1,75 @@
+#include "auto_threshold.h"
+#include <string.h>
+#include "config.h"
+
+#define BIN_LEVELS  (256 / SCENE_HIST_BINS)
+
+void auto_threshold_init(auto_threshold_t *a, uint8_t base)
+{
+    memset(a, 0, sizeof(*a));
+    a->value_q8 = (uint16_t)(base << 8);
+    a->target   = base;
+}
+
+// Level above which `permille` of the samples lie, interpolated linearly
+// inside the bin that crosses it
+static int fraction_cut(const scene_stats_t *st, uint16_t permille)
+{
+    uint32_t want = (uint32_t)((uint64_t)st->samples * permille / 1000);
+    if (want == 0) want = 1;
+
+    uint32_t above = 0;
+    for (int b = SCENE_HIST_BINS - 1; b >= 0; b--) {
+        uint32_t n = st->hist[b];
+        if (above + n >= want) {
+            uint32_t need = want - above;   // 1 .. n
+            int cut = b * BIN_LEVELS + BIN_LEVELS - (int)(need * BIN_LEVELS / n);
+            return cut > 255 ? 255 : cut;   // need << n in the top bin: a clipped bloom
+        }
+        above += n;
+    }
+    return 0;
+}
+
+// Centre of the emptiest bin up to AUTO_THRESHOLD_VALLEY_BINS below `cut`,
+// nearest first on ties; `cut` itself if its own bin is the emptiest. Only
+// downwards: a cut moved up past the lights would drop them.
+static int valley_cut(const scene_stats_t *st, int cut)
+{
+    int bc = cut / BIN_LEVELS;
+    if (bc > SCENE_HIST_BINS - 1) bc = SCENE_HIST_BINS - 1;
+    int best = bc;
+    for (int b = bc - 1; b >= 0 && b >= bc - AUTO_THRESHOLD_VALLEY_BINS; b--) {
+        if (st->hist[b] < st->hist[best]) best = b;
+    }
+    return best == bc ? cut : best * BIN_LEVELS + BIN_LEVELS / 2;
+}
+
+uint8_t auto_threshold_update(auto_threshold_t *a, const scene_stats_t *st,
+                              uint16_t permille, uint8_t base, bool daylight)
+{
+    if (permille != a->permille) {
+        auto_threshold_init(a, base);
+        a->permille = permille;
+    }
+    if (permille == 0) return a->threshold = 0;
+
+    if (!daylight && st->samples != 0) {
+        int cut = valley_cut(st, fraction_cut(st, permille));
+        if (cut < AUTO_THRESHOLD_MIN) cut = AUTO_THRESHOLD_MIN;
+        if (cut > AUTO_THRESHOLD_MAX) cut = AUTO_THRESHOLD_MAX;
+        a->target = (uint8_t)cut;
+
+        int32_t delta = ((int32_t)cut << 8) - a->value_q8;
+        delta /= 1 << AUTO_THRESHOLD_SMOOTH_SHIFT;
+        const int32_t max_step = AUTO_THRESHOLD_MAX_STEP << 8;
+        if (delta >  max_step) delta =  max_step;
+        if (delta < -max_step) delta = -max_step;
+        a->value_q8 = (uint16_t)(a->value_q8 + delta);
+        a->updates++;
+    }
+
+    uint32_t t = (a->value_q8 + 128u) >> 8;
+    a->threshold = (uint8_t)(t < 1 ? 1 : t > 255 ? 255 : t);
+    return a->threshold;
+}
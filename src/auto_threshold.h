@@ -0,0 +1,63 @@
+#ifndef AUTO_THRESHOLD_H
+#define AUTO_THRESHOLD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scene_stats.h"
+
+// ---------------------------------------------------------------------------
+// Adaptive brightness threshold — picks the next frame's threshold from the
+// previous frame's scene histogram (scene_stats.h)
+//
+// With a fixed threshold, a shift in sensor exposure turns the same
+// headlight into a 20-pixel or a 20,000-pixel blob and the labelling cost
+// swings with it. Instead the controller aims for a bright share of the
+// sampled ROI (auto_threshold_permille in runtime_config.h):
+//
+//   1. fraction  walk the histogram down from the top until the target
+//                share is reached, interpolating inside the bin
+//   2. valley    move the cut down to the emptiest bin up to
+//                AUTO_THRESHOLD_VALLEY_BINS below it, so it falls in the gap
+//                between the background and the light cores rather than
+//                through a bloom halo
+//   3. clamp     to [AUTO_THRESHOLD_MIN, AUTO_THRESHOLD_MAX]
+//   4. smooth    1/2^AUTO_THRESHOLD_SMOOTH_SHIFT of the way per frame, at
+//                most AUTO_THRESHOLD_MAX_STEP levels
+//
+// Daylight frames and frames with nothing sampled hold the threshold. A
+// target of 0 turns the controller off and the configured
+// brightness_threshold is used as is.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    uint16_t value_q8;      // Smoothed threshold, 8.8 fixed point
+    uint8_t  threshold;     // Threshold for the next frame (0: off)
+    uint8_t  target;        // Last raw cut, after the valley and clamp steps
+    uint16_t permille;      // Target bright share the state was built for
+    uint32_t updates;       // Frames that moved the controller
+} auto_threshold_t;
+
+/** Start at `base` (the configured brightness_threshold). */
+void auto_threshold_init(auto_threshold_t *a, uint8_t base);
+
+/**
+ * Account one frame's scene statistics and pick the next threshold.
+ *
+ * @param permille  Target bright share; 0 = off (threshold reads 0)
+ * @param base      Configured brightness_threshold, restarted from when the
+ *                  target changes
+ * @param daylight  Frame was washed out (DETECT_STATUS_DAYLIGHT): hold
+ * @return          Threshold for the next frame, 0 when off
+ */
+uint8_t auto_threshold_update(auto_threshold_t *a, const scene_stats_t *st,
+                              uint16_t permille, uint8_t base, bool daylight);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUTO_THRESHOLD_H
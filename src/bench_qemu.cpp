@@ -0,0 +1,349 @@
+// ---------------------------------------------------------------------------
+// On-target cycle benchmark firmware (env:qemu_bench in platformio.ini)
+//
+// Replaces main.cpp for the benchmark build: serves frames from .cfr
+// recordings embedded in flash (qemu/corpus) through a fake camera backend,
+// runs fixed workloads over detector, tracker, stereo matching and the full
+// capture -> detect -> classify pipeline, and prints CCOUNT cycles per frame.
+// Runs under the ESP32 QEMU emulator (qemu/run_bench.sh) or on a real board.
+//
+// Output, one line per scene and stage, then BENCH_DONE:
+//   BENCH scene=<name> stage=<stage> frames=<n> mean=<c> min=<c> max=<c>
+//
+// env:qemu_bench_hot builds the same workloads with CAMTEST_HOT_IRAM
+// (placement.h); diffing the two runs on hardware gives the flash-cache
+// stall cycles the placement saves per frame. With -DCAMTEST_BENCH_PERFMON
+// (hardware only; needs the ESP-IDF perfmon component) detect and pipeline
+// also report instruction- and data-side stall cycles from the Xtensa
+// performance counters as stages "<stage>.istall" / "<stage>.dstall".
+//
+// Compiled to nothing unless CAMTEST_QEMU_BENCH is defined, so the regular
+// firmware builds (which glob src/) are unaffected.
+// ---------------------------------------------------------------------------
+#ifdef CAMTEST_QEMU_BENCH
+
+#include <Arduino.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+
+#include "camera.h"
+#include "config.h"
+#include "detector.h"
+#include "frame_record.h"
+#include "pipeline.h"
+#include "uart_link.h"
+
+#ifdef CAMTEST_BENCH_PERFMON
+#include "xtensa_perfmon_access.h"
+#include "xtensa_perfmon_masks.h"
+#endif
+
+#define BENCH_REPS        3     // Passes over each scene's frames per stage
+#define BENCH_MAX_FRAMES  4     // Frames decoded per scene (SVGA: 480 KB each)
+
+// ---------------------------------------------------------------------------
+// Embedded corpus (board_build.embed_files)
+// ---------------------------------------------------------------------------
+#define CORPUS_SYMS(name)                                                   \
+    extern const uint8_t _binary_qemu_corpus_##name##_cfr_start[];          \
+    extern const uint8_t _binary_qemu_corpus_##name##_cfr_end[];
+CORPUS_SYMS(headlights)
+CORPUS_SYMS(city)
+CORPUS_SYMS(wet)
+
+typedef struct {
+    const char    *name;
+    const uint8_t *start;
+    const uint8_t *end;
+} corpus_entry_t;
+
+static const corpus_entry_t k_corpus[] = {
+    { "headlights", _binary_qemu_corpus_headlights_cfr_start, _binary_qemu_corpus_headlights_cfr_end },
+    { "city",       _binary_qemu_corpus_city_cfr_start,       _binary_qemu_corpus_city_cfr_end },
+    { "wet",        _binary_qemu_corpus_wet_cfr_start,        _binary_qemu_corpus_wet_cfr_end },
+};
+#define CORPUS_COUNT  (int)(sizeof(k_corpus) / sizeof(k_corpus[0]))
+
+// Decoded frames of the scene under test
+static uint8_t *s_frames[BENCH_MAX_FRAMES];
+static int      s_frame_count;
+static int      s_width, s_height;
+
+static void frames_free(void)
+{
+    for (int i = 0; i < s_frame_count; i++) heap_caps_free(s_frames[i]);
+    s_frame_count = 0;
+}
+
+// Decode up to BENCH_MAX_FRAMES frames into PSRAM. Flash-mapped data may be
+// unaligned, so every header is copied out before use.
+static bool frames_load(const corpus_entry_t *c)
+{
+    size_t size = (size_t)(c->end - c->start);
+    frec_file_header_t fh;
+    frec_trailer_t     tr;
+    if (size < sizeof(fh) + sizeof(tr)) return false;
+    memcpy(&fh, c->start, sizeof(fh));
+    memcpy(&tr, c->end - sizeof(tr), sizeof(tr));
+    if (fh.magic != FREC_MAGIC || tr.magic != FREC_TRAILER_MAGIC) return false;
+    if (tr.index_offset + (uint64_t)tr.frame_count * sizeof(frec_index_entry_t) > size) return false;
+
+    s_width  = fh.width;
+    s_height = fh.height;
+    size_t npx = (size_t)s_width * s_height;
+    int n = tr.frame_count < BENCH_MAX_FRAMES ? (int)tr.frame_count : BENCH_MAX_FRAMES;
+
+    for (int i = 0; i < n; i++) {
+        frec_index_entry_t ie;
+        frec_frame_header_t hdr;
+        memcpy(&ie, c->start + tr.index_offset + (size_t)i * sizeof(ie), sizeof(ie));
+        if (ie.offset + sizeof(hdr) > size) return false;
+        memcpy(&hdr, c->start + ie.offset, sizeof(hdr));
+        if (ie.offset + sizeof(hdr) + hdr.payload_size > size) return false;
+
+        uint8_t *px = (uint8_t *)heap_caps_malloc(npx, MALLOC_CAP_SPIRAM);
+        if (!px) return false;
+        s_frames[s_frame_count++] = px;
+        if (!frec_decode(&hdr, c->start + ie.offset + sizeof(hdr), s_width, s_height, px)) {
+            return false;
+        }
+    }
+    return s_frame_count > 0;
+}
+
+// ---------------------------------------------------------------------------
+// Fake camera: hands out the decoded frames in order, looping
+// ---------------------------------------------------------------------------
+static camera_fb_t s_fb;
+static uint32_t    s_next_frame;
+
+static esp_err_t embedded_init(void *ctx)
+{
+    (void)ctx;
+    s_next_frame = 0;
+    return ESP_OK;
+}
+
+static camera_fb_t *embedded_capture(void *ctx)
+{
+    (void)ctx;
+    if (s_frame_count == 0) return NULL;
+    uint32_t i = s_next_frame++ % (uint32_t)s_frame_count;
+    s_fb.buf    = s_frames[i];
+    s_fb.len    = (size_t)s_width * s_height;
+    s_fb.width  = (size_t)s_width;
+    s_fb.height = (size_t)s_height;
+    s_fb.format = PIXFORMAT_GRAYSCALE;
+    return &s_fb;
+}
+
+static void embedded_release(void *ctx, camera_fb_t *fb)
+{
+    (void)ctx;
+    (void)fb;
+}
+
+static camera_backend_t s_embedded_backend = {
+    "embedded", embedded_init, embedded_capture, embedded_release, NULL, NULL, NULL
+};
+
+// ---------------------------------------------------------------------------
+// Measurement
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint32_t n;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+} cycle_stats_t;
+
+static void stats_add(cycle_stats_t *s, uint32_t c)
+{
+    if (s->n == 0 || c < s->min) s->min = c;
+    if (c > s->max) s->max = c;
+    s->sum += c;
+    s->n++;
+}
+
+static void stats_print(const char *scene, const char *stage, const cycle_stats_t *s)
+{
+    Serial.printf("BENCH scene=%s stage=%s frames=%lu mean=%lu min=%lu max=%lu\n",
+                  scene, stage, (unsigned long)s->n,
+                  (unsigned long)(s->n ? s->sum / s->n : 0),
+                  (unsigned long)s->min, (unsigned long)s->max);
+}
+
+// ---------------------------------------------------------------------------
+// Stall counters (Xtensa performance monitor, hardware only)
+// ---------------------------------------------------------------------------
+#ifdef CAMTEST_BENCH_PERFMON
+#define PM_I_STALL  0
+#define PM_D_STALL  1
+
+static void stalls_init(void)
+{
+    // All sub-events of each stall class; count at every interrupt level
+    xtensa_perfmon_init(PM_I_STALL, XTPERF_CNT_I_STALL, 0xFFFF, 1, -1);
+    xtensa_perfmon_init(PM_D_STALL, XTPERF_CNT_D_STALL, 0xFFFF, 1, -1);
+}
+
+static void stalls_begin(void)
+{
+    xtensa_perfmon_stop();
+    xtensa_perfmon_reset(PM_I_STALL);
+    xtensa_perfmon_reset(PM_D_STALL);
+    xtensa_perfmon_start();
+}
+
+static void stalls_end(cycle_stats_t *istall, cycle_stats_t *dstall)
+{
+    xtensa_perfmon_stop();
+    stats_add(istall, xtensa_perfmon_value(PM_I_STALL));
+    stats_add(dstall, xtensa_perfmon_value(PM_D_STALL));
+}
+#else
+static void stalls_init(void) {}
+static void stalls_begin(void) {}
+static void stalls_end(cycle_stats_t *istall, cycle_stats_t *dstall)
+{
+    (void)istall;
+    (void)dstall;
+}
+#endif
+
+static void stalls_print(const char *scene, const char *stage,
+                         const cycle_stats_t *istall, const cycle_stats_t *dstall)
+{
+#ifdef CAMTEST_BENCH_PERFMON
+    char name[32];
+    snprintf(name, sizeof(name), "%s.istall", stage);
+    stats_print(scene, name, istall);
+    snprintf(name, sizeof(name), "%s.dstall", stage);
+    stats_print(scene, name, dstall);
+#else
+    (void)scene;
+    (void)stage;
+    (void)istall;
+    (void)dstall;
+#endif
+}
+
+static volatile uint32_t s_sink;
+
+static void bench_scene(const char *scene)
+{
+    static detection_result_t results[BENCH_MAX_FRAMES];
+    cycle_stats_t st, istall, dstall;
+
+    // --- detect_blobs() ---
+    memset(&st, 0, sizeof(st));
+    memset(&istall, 0, sizeof(istall));
+    memset(&dstall, 0, sizeof(dstall));
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (int i = 0; i < s_frame_count; i++) {
+            stalls_begin();
+            uint32_t c0 = ESP.getCycleCount();
+            detect_blobs(s_frames[i], s_width, s_height, &results[i]);
+            stats_add(&st, ESP.getCycleCount() - c0);
+            stalls_end(&istall, &dstall);
+        }
+    }
+    stats_print(scene, "detect", &st);
+    stalls_print(scene, "detect", &istall, &dstall);
+
+    // --- tracker_classify() over the detected sequence ---
+    memset(&st, 0, sizeof(st));
+    tracker_state_t tracker;
+    tracker_reset(&tracker);
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (int i = 0; i < s_frame_count; i++) {
+            detection_result_t r = results[i];
+            uint32_t c0 = ESP.getCycleCount();
+            tracker_classify(&tracker, &r);
+            stats_add(&st, ESP.getCycleCount() - c0);
+            s_sink += (uint32_t)r.blobs[0].classification;
+        }
+    }
+    stats_print(scene, "track", &st);
+
+    // --- pipeline_stereo_match(): secondary = primary shifted by a fixed disparity ---
+    memset(&st, 0, sizeof(st));
+    for (int rep = 0; rep < BENCH_REPS; rep++) {
+        for (int i = 0; i < s_frame_count; i++) {
+            uart_blob_t sec[MAX_BLOBS_TX];
+            int n = results[i].blob_count < MAX_BLOBS_TX ? results[i].blob_count : MAX_BLOBS_TX;
+            for (int b = 0; b < n; b++) {
+                sec[b].cx          = (uint16_t)(results[i].blobs[b].cx + 8);
+                sec[b].cy          = results[i].blobs[b].cy;
+                sec[b].pixel_count = (uint16_t)results[i].blobs[b].pixel_count;
+            }
+            uint32_t c0 = ESP.getCycleCount();
+            stereo_match_t m = pipeline_stereo_match(&results[i], sec, n);
+            stats_add(&st, ESP.getCycleCount() - c0);
+            s_sink += (uint32_t)m.pri;
+        }
+    }
+    stats_print(scene, "stereo", &st);
+
+    // --- Full pipeline_process_frame() through the fake camera ---
+    memset(&st, 0, sizeof(st));
+    memset(&istall, 0, sizeof(istall));
+    memset(&dstall, 0, sizeof(dstall));
+    camera_init();
+    pipeline_t pipe;
+    pipeline_init(&pipe);
+    for (int f = 0; f < BENCH_REPS * s_frame_count; f++) {
+        detection_result_t r;
+        stalls_begin();
+        uint32_t c0 = ESP.getCycleCount();
+        bool ok = pipeline_process_frame(&pipe, &r);
+        uint32_t c = ESP.getCycleCount() - c0;
+        stalls_end(&istall, &dstall);
+        if (ok) stats_add(&st, c);
+    }
+    stats_print(scene, "pipeline", &st);
+    stalls_print(scene, "pipeline", &istall, &dstall);
+}
+
+// ---------------------------------------------------------------------------
+// Arduino entry points
+// ---------------------------------------------------------------------------
+void setup()
+{
+    Serial.begin(UART_BAUD);
+    Serial.println("=== CAMtest cycle benchmark ===");
+    Serial.printf("CPU: %lu MHz, PSRAM: %lu bytes free\n",
+                  (unsigned long)getCpuFrequencyMhz(),
+                  (unsigned long)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+#ifdef CAMTEST_HOT_IRAM
+    const char *placement = "hot paths in IRAM/DRAM";
+#else
+    const char *placement = "default (flash + cache)";
+#endif
+    Serial.printf("Placement: %s, IRAM free: %lu bytes, internal DRAM free: %lu bytes\n",
+                  placement,
+                  (unsigned long)heap_caps_get_free_size(MALLOC_CAP_EXEC),
+                  (unsigned long)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    stalls_init();
+
+    camera_set_backend(&s_embedded_backend);
+
+    for (int c = 0; c < CORPUS_COUNT; c++) {
+        if (!frames_load(&k_corpus[c])) {
+            Serial.printf("BENCH_ERROR scene=%s: cannot decode corpus (PSRAM missing?)\n",
+                          k_corpus[c].name);
+            frames_free();
+            continue;
+        }
+        bench_scene(k_corpus[c].name);
+        frames_free();
+    }
+    Serial.println("BENCH_DONE");
+}
+
+void loop()
+{
+    delay(1000);
+}
+
+#endif  // CAMTEST_QEMU_BENCH
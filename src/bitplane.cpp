@@ -0,0 +1,134 @@
+#include "bitplane.h"
+#include <string.h>
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+
+// ---------------------------------------------------------------------------
+// Allocation
+// ---------------------------------------------------------------------------
+bool bitplane_alloc(bitplane_t *bp, int width, int height)
+{
+    memset(bp, 0, sizeof(*bp));
+    if (width <= 0 || height <= 0) return false;
+
+    size_t n = (size_t)bitplane_stride(width) * height;
+    uint32_t *w = (uint32_t *)mem_frame_alloc(n, sizeof(uint32_t), MALLOC_CAP_SPIRAM, false);
+    if (!w) return false;
+    bp->words  = w;
+    bp->width  = width;
+    bp->height = height;
+    bp->stride = bitplane_stride(width);
+    bp->ystep  = 1;
+    return true;
+}
+
+void bitplane_free(bitplane_t *bp)
+{
+    mem_frame_free(bp->words);
+    memset(bp, 0, sizeof(*bp));
+}
+
+// ---------------------------------------------------------------------------
+// Packing
+// ---------------------------------------------------------------------------
+// Four pixels per 32-bit load (SWAR): byte lanes are compared against the
+// threshold without per-byte branches. Scene brightness is sampled
+// separately (scene_stats.h), so the packer does threshold work only.
+// Little-endian: byte 0 of a load is the leftmost pixel.
+static inline uint32_t load4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Bit 7 of each byte lane set where that byte >= t
+static inline uint32_t ge_mask4(uint32_t v, uint8_t t)
+{
+    const uint32_t lo = v & 0x7F7F7F7Fu;
+    if (t >= 128) {
+        // Needs the top bit and (low 7 bits) >= t - 128; no carry between lanes
+        return (lo + 0x01010101u * (uint32_t)(256 - t)) & v & 0x80808080u;
+    }
+    return ((lo + 0x01010101u * (uint32_t)(128 - t)) | v) & 0x80808080u;
+}
+
+// Lane MSBs (bits 7, 15, 23, 31) -> 4-bit nibble, leftmost pixel in bit 0
+static inline uint32_t lanes_to_nibble(uint32_t m)
+{
+    m >>= 7;
+    return (m | (m >> 7) | (m >> 14) | (m >> 21)) & 0xFu;
+}
+
+void bitplane_pack_row(const uint8_t *row, int width, uint8_t threshold, uint32_t *out)
+{
+    int x = 0;
+
+    // Full words: eight 4-pixel loads each
+    for (; x + 32 <= width; x += 32) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 8; i++) {
+            uint32_t m = ge_mask4(load4(&row[x + i * 4]), threshold);
+            if (m) bits |= lanes_to_nibble(m) << (i * 4);
+        }
+        *out++ = bits;
+    }
+
+    // Partial last word; bits past the width stay clear
+    if (x < width) {
+        uint32_t bits = 0;
+        for (int i = 0; x + i < width; i++) {
+            bits |= (uint32_t)(row[x + i] >= threshold) << i;
+        }
+        *out = bits;
+    }
+}
+
+void bitplane_pack(bitplane_t *bp, const uint8_t *pixels, int y0, uint8_t threshold)
+{
+    bitplane_pack_step(bp, pixels, y0, 1, threshold);
+}
+
+void bitplane_pack_step(bitplane_t *bp, const uint8_t *pixels, int y0, int ystep,
+                        uint8_t threshold)
+{
+    for (int y = 0; y < bp->height; y++) {
+        bitplane_pack_row(&pixels[(size_t)(y0 + y * ystep) * bp->width], bp->width,
+                                 threshold, &bp->words[(size_t)y * bp->stride]);
+    }
+    bp->y0        = y0;
+    bp->ystep     = ystep;
+    bp->threshold = threshold;
+}
+
+// ---------------------------------------------------------------------------
+// Run extraction
+// Each run costs two count-trailing-zeros (NSAU on Xtensa via x & -x) instead
+// of one compare per pixel; empty words cost a single test.
+// ---------------------------------------------------------------------------
+int bitplane_row_runs(const uint32_t *row, int width, bitplane_run_t *runs)
+{
+    int n = 0;
+    int words = bitplane_stride(width);
+
+    for (int w = 0; w < words; w++) {
+        uint32_t bits = row[w];
+        int base = w * 32;
+        while (bits) {
+            int s = __builtin_ctz(bits);
+            uint32_t clear = ~bits & (~0u << s);   // Zeros from s upward
+            int e = clear ? __builtin_ctz(clear) : 32;
+
+            if (n > 0 && runs[n - 1].x1 == base + s) {
+                runs[n - 1].x1 = (uint16_t)(base + e);  // Continues from previous word
+            } else {
+                runs[n].x0 = (uint16_t)(base + s);
+                runs[n].x1 = (uint16_t)(base + e);
+                n++;
+            }
+            bits = e < 32 ? bits & (~0u << e) : 0;
+        }
+    }
+    return n;
+}
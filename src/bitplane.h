@@ -0,0 +1,88 @@
+#ifndef BITPLANE_H
+#define BITPLANE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// ---------------------------------------------------------------------------
+// Thresholded binary mask — 1 bit per pixel, rows packed into 32-bit words
+//
+// Bit x of a row is set when pixel x >= threshold. Bits are LSB-first
+// within each word (same order as the .cfr BITPLANE codec), and bits past
+// the frame width in a row's last word are always clear, so rows can be
+// scanned word-wise without masking. An SVGA frame packs into 60 KB.
+//
+// The plane covers rows [y0, y0 + height) of the source frame so a detector
+// ROI band can be packed on its own; a decimated pack keeps every ystep-th
+// source row only, plane row y being source row y0 + y * ystep. Any stage that only needs "bright or
+// not" — labelling, recording, frame-to-frame differencing (XOR of two
+// planes) — can work on it instead of re-reading 8-bit pixels.
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint32_t *words;        // height * stride words
+    int       width;        // Pixels per row
+    int       height;       // Rows packed
+    int       y0;           // Source-frame row of the plane's row 0
+    int       ystep;        // Source rows per plane row (1 = every row)
+    int       stride;       // Words per row: (width + 31) / 32
+    uint8_t   threshold;    // Threshold used by the last pack
+} bitplane_t;
+
+// A horizontal run of set bits: pixels [x0, x1) of one row
+typedef struct {
+    uint16_t x0;
+    uint16_t x1;
+} bitplane_run_t;
+
+/** Words per packed row for the given width. */
+static inline int bitplane_stride(int width)
+{
+    return (width + 31) / 32;
+}
+
+/** Row y (0-based within the plane) of a packed plane. */
+static inline const uint32_t *bitplane_row(const bitplane_t *bp, int y)
+{
+    return &bp->words[(size_t)y * bp->stride];
+}
+
+/**
+ * Allocate a plane for width x height rows (PSRAM first, then the C heap).
+ * Returns false if out of memory; bp is zeroed either way before allocating.
+ */
+bool bitplane_alloc(bitplane_t *bp, int width, int height);
+
+/** Release a plane from bitplane_alloc(). Safe on a zeroed plane. */
+void bitplane_free(bitplane_t *bp);
+
+/** Pack one row of 8-bit pixels into stride words. */
+void bitplane_pack_row(const uint8_t *row, int width, uint8_t threshold, uint32_t *out);
+
+/** Pack rows [y0, y0 + bp->height) of a width-wide frame into bp. */
+void bitplane_pack(bitplane_t *bp, const uint8_t *pixels, int y0, uint8_t threshold);
+
+/** As bitplane_pack(), taking source rows y0, y0 + ystep, ... (bp->height of them). */
+void bitplane_pack_step(bitplane_t *bp, const uint8_t *pixels, int y0, int ystep,
+                        uint8_t threshold);
+
+/**
+ * Extract the runs of set bits in one packed row, left to right. Runs that
+ * cross a word boundary are returned whole.
+ *
+ * @param row       Packed row (bitplane_stride(width) words)
+ * @param width     Pixels per row
+ * @param runs      Output, room for (width + 1) / 2 runs (the maximum)
+ * @return          Number of runs
+ */
+int bitplane_row_runs(const uint32_t *row, int width, bitplane_run_t *runs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BITPLANE_H
@@ -0,0 +1,74 @@
+#include "boot_time.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_system.h"
+#include "esp_private/esp_clk.h"
+#endif
+
+static const char *TAG = "boot";
+
+// An RTC reading past this at setup() means the RTC timer survived the reset
+#define BOOT_RTC_PLAUSIBLE_US  (10u * 1000u * 1000u)
+
+static uint32_t s_rtc_us[BOOT_STAGE_COUNT];    // From reset (RTC timer)
+static int64_t  s_app_us[BOOT_STAGE_COUNT];    // esp_timer, for the app-only span
+
+static uint32_t rtc_now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)esp_clk_rtc_time();
+#else
+    return (uint32_t)esp_timer_get_time();
+#endif
+}
+
+void boot_time_mark(boot_stage_t stage)
+{
+    if ((unsigned)stage >= BOOT_STAGE_COUNT || s_app_us[stage] != 0) return;
+    s_rtc_us[stage] = rtc_now_us();
+    s_app_us[stage] = esp_timer_get_time();
+    if (s_app_us[stage] == 0) s_app_us[stage] = 1;   // 0 means "not marked"
+}
+
+uint32_t boot_time_us(boot_stage_t stage)
+{
+    if ((unsigned)stage >= BOOT_STAGE_COUNT) return 0;
+    return s_rtc_us[stage];
+}
+
+static const char *reset_reason_str(void)
+{
+#ifdef ESP_PLATFORM
+    switch (esp_reset_reason()) {
+        case ESP_RST_POWERON:   return "power-on";
+        case ESP_RST_BROWNOUT:  return "brown-out";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:       return "watchdog";
+        case ESP_RST_DEEPSLEEP: return "deep-sleep";
+        default:                return "other";
+    }
+#else
+    return "host";
+#endif
+}
+
+void boot_time_log(void)
+{
+    bool from_reset = s_rtc_us[BOOT_STAGE_SETUP] < BOOT_RTC_PLAUSIBLE_US;
+    int64_t app_us  = s_app_us[BOOT_STAGE_FIRST_RESULT] - s_app_us[BOOT_STAGE_SETUP];
+
+    ESP_LOGI(TAG, "BOOT reset=%s setup=%lu camera=%lu task=%lu first_result=%lu ms%s "
+                  "(setup->first_result %lu ms)",
+             reset_reason_str(),
+             (unsigned long)(s_rtc_us[BOOT_STAGE_SETUP] / 1000),
+             (unsigned long)(s_rtc_us[BOOT_STAGE_CAMERA] / 1000),
+             (unsigned long)(s_rtc_us[BOOT_STAGE_TASK] / 1000),
+             (unsigned long)(s_rtc_us[BOOT_STAGE_FIRST_RESULT] / 1000),
+             from_reset ? "" : " [RTC not reset]",
+             (unsigned long)(app_us / 1000));
+}
@@ -0,0 +1,42 @@
+#ifndef BOOT_TIME_H
+#define BOOT_TIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Boot timing — time from reset to the first published detection_result_t
+//
+// main.cpp marks each boot stage once; boot_time_log() prints them when the
+// first result is ready. Times come from the RTC timer, which starts at chip
+// reset and so includes ROM, bootloader and PSRAM init; the app-only span
+// (setup() to first result) comes from esp_timer as a cross-check. After a
+// reset that keeps the RTC domain running (software or watchdog reset) the
+// RTC times are not from reset and are flagged as such.
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    BOOT_STAGE_SETUP = 0,     // setup() entered
+    BOOT_STAGE_CAMERA,        // camera_init() returned
+    BOOT_STAGE_TASK,          // Detection task running
+    BOOT_STAGE_FIRST_RESULT,  // First result about to be published
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+/** Record `stage` (first call per stage wins). */
+void boot_time_mark(boot_stage_t stage);
+
+/** Microseconds from reset to `stage`, or 0 if not marked. */
+uint32_t boot_time_us(boot_stage_t stage);
+
+/** Log one "BOOT ..." line with every stage and the reset reason. */
+void boot_time_log(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_TIME_H
@@ -1,84 +1,209 @@
 #include "camera.h"
 #include "config.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static const char *TAG = "camera";
 
+static const camera_backend_t *s_backend = NULL;
+
+// Capture health and the recovery ladder of the current outage
+static camera_health_t s_health;
+static int64_t  s_outage_start_us;   // First failure of the current outage
+static int64_t  s_step_us;           // Last good frame, or the last recovery step
+static int64_t  s_last_good_us;      // Last good frame (0 = none yet)
+static uint32_t s_step_failures;     // Failures since s_step_us
+static uint32_t s_steps;             // Recovery steps this outage
+
+void camera_set_backend(const camera_backend_t *backend)
+{
+    s_backend = backend;
+}
+
+const camera_backend_t *camera_get_backend(void)
+{
+#ifdef ESP_PLATFORM
+    if (!s_backend) s_backend = camera_ov2640_backend();
+#endif
+    return s_backend;
+}
+
 esp_err_t camera_init(void)
 {
-    camera_config_t config = {
-        .pin_pwdn     = CAM_PIN_PWDN,
-        .pin_reset    = CAM_PIN_RESET,
-        .pin_xclk     = CAM_PIN_XCLK,
-        .pin_sccb_sda = CAM_PIN_SIOD,
-        .pin_sccb_scl = CAM_PIN_SIOC,
-
-        .pin_d7 = CAM_PIN_D7,
-        .pin_d6 = CAM_PIN_D6,
-        .pin_d5 = CAM_PIN_D5,
-        .pin_d4 = CAM_PIN_D4,
-        .pin_d3 = CAM_PIN_D3,
-        .pin_d2 = CAM_PIN_D2,
-        .pin_d1 = CAM_PIN_D1,
-        .pin_d0 = CAM_PIN_D0,
-
-        .pin_vsync = CAM_PIN_VSYNC,
-        .pin_href  = CAM_PIN_HREF,
-        .pin_pclk  = CAM_PIN_PCLK,
-
-        .xclk_freq_hz = CAM_XCLK_FREQ_HZ,
-        .ledc_timer   = LEDC_TIMER_0,
-        .ledc_channel = LEDC_CHANNEL_0,
-
-        .pixel_format  = PIXFORMAT_GRAYSCALE,
-        .frame_size    = FRAMESIZE_SVGA,      // 800x600 (fall back to FRAMESIZE_VGA if too slow)
-        .jpeg_quality  = 0,                   // Not used for grayscale
-        .fb_count      = 2,                   // Double-buffer in PSRAM
-        .fb_location   = CAMERA_FB_IN_PSRAM,
-        .grab_mode     = CAMERA_GRAB_LATEST,  // Always get the newest frame
-    };
-
-    esp_err_t err = esp_camera_init(&config);
+    const camera_backend_t *be = camera_get_backend();
+    if (!be) {
+        ESP_LOGE(TAG, "No capture backend selected");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = be->init(be->ctx);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Camera init failed: 0x%x", err);
+        ESP_LOGE(TAG, "Backend '%s' init failed: 0x%x", be->name, err);
         return err;
     }
+    return ESP_OK;
+}
 
-    // Apply sensor-level image orientation corrections — zero CPU cost.
-    // Top-to-top breadboard mounting rotates one PCB 180° in-plane, which is
-    // equivalent to vflip=1 AND hmirror=1 together (a 180° image rotation).
-    // hmirror must be ON so the secondary's X axis runs left-to-right the same
-    // way as the primary — critical for disparity to have the correct sign.
-    sensor_t *s = esp_camera_sensor_get();
-    if (s) {
-#ifdef CAM_ROLE_SECONDARY
-        s->set_vflip(s, 1);    // Correct upside-down rows
-        s->set_hmirror(s, 1);  // Correct left-right mirror from 180° rotation
-        ESP_LOGI(TAG, "Secondary: vflip ON, hmirror ON (top-to-top mount)");
-#else
-        s->set_vflip(s, 0);
-        s->set_hmirror(s, 0);
-        ESP_LOGI(TAG, "Primary: vflip OFF, hmirror OFF");
-#endif
+// ---------------------------------------------------------------------------
+// Recovery
+// ---------------------------------------------------------------------------
+esp_err_t camera_recover(camera_recover_level_t level)
+{
+    const camera_backend_t *be = camera_get_backend();
+    if (!be || !be->recover) return ESP_ERR_NOT_SUPPORTED;
+
+    if (level == CAMERA_RECOVER_SENSOR) s_health.sensor_resets++;
+    else                                s_health.full_resets++;
+
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t err = be->recover(be->ctx, level);
+    ESP_LOGW(TAG, "%s reset: %s in %lu ms", level == CAMERA_RECOVER_SENSOR ? "Sensor" : "Full",
+             err == ESP_OK ? "ok" : "failed", (unsigned long)((esp_timer_get_time() - t0) / 1000));
+    return err;
+}
+
+esp_err_t camera_set_exposure(const camera_exposure_t *e)
+{
+    const camera_backend_t *be = camera_get_backend();
+    if (!be || !be->set_exposure) return ESP_ERR_NOT_SUPPORTED;
+    return be->set_exposure(be->ctx, e);
+}
+
+static void capture_failed(void)
+{
+    int64_t now = esp_timer_get_time();
+    if (s_health.failures == 0) {
+        ESP_LOGE(TAG, "Frame capture failed");
+        s_outage_start_us = now;
+        // The time trigger counts the whole gap, not just the failed waits
+        s_step_us         = s_last_good_us ? s_last_good_us : now;
+        s_step_failures   = 0;
+        s_steps           = 0;
     }
+    s_health.failures++;
+    s_health.total_failures++;
+    s_step_failures++;
 
-    ESP_LOGI(TAG, "Camera initialized: GRAYSCALE SVGA 800x600, 2 frame buffers in PSRAM");
-    return ESP_OK;
+    // Give each step CAMERA_RECOVER_AFTER_FAILS captures or _MS to take hold
+    if (s_step_failures < CAMERA_RECOVER_AFTER_FAILS &&
+        now - s_step_us < (int64_t)CAMERA_RECOVER_AFTER_MS * 1000) return;
+
+    camera_recover_level_t level = s_steps < CAMERA_RECOVER_SENSOR_TRIES ? CAMERA_RECOVER_SENSOR
+                                                                         : CAMERA_RECOVER_FULL;
+    if (camera_recover(level) == ESP_ERR_NOT_SUPPORTED) return;
+    s_steps++;
+    s_step_us       = esp_timer_get_time();
+    s_step_failures = 0;
 }
 
+static void capture_recovered(void)
+{
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - s_outage_start_us) / 1000);
+    s_health.recoveries++;
+    s_health.last_recovery_ms = ms;
+    if (ms > s_health.max_recovery_ms) s_health.max_recovery_ms = ms;
+    ESP_LOGW(TAG, "Capture recovered: %lu failures, %lu reset steps, %lu ms",
+             (unsigned long)s_health.failures, (unsigned long)s_steps, (unsigned long)ms);
+    s_health.failures = 0;
+}
+
+const camera_health_t *camera_get_health(void)
+{
+    return &s_health;
+}
+
+// ---------------------------------------------------------------------------
+// Capture
+// ---------------------------------------------------------------------------
 camera_fb_t *camera_capture_frame(void)
 {
-    camera_fb_t *fb = esp_camera_fb_get();
+    const camera_backend_t *be = s_backend;
+    if (!be) return NULL;
+
+    camera_fb_t *fb = be->capture(be->ctx);
+    if (fb && (!fb->buf || fb->width == 0 || fb->height == 0 ||
+               fb->len < fb->width * fb->height)) {
+        be->release(be->ctx, fb);   // Truncated frame (DMA overrun, sensor glitch)
+        fb = NULL;
+    }
     if (!fb) {
-        ESP_LOGE(TAG, "Frame capture failed");
+        capture_failed();
         return NULL;
     }
+    if (s_health.failures) capture_recovered();
+    s_last_good_us = esp_timer_get_time();
     return fb;
 }
 
 void camera_release_frame(camera_fb_t *fb)
 {
-    if (fb) {
-        esp_camera_fb_return(fb);
+    const camera_backend_t *be = s_backend;
+    if (fb && be) {
+        be->release(be->ctx, fb);
     }
 }
+
+// ---------------------------------------------------------------------------
+// Frame-drop and frame-age accounting
+// ---------------------------------------------------------------------------
+void camera_frame_clock_reset(camera_frame_clock_t *c, uint32_t nominal_period_us)
+{
+    c->last_ts_us    = 0;
+    c->last_gap_us   = 0;
+    c->period_us     = nominal_period_us;
+    c->nominal_us    = nominal_period_us;
+    c->window_min_us = UINT32_MAX;
+    c->prev_min_us   = UINT32_MAX;
+    c->window_n      = 0;
+}
+
+void camera_frame_clock_pause(camera_frame_clock_t *c)
+{
+    c->last_ts_us  = 0;
+    c->last_gap_us = 0;
+}
+
+void camera_frame_clock_update(camera_frame_clock_t *c, const camera_fb_t *fb,
+                               int64_t now_us, camera_frame_info_t *out)
+{
+    int64_t ts = (int64_t)fb->timestamp.tv_sec * 1000000LL + fb->timestamp.tv_usec;
+    int64_t age = now_us - ts;
+    out->age_us  = age > 0 && age < UINT32_MAX ? (uint32_t)age : 0;
+    out->dropped = 0;
+
+    int64_t gap = ts - c->last_ts_us;
+    bool have_prev = c->last_ts_us != 0;
+    c->last_ts_us = ts;
+    if (!have_prev || gap <= 0 || gap > UINT32_MAX) {
+        c->last_gap_us = 0;
+        return;
+    }
+
+    // Period candidates: the gap itself, and, when it differs from the last
+    // gap by a whole period rather than jitter, the smaller of the two gaps
+    // divided by its period count. The difference only sets that count: it
+    // spans three timestamps, so it carries twice a gap's jitter, and as a
+    // candidate it would drag the minimum low
+    int64_t cand = gap;
+    if (c->last_gap_us > 0) {
+        int64_t diff  = gap > c->last_gap_us ? gap - c->last_gap_us : c->last_gap_us - gap;
+        int64_t small = gap < c->last_gap_us ? gap : c->last_gap_us;
+        if (diff * 4 > gap) {
+            int64_t k = (small + diff / 2) / diff;
+            if (k >= 1 && small / k < cand) cand = small / k;
+        }
+    }
+    c->last_gap_us = gap;
+
+    if ((uint32_t)cand < c->window_min_us) c->window_min_us = (uint32_t)cand;
+    c->period_us = c->window_min_us < c->prev_min_us ? c->window_min_us : c->prev_min_us;
+    if (c->period_us < c->nominal_us) c->period_us = c->nominal_us;   // Jitter below the sensor's limit
+    if (++c->window_n >= CAMERA_PERIOD_WINDOW) {
+        c->prev_min_us   = c->window_min_us;
+        c->window_min_us = UINT32_MAX;
+        c->window_n      = 0;
+    }
+
+    uint32_t periods = (uint32_t)((gap + c->period_us / 2) / c->period_us);
+    out->dropped = periods > 1 ? periods - 1 : 0;
+}
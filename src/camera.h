@@ -8,8 +8,142 @@ extern "C" {
 #include "esp_camera.h"
 #include "esp_err.h"
 
+// ---------------------------------------------------------------------------
+// Capture backend interface
+// The capture API below forwards to one active backend. On the ESP32 this is
+// the OV2640 driver; host builds plug in file-replay or synthetic backends so
+// the detection pipeline can run without a board.
+// ---------------------------------------------------------------------------
+
+// Recovery levels, cheapest first
+typedef enum {
+    CAMERA_RECOVER_SENSOR = 1,   // Power-cycle the sensor and reload its registers;
+                                 // driver, DMA and frame buffers are kept
+    CAMERA_RECOVER_FULL   = 2,   // Tear the driver down and initialise it again
+} camera_recover_level_t;
+
+// Sensor exposure, in OV2640 units. The sensor's own AEC/AGC aims at the
+// average scene brightness; exposure_ctrl.h drives it manually instead.
+typedef struct {
+    uint8_t  manual;      // 0: hand exposure and gain back to the sensor's AEC/AGC
+    uint8_t  gain;        // AGC gain index, 0-30 (about 1x-31x)
+    uint16_t aec_lines;   // Exposure time in sensor lines, 0-1200
+} camera_exposure_t;
+
+typedef struct camera_backend {
+    const char  *name;
+    esp_err_t    (*init)(void *ctx);
+    camera_fb_t *(*capture)(void *ctx);                 // NULL on failure
+    void         (*release)(void *ctx, camera_fb_t *fb);
+    esp_err_t    (*recover)(void *ctx, camera_recover_level_t level);  // Optional
+    esp_err_t    (*set_exposure)(void *ctx, const camera_exposure_t *e); // Optional
+    void        *ctx;                                   // Passed to every hook
+} camera_backend_t;
+
+// ---------------------------------------------------------------------------
+// Capture health — camera_capture_frame() counts consecutive failures (no
+// frame, or a frame shorter than width * height) and escalates on its own:
+// after CAMERA_RECOVER_AFTER_FAILS failures or CAMERA_RECOVER_AFTER_MS
+// without a good frame it asks the backend for a sensor reset, and after
+// CAMERA_RECOVER_SENSOR_TRIES of those fail, for a full re-init, repeating
+// at the same pace until frames return. Nothing above the capture layer is
+// reset, so tracker state and the runtime config survive an outage.
+//
+// The time trigger counts from the last good frame, and the OV2640 backend
+// fails a capture after CAMERA_CAPTURE_TIMEOUT_MS without a frame, so with
+// the defaults a stall is worked on at:
+//   ~300 ms   first sensor reset (the first timed-out capture)
+//   ~600 ms   second sensor reset
+//   ~900 ms   full re-init, which first waits for the driver's own frame
+//             timeout (esp32-camera: 4 s) to release the grabber
+// A stall a sensor reset clears is therefore over in well under a second
+// (plus the sensor's first frames); one that needs a full re-init takes
+// about 5 s.
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint32_t failures;          // Consecutive failed captures (0 = healthy)
+    uint32_t total_failures;
+    uint32_t sensor_resets;     // CAMERA_RECOVER_SENSOR attempts
+    uint32_t full_resets;       // CAMERA_RECOVER_FULL attempts
+    uint32_t recoveries;        // Outages ended by a good frame
+    uint32_t last_recovery_ms;  // First failure -> next good frame, last outage
+    uint32_t max_recovery_ms;
+} camera_health_t;
+
+/**
+ * Select the capture backend. Call before camera_init(); the backend struct
+ * must outlive its use. Passing NULL restores the platform default
+ * (OV2640 on the ESP32, none on the host).
+ */
+void camera_set_backend(const camera_backend_t *backend);
+
+/** Currently selected backend, or NULL if none is available. */
+const camera_backend_t *camera_get_backend(void);
+
+#ifdef ESP_PLATFORM
+/** The real OV2640 sensor via esp32-camera (GRAYSCALE SVGA, 2 PSRAM buffers). */
+const camera_backend_t *camera_ov2640_backend(void);
+#endif
+
+// ---------------------------------------------------------------------------
+// Frame-drop and frame-age accounting
+// With CAMERA_GRAB_LATEST the driver overwrites frames the detect task was
+// too slow to take, without telling anyone. The capture timestamps
+// (fb->timestamp, stamped by the driver at capture) sit on the sensor's frame
+// grid, so the gap between two processed frames, in sensor periods, gives
+// the frames dropped in between. The period is estimated from the stream:
+// the smallest gap seen over the last two windows, or, when consecutive
+// gaps differ by a whole period (gaps of 2 and 3 periods differ by one),
+// the smaller gap over its period count, so it is found even when every
+// gap contains drops. The difference itself is never the estimate: it
+// carries the jitter of three timestamps, and the count it gives is exact
+// while the smaller gap is at most 3 periods and jitter stays under ~4%. A nominal
+// period, when given, is the starting estimate and a floor: the sensor
+// cannot run faster, but it does run slower (the OV2640 stretches frames
+// at long exposure), and a gap of one such period is no drop. A task that
+// always skips the same number of frames then looks like a slower sensor
+// and reports none.
+// State is per caller (one per pipeline), not global.
+// ---------------------------------------------------------------------------
+#define CAMERA_PERIOD_WINDOW  64   // Frames per period-estimate window
+
+typedef struct {
+    int64_t  last_ts_us;        // Timestamp of the previous frame (0 = none)
+    int64_t  last_gap_us;
+    uint32_t period_us;         // Estimated sensor frame period (0 = not yet)
+    uint32_t nominal_us;        // Floor for period_us (0 = none)
+    uint32_t window_min_us;     // Smallest period candidate, current window
+    uint32_t prev_min_us;       // ... previous window
+    uint32_t window_n;
+} camera_frame_clock_t;
+
+typedef struct {
+    uint32_t dropped;           // Sensor frames skipped since the previous frame
+    uint32_t age_us;            // Capture timestamp -> dequeue
+} camera_frame_info_t;
+
+/**
+ * Forget the stream. `nominal_period_us` is the configured sensor frame
+ * period, or 0 to rely on the stream alone.
+ */
+void camera_frame_clock_reset(camera_frame_clock_t *c, uint32_t nominal_period_us);
+
+/**
+ * The caller is about to skip frames on purpose (a day-mode sleep): the
+ * next frame reports no drops. The period estimate is kept.
+ */
+void camera_frame_clock_pause(camera_frame_clock_t *c);
+
+/**
+ * Account one dequeued frame: `now_us` is esp_timer_get_time() at dequeue.
+ * Frames without a timestamp (or with one that did not advance) report no
+ * drops.
+ */
+void camera_frame_clock_update(camera_frame_clock_t *c, const camera_fb_t *fb,
+                               int64_t now_us, camera_frame_info_t *out);
+
 /**
- * Initialize the OV2640 camera in grayscale VGA mode.
+ * Initialize the active capture backend.
  * Returns ESP_OK on success.
  */
 esp_err_t camera_init(void);
@@ -26,6 +160,23 @@ camera_fb_t *camera_capture_frame(void);
  */
 void camera_release_frame(camera_fb_t *fb);
 
+/**
+ * Run one recovery step on the active backend now (camera_capture_frame()
+ * does this by itself; setup() uses it to retry a failed camera_init()).
+ * ESP_ERR_NOT_SUPPORTED if the backend has no recover hook.
+ */
+esp_err_t camera_recover(camera_recover_level_t level);
+
+/**
+ * Write exposure settings to the sensor. They apply from a later frame (the
+ * sensor latches them at a frame start) and survive camera_recover().
+ * ESP_ERR_NOT_SUPPORTED if the backend has no set_exposure hook.
+ */
+esp_err_t camera_set_exposure(const camera_exposure_t *e);
+
+/** Capture health counters since boot. */
+const camera_health_t *camera_get_health(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,236 @@
+#include "camera.h"
+#include "config.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+// ---------------------------------------------------------------------------
+// OV2640 capture backend — esp32-camera driver on the AI-Thinker board
+// ---------------------------------------------------------------------------
+
+static const char *TAG = "ov2640";
+
+#define OV2640_PWDN_MS  10   // Power-down pulse, and settle time before SCCB access
+
+// Orientation for the top-to-top mount; reapplied after a sensor reset
+static void ov2640_apply_orientation(sensor_t *s)
+{
+    // Apply sensor-level image orientation corrections — zero CPU cost.
+    // Top-to-top breadboard mounting rotates one PCB 180° in-plane, which is
+    // equivalent to vflip=1 AND hmirror=1 together (a 180° image rotation).
+    // hmirror must be ON so the secondary's X axis runs left-to-right the same
+    // way as the primary — critical for disparity to have the correct sign.
+#ifdef CAM_ROLE_SECONDARY
+    s->set_vflip(s, 1);    // Correct upside-down rows
+    s->set_hmirror(s, 1);  // Correct left-right mirror from 180° rotation
+#else
+    s->set_vflip(s, 0);
+    s->set_hmirror(s, 0);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Frame grabber — esp_camera_fb_get() waits out the driver's fixed frame
+// timeout (seconds) when the sensor stalls, far longer than the recovery
+// ladder (camera.h) should take to notice. A grabber task blocks in the
+// driver instead and keeps the newest frame in a one-slot queue;
+// ov2640_capture() waits at most CAMERA_CAPTURE_TIMEOUT_MS for it, so a
+// stall is a failed capture at the frame deadline. The driver is only
+// entered under s_grab_lock, which a full re-init takes to keep the grabber
+// out while the driver is torn down.
+// ---------------------------------------------------------------------------
+static QueueHandle_t     s_frames;
+static SemaphoreHandle_t s_grab_lock;
+
+static void ov2640_drop_queued(void)
+{
+    camera_fb_t *old;
+    while (xQueueReceive(s_frames, &old, 0) == pdTRUE) esp_camera_fb_return(old);
+}
+
+static void ov2640_grab_task(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        xSemaphoreTake(s_grab_lock, portMAX_DELAY);
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (fb) {
+            ov2640_drop_queued();   // Keep only the newest, like CAMERA_GRAB_LATEST
+            xQueueSend(s_frames, &fb, 0);
+        }
+        xSemaphoreGive(s_grab_lock);
+        if (!fb) vTaskDelay(1);     // Driver down (failed init): don't spin
+    }
+}
+
+static esp_err_t ov2640_start_grabber(void)
+{
+    if (s_frames) return ESP_OK;
+    s_frames    = xQueueCreate(1, sizeof(camera_fb_t *));
+    s_grab_lock = xSemaphoreCreateMutex();
+    if (!s_frames || !s_grab_lock) return ESP_ERR_NO_MEM;
+    // Above the detect task (5), so a finished frame is queued right away
+    if (xTaskCreatePinnedToCore(ov2640_grab_task, "cam_grab", CAMERA_GRAB_TASK_STACK,
+                                NULL, 6, NULL, 0) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// Last exposure written through camera_set_exposure(); reapplied after a
+// sensor reset, which puts the sensor back on its own AEC/AGC
+static camera_exposure_t s_exposure;
+
+static esp_err_t ov2640_apply_exposure(sensor_t *s, const camera_exposure_t *e)
+{
+    if (!e->manual) {
+        if (s->set_exposure_ctrl(s, 1) != 0) return ESP_FAIL;
+        if (s->set_gain_ctrl(s, 1) != 0) return ESP_FAIL;
+        return ESP_OK;
+    }
+    // AEC/AGC off first, or the DSP overwrites the values on the next frame
+    if (s->set_exposure_ctrl(s, 0) != 0) return ESP_FAIL;
+    if (s->set_gain_ctrl(s, 0) != 0) return ESP_FAIL;
+    if (s->set_aec_value(s, e->aec_lines) != 0) return ESP_FAIL;
+    if (s->set_agc_gain(s, e->gain) != 0) return ESP_FAIL;
+    return ESP_OK;
+}
+
+static esp_err_t ov2640_init(void *ctx)
+{
+    (void)ctx;
+
+    camera_config_t config = {
+        .pin_pwdn     = CAM_PIN_PWDN,
+        .pin_reset    = CAM_PIN_RESET,
+        .pin_xclk     = CAM_PIN_XCLK,
+        .pin_sccb_sda = CAM_PIN_SIOD,
+        .pin_sccb_scl = CAM_PIN_SIOC,
+
+        .pin_d7 = CAM_PIN_D7,
+        .pin_d6 = CAM_PIN_D6,
+        .pin_d5 = CAM_PIN_D5,
+        .pin_d4 = CAM_PIN_D4,
+        .pin_d3 = CAM_PIN_D3,
+        .pin_d2 = CAM_PIN_D2,
+        .pin_d1 = CAM_PIN_D1,
+        .pin_d0 = CAM_PIN_D0,
+
+        .pin_vsync = CAM_PIN_VSYNC,
+        .pin_href  = CAM_PIN_HREF,
+        .pin_pclk  = CAM_PIN_PCLK,
+
+        .xclk_freq_hz = CAM_XCLK_FREQ_HZ,
+        .ledc_timer   = LEDC_TIMER_0,
+        .ledc_channel = LEDC_CHANNEL_0,
+
+        .pixel_format  = PIXFORMAT_GRAYSCALE,
+        .frame_size    = FRAMESIZE_SVGA,      // 800x600 (fall back to FRAMESIZE_VGA if too slow)
+        .jpeg_quality  = 0,                   // Not used for grayscale
+        .fb_count      = CAMERA_FB_COUNT,     // Double-buffer in PSRAM
+        .fb_location   = CAMERA_FB_IN_PSRAM,
+        .grab_mode     = CAMERA_GRAB_LATEST,  // Always get the newest frame
+    };
+
+    esp_err_t err = esp_camera_init(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Camera init failed: 0x%x", err);
+        return err;
+    }
+
+    sensor_t *s = esp_camera_sensor_get();
+    if (s) {
+        ov2640_apply_orientation(s);
+        if (s_exposure.manual) ov2640_apply_exposure(s, &s_exposure);
+#ifdef CAM_ROLE_SECONDARY
+        ESP_LOGI(TAG, "Secondary: vflip ON, hmirror ON (top-to-top mount)");
+#else
+        ESP_LOGI(TAG, "Primary: vflip OFF, hmirror OFF");
+#endif
+    }
+
+    ESP_LOGI(TAG, "Camera initialized: GRAYSCALE SVGA 800x600, 2 frame buffers in PSRAM");
+    return ov2640_start_grabber();
+}
+
+// Pulse PWDN: the sensor drops out of a wedged state (ESD, SCCB glitch)
+static void ov2640_power_cycle(void)
+{
+    if (CAM_PIN_PWDN < 0) return;
+    gpio_set_direction((gpio_num_t)CAM_PIN_PWDN, GPIO_MODE_OUTPUT);
+    gpio_set_level((gpio_num_t)CAM_PIN_PWDN, 1);
+    vTaskDelay(pdMS_TO_TICKS(OV2640_PWDN_MS));
+    gpio_set_level((gpio_num_t)CAM_PIN_PWDN, 0);
+    vTaskDelay(pdMS_TO_TICKS(OV2640_PWDN_MS));
+}
+
+static esp_err_t ov2640_recover(void *ctx, camera_recover_level_t level)
+{
+    if (level == CAMERA_RECOVER_SENSOR) {
+        // Partial init: the driver, DMA and frame buffers stay up; only the
+        // sensor registers are rewritten over SCCB
+        sensor_t *s = esp_camera_sensor_get();
+        if (!s) return ESP_ERR_INVALID_STATE;
+        ov2640_power_cycle();
+        if (s->reset(s) != 0) return ESP_FAIL;
+        if (s->set_pixformat(s, PIXFORMAT_GRAYSCALE) != 0) return ESP_FAIL;
+        if (s->set_framesize(s, FRAMESIZE_SVGA) != 0) return ESP_FAIL;
+        ov2640_apply_orientation(s);
+        if (s_exposure.manual) return ov2640_apply_exposure(s, &s_exposure);
+        return ESP_OK;
+    }
+
+    // The grabber may sit in esp_camera_fb_get() until the driver's own
+    // timeout; wait it out before tearing the driver down
+    bool locked = s_grab_lock && xSemaphoreTake(s_grab_lock, portMAX_DELAY) == pdTRUE;
+    if (s_frames) ov2640_drop_queued();
+    esp_camera_deinit();   // Harmless if init never completed
+    ov2640_power_cycle();
+    esp_err_t err = ov2640_init(ctx);
+    if (locked) xSemaphoreGive(s_grab_lock);
+    return err;
+}
+
+static camera_fb_t *ov2640_capture(void *ctx)
+{
+    (void)ctx;
+    camera_fb_t *fb = NULL;
+    if (!s_frames) return NULL;
+    if (xQueueReceive(s_frames, &fb, pdMS_TO_TICKS(CAMERA_CAPTURE_TIMEOUT_MS)) != pdTRUE) {
+        return NULL;   // No frame by the deadline: a stall, whatever the driver thinks
+    }
+    return fb;
+}
+
+static void ov2640_release(void *ctx, camera_fb_t *fb)
+{
+    (void)ctx;
+    esp_camera_fb_return(fb);
+}
+
+static esp_err_t ov2640_set_exposure(void *ctx, const camera_exposure_t *e)
+{
+    (void)ctx;
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s) return ESP_ERR_INVALID_STATE;
+    s_exposure = *e;
+    return ov2640_apply_exposure(s, e);
+}
+
+static const camera_backend_t s_ov2640_backend = {
+    .name         = "ov2640",
+    .init         = ov2640_init,
+    .capture      = ov2640_capture,
+    .release      = ov2640_release,
+    .recover      = ov2640_recover,
+    .set_exposure = ov2640_set_exposure,
+    .ctx          = NULL,
+};
+
+const camera_backend_t *camera_ov2640_backend(void)
+{
+    return &s_ov2640_backend;
+}
@@ -34,21 +34,89 @@
 // ---------------------------------------------------------------------------
 #define FRAME_WIDTH   800
 #define FRAME_HEIGHT  600
+#define CAMERA_FB_COUNT  2          // Driver frame buffers in PSRAM (double-buffered)
+// Nominal sensor frame rate: the drop estimate (camera.h) starts from it and
+// never assumes a faster sensor. Slower is fine (low light, long exposure).
+// 0 = learn from the stream only.
+#define CAMERA_SENSOR_FPS 25
+
+// Capture recovery (camera.h): a reset step is due after this many failed
+// captures or this long without a good frame; the first
+// CAMERA_RECOVER_SENSOR_TRIES steps power-cycle the sensor via CAM_PIN_PWDN
+// and reload its registers, later steps re-init the whole driver.
+// A capture fails after CAMERA_CAPTURE_TIMEOUT_MS without a frame (above the
+// slowest night frame period at long exposure), so a stalled sensor gets its
+// first reset that long after the last good frame plus the ~25 ms reset;
+// see camera.h for the worst case.
+#define CAMERA_RECOVER_AFTER_FAILS   3
+#define CAMERA_RECOVER_AFTER_MS    200
+#define CAMERA_RECOVER_SENSOR_TRIES  2
+#define CAMERA_CAPTURE_TIMEOUT_MS  300
+#define CAMERA_GRAB_TASK_STACK    2048   // OV2640 grabber task (camera_ov2640.cpp)
 
 // ---------------------------------------------------------------------------
 // Blob detection tuning — scaled for SVGA (800x600 = 480,000 px)
+// Threshold, blob size, merge distance, ROI and the TRACKER_* values below
+// are defaults: the running values live in runtime_config.h, tunable over
+// serial (config_cmd.h) and persisted in NVS.
 // ---------------------------------------------------------------------------
 #define BRIGHTNESS_THRESHOLD  200   // Pixel brightness to count as "bright" (0-255)
 #define MIN_BLOB_PIXELS        16   // Ignore blobs smaller than this (noise)
 #define MAX_BLOB_PIXELS     70000   // Ignore blobs larger than this (whole-frame wash)
 #define MAX_BLOBS               16  // Max number of blobs to track per frame
 #define BLOB_MERGE_DIST         30  // Merge blobs whose centroids are within this many px
+#define SATURATION_LEVEL       250  // Pixel value counted as clipped (blob_t.saturated)
 
 // Region of interest — restrict detection to a vertical band (horizon area)
 // Set both to 0 to use the full frame
 #define ROI_Y_START    0            // Top row of ROI (0 = top of frame)
 #define ROI_Y_END      0            // Bottom row of ROI (0 = use full frame)
 
+// Labelling path used by detect_blobs():
+//   0 = label map, two passes over the frame (470 KB at SVGA with 8-bit
+//       labels, 940 KB after a promotion to 16-bit)
+//   1 = 1-bit packed mask (60 KB at SVGA), one pass labelling runs of set
+//       bits — same blobs, ~3x faster on night scenes
+#ifndef DETECTOR_BITPLANE
+#define DETECTOR_BITPLANE      1
+#endif
+
+// Provisional labels per frame. VGA worst-case is thousands, but in practice
+// a thresholded night scene has very few bright regions.
+#define MAX_LABELS           512
+
+// Pixel connectivity for blob labelling: 8 (diagonal neighbours join a blob)
+// or 4 (edge neighbours only)
+#define DETECTOR_CONNECTIVITY  8
+
+// Scene statistics (scene_stats.h): every SCENE_SAMPLE_STEP_X-th pixel of
+// every SCENE_SAMPLE_STEP_Y-th ROI row — 7,500 samples at SVGA. Labelling
+// does no pixel summing of its own.
+#define SCENE_SAMPLE_STEP_X     8
+#define SCENE_SAMPLE_STEP_Y     8
+
+// Day-mode bypass: a frame whose sampled mean or bright share (>=
+// brightness_threshold, per mille) reaches these limits is reported as
+// DETECT_STATUS_DAYLIGHT without labelling. After
+// DAY_MODE_ENTER_FRAMES such frames in a row the detect task only looks
+// every DAY_MODE_FRAME_MS until a night frame comes back.
+#define DAY_MEAN_MIN          110
+#define DAY_BRIGHT_PERMILLE   250
+#define DAY_MODE_ENTER_FRAMES  10
+#define DAY_MODE_FRAME_MS     500
+
+// Adaptive threshold (auto_threshold.h): the next frame's threshold is cut
+// from the last scene histogram to keep AUTO_THRESHOLD_PERMILLE of the
+// sampled ROI bright. 0 = fixed brightness_threshold (runtime-tunable as
+// auto_threshold_permille). MIN keeps an empty dark road from pulling the
+// cut down into the background.
+#define AUTO_THRESHOLD_PERMILLE      0   // e.g. 2: 0.2% of the ROI
+#define AUTO_THRESHOLD_MIN         140
+#define AUTO_THRESHOLD_MAX         250
+#define AUTO_THRESHOLD_VALLEY_BINS   2   // Valley search, histogram bins below the cut
+#define AUTO_THRESHOLD_SMOOTH_SHIFT  2   // Move 1/4 of the way per frame...
+#define AUTO_THRESHOLD_MAX_STEP      8   // ...but at most this many levels
+
 // ---------------------------------------------------------------------------
 // UART inter-camera link
 // ---------------------------------------------------------------------------
@@ -90,6 +158,71 @@
 #define TRACKER_MAX_MATCH_DIST     25   // Max px distance to match blob across frames
 #define TRACKER_CONFIRM_FRAMES      3   // Consecutive frames of agreement to confirm class
 
+// ---------------------------------------------------------------------------
+// Memory budget — checked at compile time by mem_budget.cpp against the
+// per-module peaks this configuration implies (build fails if exceeded)
+// ---------------------------------------------------------------------------
+#define DETECT_TASK_STACK        8192          // detect task stack, bytes
+#define MEM_BUDGET_PSRAM_BYTES   (4u * 1024u * 1024u)   // AI-Thinker: 4 MB PSRAM
+#define MEM_BUDGET_DRAM_BYTES    (96u * 1024u)  // Internal heap + .bss we may claim
+#define MEM_TELEMETRY_PERIOD     300           // Primary: frames between "MEM" samples (0 = off)
+
+// ---------------------------------------------------------------------------
+// Load shedding (load_shed.h) — per-frame deadline for the detect task.
+// A frame misses when detect or track runs over its budget, or when the
+// frame is older than LOAD_DEADLINE_US by the time its result is ready
+// (age at dequeue + detect + track). Quality steps down one level after
+// LOAD_SHED_MISS_FRAMES consecutive misses and back up one level after
+// LOAD_SHED_CALM_FRAMES frames under LOAD_SHED_CALM_PCT of every limit.
+// ---------------------------------------------------------------------------
+#define LOAD_DEADLINE_US        120000  // 3 sensor periods at 25 fps (0 = never shed)
+#define LOAD_BUDGET_DETECT_US    70000
+#define LOAD_BUDGET_TRACK_US      5000
+#define LOAD_SHED_MISS_FRAMES        3
+#define LOAD_SHED_CALM_FRAMES       50  // Doubled (up to 8x) after a quick relapse
+#define LOAD_SHED_CALM_PCT          70
+#define LOAD_SHED_ROI_PERCENT       60  // Central share of the ROI band kept when shrunk
+#define LOAD_SHED_MAX_BLOBS          4  // Largest blobs kept when the count is cut
+
+// ---------------------------------------------------------------------------
+// Exposure control (exposure_ctrl.h) — replaces the sensor's AEC/AGC, which
+// aims at the average scene brightness and so over-exposes headlights into
+// large bloomed blobs at night. The total exposure (AEC lines x (1 + gain))
+// steps down while the most clipped blob has more than
+// EXPOSURE_SAT_HIGH_PX saturated pixels or the bright share exceeds
+// EXPOSURE_BRIGHT_HIGH_PERMILLE, and up while every core is under
+// EXPOSURE_SAT_LOW_PX and the scene is dim; exposure time is used before
+// gain. Day mode hands the sensor back to its own AEC/AGC.
+//
+// Off by default: blooms shrink ~8x and near headlights range better
+// (camsim --sensor ctrl), but in dense street lighting the loop settles
+// at EXPOSURE_AEC_MIN and far headlights fall under brightness_threshold
+// (city coverage 99.6% -> 82.8%).
+// ---------------------------------------------------------------------------
+#define EXPOSURE_CTRL                  0   // 1 = take over at night (opt-in, see below)
+#define EXPOSURE_SAT_HIGH_PX         200   // Clipped pixels in one blob: too bright (SVGA)
+#define EXPOSURE_SAT_LOW_PX           12   // ... every blob under this: room to brighten
+#define EXPOSURE_BRIGHT_HIGH_PERMILLE 20   // Bright share of the ROI: too bright
+#define EXPOSURE_BRIGHT_LOW_PERMILLE   5
+#define EXPOSURE_STEP_DOWN_PCT        75   // Scale per step down (50% past 4x SAT_HIGH)
+#define EXPOSURE_STEP_UP_PCT         112
+#define EXPOSURE_SETTLE_FRAMES         2   // Frames skipped after a write (sensor latency)
+#define EXPOSURE_AEC_START           400   // Lines; first manual setting
+#define EXPOSURE_AEC_MIN             200   // Floor: below it distant lights fall under the threshold
+#define EXPOSURE_AEC_MAX            1200   // OV2640 limit
+#define EXPOSURE_GAIN_MAX              1   // AGC index (2x): more gain is mostly noise
+
+// ---------------------------------------------------------------------------
+// Fast boot — set by the primary_fast / secondary_fast envs. Drops the serial
+// settle delay and the startup banner so detection starts as soon as the
+// camera is up; platformio.ini pairs it with sdkconfig overrides (no PSRAM
+// memtest, quiet bootloader). The primary logs time to first detection
+// either way.
+// ---------------------------------------------------------------------------
+#ifndef CAMTEST_FAST_BOOT
+#define CAMTEST_FAST_BOOT  0
+#endif
+
 // ---------------------------------------------------------------------------
 // Future work (NOT implemented):
 //   - Correlate blob inter-frame motion with accelerometer / hall-effect wheel
@@ -0,0 +1,101 @@
+#include "config_cmd.h"
+#include <string.h>
+
+static uint8_t frame_xor(const uint8_t *buf)
+{
+    uint8_t x = 0;
+    for (int i = 0; i < CONFIG_CMD_SIZE - 1; i++) x ^= buf[i];
+    return x;
+}
+
+size_t config_cmd_encode(uint8_t op, uint8_t param, uint32_t value,
+                         uint8_t out[CONFIG_CMD_SIZE])
+{
+    out[0] = CONFIG_CMD_SYNC;
+    out[1] = op;
+    out[2] = param;
+    out[3] = (uint8_t)(value >> 24);
+    out[4] = (uint8_t)(value >> 16);
+    out[5] = (uint8_t)(value >> 8);
+    out[6] = (uint8_t)value;
+    out[7] = frame_xor(out);
+    return CONFIG_CMD_SIZE;
+}
+
+void config_cmd_parser_reset(config_cmd_parser_t *p)
+{
+    p->len = 0;
+}
+
+config_cmd_status_t config_cmd_parser_feed(config_cmd_parser_t *p, uint8_t byte,
+                                           config_cmd_t *out)
+{
+    if (p->len == 0) {
+        if (byte == CONFIG_CMD_SYNC) p->buf[p->len++] = byte;
+        return CONFIG_CMD_NONE;
+    }
+
+    p->buf[p->len++] = byte;
+    if (p->len < CONFIG_CMD_SIZE) return CONFIG_CMD_NONE;
+    p->len = 0;
+
+    if (frame_xor(p->buf) != p->buf[CONFIG_CMD_SIZE - 1]) {
+        // Resync on the first sync byte after the one we locked onto
+        for (int i = 1; i < CONFIG_CMD_SIZE; i++) {
+            if (p->buf[i] != CONFIG_CMD_SYNC) continue;
+            p->len = CONFIG_CMD_SIZE - i;
+            memmove(p->buf, &p->buf[i], (size_t)p->len);
+            break;
+        }
+        return CONFIG_CMD_CORRUPT;
+    }
+
+    out->op    = p->buf[1];
+    out->param = p->buf[2];
+    out->value = (uint32_t)p->buf[3] << 24 | (uint32_t)p->buf[4] << 16 |
+                 (uint32_t)p->buf[5] << 8  | p->buf[6];
+    return CONFIG_CMD_FRAME;
+}
+
+config_cmd_action_t config_cmd_execute(const config_cmd_t *cmd, runtime_config_t *staged,
+                                       uint8_t reply[CONFIG_CMD_SIZE])
+{
+    uint8_t  ack = (uint8_t)(cmd->op | CONFIG_CMD_REPLY);
+    uint32_t value = 0;
+    config_cmd_action_t action = CONFIG_CMD_ACTION_NONE;
+
+    switch (cmd->op) {
+        case CONFIG_CMD_GET:
+            if (!runtime_config_get(staged, cmd->param, &value)) {
+                config_cmd_encode(CONFIG_CMD_NAK, CONFIG_CMD_ERR_PARAM, cmd->param, reply);
+                return action;
+            }
+            break;
+        case CONFIG_CMD_SET: {
+            esp_err_t err = runtime_config_set(staged, cmd->param, cmd->value);
+            if (err != ESP_OK) {
+                uint8_t code = err == ESP_ERR_NOT_FOUND ? CONFIG_CMD_ERR_PARAM
+                                                        : CONFIG_CMD_ERR_RANGE;
+                config_cmd_encode(CONFIG_CMD_NAK, code, cmd->param, reply);
+                return action;
+            }
+            runtime_config_get(staged, cmd->param, &value);
+            break;
+        }
+        case CONFIG_CMD_APPLY:
+            action = CONFIG_CMD_ACTION_APPLY;
+            break;
+        case CONFIG_CMD_SAVE:
+            action = CONFIG_CMD_ACTION_SAVE;
+            break;
+        case CONFIG_CMD_DEFAULTS:
+            runtime_config_defaults(staged);
+            break;
+        default:
+            config_cmd_encode(CONFIG_CMD_NAK, CONFIG_CMD_ERR_OPCODE, cmd->op, reply);
+            return action;
+    }
+
+    config_cmd_encode(ack, cmd->param, value, reply);
+    return action;
+}
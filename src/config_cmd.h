@@ -0,0 +1,98 @@
+#ifndef CONFIG_CMD_H
+#define CONFIG_CMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "runtime_config.h"
+
+// ---------------------------------------------------------------------------
+// Config command protocol: host -> camera on the debug UART (Serial RX)
+//
+// Fixed 8-byte frames, replies use the same layout:
+//   Byte 0:      0xC5  (sync)
+//   Byte 1:      opcode (reply: opcode | 0x80, or CONFIG_CMD_NAK)
+//   Byte 2:      parameter id (runtime_config_param_t; NAK: error code)
+//   Bytes 3..6:  value, big-endian uint32 (NAK: rejected parameter id / opcode)
+//   Byte 7:      XOR of bytes 0..6
+//
+// SET edits a staged copy; APPLY hands the staged copy to the detect task in
+// one piece (runtime_config_post()), so several SETs land on the same frame.
+// SAVE applies and writes it to NVS. GET reads the staged copy.
+//
+// On the primary, replies are interleaved with the text report on Serial
+// TX; a host tool scans for the sync byte and checks the XOR. The secondary
+// accepts commands but never replies: its Serial TX is the blob link (see
+// uart_link.h).
+// ---------------------------------------------------------------------------
+#define CONFIG_CMD_SYNC   0xC5
+#define CONFIG_CMD_SIZE   8
+#define CONFIG_CMD_REPLY  0x80   // OR-ed into the opcode of an ACK
+
+typedef enum {
+    CONFIG_CMD_GET      = 0x01,
+    CONFIG_CMD_SET      = 0x02,
+    CONFIG_CMD_APPLY    = 0x03,
+    CONFIG_CMD_SAVE     = 0x04,
+    CONFIG_CMD_DEFAULTS = 0x05,   // Reset the staged copy to config.h
+    CONFIG_CMD_NAK      = 0x7F,   // Reply only
+} config_cmd_op_t;
+
+typedef enum {
+    CONFIG_CMD_ERR_CHECKSUM = 1,
+    CONFIG_CMD_ERR_OPCODE   = 2,
+    CONFIG_CMD_ERR_PARAM    = 3,
+    CONFIG_CMD_ERR_RANGE    = 4,
+    CONFIG_CMD_ERR_STORAGE  = 5,   // SAVE: NVS write failed (config still applied)
+} config_cmd_err_t;
+
+typedef struct {
+    uint8_t  op;
+    uint8_t  param;
+    uint32_t value;
+} config_cmd_t;
+
+typedef enum {
+    CONFIG_CMD_NONE    = 0,   // Byte consumed, no frame complete yet
+    CONFIG_CMD_FRAME   = 1,   // A command was decoded
+    CONFIG_CMD_CORRUPT = 2,   // Bad checksum — frame dropped, resyncing
+} config_cmd_status_t;
+
+// What the caller must do after config_cmd_execute()
+typedef enum {
+    CONFIG_CMD_ACTION_NONE  = 0,
+    CONFIG_CMD_ACTION_APPLY = 1,   // runtime_config_post(staged)
+    CONFIG_CMD_ACTION_SAVE  = 2,   // runtime_config_save(staged), then post
+} config_cmd_action_t;
+
+typedef struct {
+    uint8_t buf[CONFIG_CMD_SIZE];
+    int     len;             // Bytes of the current frame (0 = hunting for sync)
+} config_cmd_parser_t;
+
+/** Build a frame. Returns CONFIG_CMD_SIZE. */
+size_t config_cmd_encode(uint8_t op, uint8_t param, uint32_t value,
+                         uint8_t out[CONFIG_CMD_SIZE]);
+
+/** Start hunting for a sync byte. Zero-initialisation is equivalent. */
+void config_cmd_parser_reset(config_cmd_parser_t *p);
+
+/** Feed one received byte. On CONFIG_CMD_FRAME, *out holds the command. */
+config_cmd_status_t config_cmd_parser_feed(config_cmd_parser_t *p, uint8_t byte,
+                                           config_cmd_t *out);
+
+/**
+ * Run a decoded command against the staged config and build the reply.
+ * Returns the follow-up the caller owes (it owns NVS and the hand-over).
+ */
+config_cmd_action_t config_cmd_execute(const config_cmd_t *cmd, runtime_config_t *staged,
+                                       uint8_t reply[CONFIG_CMD_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONFIG_CMD_H
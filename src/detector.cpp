@@ -1,17 +1,18 @@
 #include "detector.h"
 #include <string.h>
 #include "esp_heap_caps.h"
+#include "bitplane.h"
+#include "placement.h"
+#include "mem_telemetry.h"
+#include "runtime_config.h"
+#include "scene_stats.h"
 
 // ---------------------------------------------------------------------------
-// Union-Find for connected component labeling
+// Union-Find for connected component labeling (MAX_LABELS in config.h)
 // ---------------------------------------------------------------------------
-// Max labels we can track. VGA worst-case is thousands, but in practice
-// a thresholded night scene has very few bright regions.
-#define MAX_LABELS 512
+static HOT_DATA uint16_t parent[MAX_LABELS];
 
-static uint16_t parent[MAX_LABELS];
-
-static uint16_t uf_find(uint16_t x)
+static HOT_FN uint16_t uf_find(uint16_t x)
 {
     while (parent[x] != x) {
         parent[x] = parent[parent[x]]; // path compression
@@ -20,7 +21,7 @@ static uint16_t uf_find(uint16_t x)
     return x;
 }
 
-static void uf_union(uint16_t a, uint16_t b)
+static HOT_FN void uf_union(uint16_t a, uint16_t b)
 {
     a = uf_find(a);
     b = uf_find(b);
@@ -31,61 +32,145 @@ static void uf_union(uint16_t a, uint16_t b)
     }
 }
 
-// ---------------------------------------------------------------------------
-// Per-label accumulator for computing blob stats in the second pass
-// ---------------------------------------------------------------------------
-typedef struct {
-    uint32_t sum_x;
-    uint32_t sum_y;
-    uint32_t pixel_count;
-    uint32_t brightness_sum;
-} label_acc_t;
+static const detect_quality_t s_full_quality = DETECT_QUALITY_FULL;
+
+// ROI band [*y_start, *y_end) for a frame of the given height, trimmed
+// evenly top and bottom to q->roi_percent of the configured band
+static void roi_bounds(const runtime_config_t *cfg, const detect_quality_t *q, int height,
+                       int *y_start, int *y_end)
+{
+    *y_start = cfg->roi_y_start;
+    *y_end   = cfg->roi_y_end;
+    if (*y_end == 0 || *y_end > height) *y_end = height;
+    if (*y_start >= *y_end) *y_start = 0;
+    if (q->roi_percent < 100) {
+        int trim = (*y_end - *y_start) * (100 - q->roi_percent) / 200;
+        *y_start += trim;
+        *y_end   -= trim;
+    }
+}
+
+static void collect_blobs(const runtime_config_t *cfg, const detect_quality_t *q,
+                          const label_acc_t *accs, int num_labels, int height,
+                          detection_result_t *result);
 
 // ---------------------------------------------------------------------------
-// Blob detection — two-pass connected component labeling
+// Blob detection — dispatch on the configured labelling path
 // ---------------------------------------------------------------------------
 void detect_blobs(const uint8_t *pixels, int width, int height,
                   detection_result_t *result)
 {
-    memset(result, 0, sizeof(*result));
+    detect_blobs_degraded(pixels, width, height, &s_full_quality, result);
+}
 
-    // Determine ROI bounds
-    int y_start = ROI_Y_START;
-    int y_end   = ROI_Y_END;
-    if (y_end == 0 || y_end > height) y_end = height;
-    if (y_start >= y_end) y_start = 0;
+static void labelmap_detect(const uint8_t *pixels, int width, int height,
+                            const detect_quality_t *q, const scene_stats_t *st,
+                            detection_result_t *result, bool generic);
+static void bitplane_detect(const uint8_t *pixels, int width, int height,
+                            const detect_quality_t *q, const scene_stats_t *st,
+                            detection_result_t *result);
+
+// Scene statistics over the ROI band the frame is labelled in (scene_stats.h);
+// st->threshold is the threshold the frame is labelled at
+static void sample_scene(const runtime_config_t *cfg, const detect_quality_t *q,
+                         const uint8_t *pixels, int width, int height, scene_stats_t *st)
+{
+    int y_start, y_end;
+    roi_bounds(cfg, q, height, &y_start, &y_end);
+    scene_stats_sample(pixels, width, y_start, y_end, SCENE_SAMPLE_STEP_X, SCENE_SAMPLE_STEP_Y,
+                       q->threshold ? q->threshold : cfg->brightness_threshold, st);
+}
 
-    int roi_height = y_end - y_start;
-    int roi_pixels = width * roi_height;
+// Zeroed result carrying the frame's scene statistics
+static void result_begin(detection_result_t *result, const scene_stats_t *st)
+{
+    memset(result, 0, sizeof(*result));
+    result->scene            = *st;
+    result->scene_brightness = st->mean;
+}
 
-    // Allocate label map in PSRAM (2 bytes per pixel)
-    // For VGA: 640*480*2 = 614,400 bytes — fits easily in 4MB PSRAM
-    uint16_t *labels = (uint16_t *)heap_caps_calloc(roi_pixels, sizeof(uint16_t),
-                                                     MALLOC_CAP_SPIRAM);
-    if (!labels) {
-        // Fallback to regular malloc if PSRAM unavailable
-        labels = (uint16_t *)calloc(roi_pixels, sizeof(uint16_t));
-        if (!labels) return; // Out of memory
+// Day-mode bypass: washed out by mean or by bright share
+static bool is_daylight(const scene_stats_t *st)
+{
+    return st->samples != 0 &&
+           (st->mean >= DAY_MEAN_MIN || st->bright_permille >= DAY_BRIGHT_PERMILLE);
+}
+
+void detect_blobs_degraded(const uint8_t *pixels, int width, int height,
+                           const detect_quality_t *q, detection_result_t *result)
+{
+    scene_stats_t st;
+    sample_scene(runtime_config_active(), q, pixels, width, height, &st);
+    if (is_daylight(&st)) {
+        result_begin(result, &st);
+        result->status = DETECT_STATUS_DAYLIGHT;
+        return;
     }
+#if DETECTOR_BITPLANE
+    bitplane_detect(pixels, width, height, q, &st, result);
+#else
+    labelmap_detect(pixels, width, height, q, &st, result, false);
+#endif
+}
 
-    // Initialize union-find
-    for (int i = 0; i < MAX_LABELS; i++) parent[i] = i;
-    uint16_t next_label = 1; // Label 0 = background
+// ---------------------------------------------------------------------------
+// Label-map path — two-pass connected component labeling
+// ---------------------------------------------------------------------------
+// The map starts with 8-bit labels (1 byte per ROI pixel), which covers the
+// few dozen provisional labels of a typical night frame at half the PSRAM
+// traffic. A frame that needs label 256 is promoted mid-scan: the rows
+// labelled so far are widened into a 16-bit map and the scan resumes at the
+// row that overflowed, so the result is the same as a 16-bit-only scan.
+//
+// This path only runs with DETECTOR_BITPLANE 0; the default bitplane path
+// has no label map. The label width halves this path's map, it does not
+// make it competitive: SVGA night scenes on the host (camtest_bench) take
+// ~1.3-1.5 ms here against ~0.40-0.46 ms on the bitplane path.
 
-    // Compute scene brightness while we scan
-    uint64_t scene_sum = 0;
+typedef struct {
+    const uint8_t *pixels;
+    int            width;
+    int            y_start;      // Frame row of ROI row 0
+    int            roi_height;
+    uint8_t        threshold;    // Brightness threshold for this frame
+    uint16_t       next_label;   // Next free provisional label
+} labelmap_scan_t;
+
+// PASS 1 over ROI rows [ry0, roi_height): assign labels and merge neighbours.
+// With label_t = uint8_t, stops at the first row that needs label 256 and
+// returns that row with the scan state rolled back to its start; otherwise
+// returns roi_height.
+//
+// Provisional labels a label_t map can hand out: 256 for 8-bit (promotion
+// past that), but never more than parent[] holds. With MAX_LABELS < 256 the
+// 8-bit map never promotes and drops new blobs like the 16-bit map does.
+template <typename label_t>
+static inline uint16_t labelmap_label_limit(void)
+{
+    return sizeof(label_t) == 1 && MAX_LABELS > 256 ? 256 : MAX_LABELS;
+}
+
+// Generic kernel: runtime width, border tests on every bright pixel. Kept as
+// the reference for the specialised kernels below and for widths < 2.
+template <typename label_t, int CONN>
+static HOT_FN int labelmap_pass1_generic(labelmap_scan_t *sc, label_t *labels, int ry0)
+{
+    const uint16_t label_limit = labelmap_label_limit<label_t>();
+    const uint8_t *pixels = sc->pixels;
+    const int width = sc->width;
+    uint16_t next_label = sc->next_label;
+
+    for (int ry = ry0; ry < sc->roi_height; ry++) {
+        int frame_y = ry + sc->y_start;
+        uint16_t row_first_label = next_label;
 
-    // --- PASS 1: Assign labels and merge neighbors ---
-    for (int ry = 0; ry < roi_height; ry++) {
-        int frame_y = ry + y_start;
         for (int x = 0; x < width; x++) {
             int fi = frame_y * width + x;   // Index into frame
             int ri = ry * width + x;        // Index into ROI/label map
 
             uint8_t pix = pixels[fi];
-            scene_sum += pix;
 
-            if (pix < BRIGHTNESS_THRESHOLD) {
+            if (pix < sc->threshold) {
                 labels[ri] = 0; // Background
                 continue;
             }
@@ -96,6 +181,7 @@ void detect_blobs(const uint8_t *pixels, int width, int height,
             uint16_t above = (ry > 0)               ? labels[ri - width]     : 0;
             uint16_t a_l   = (ry > 0 && x > 0)     ? labels[ri - width - 1] : 0;
             uint16_t a_r   = (ry > 0 && x < width-1)? labels[ri - width + 1] : 0;
+            if (CONN == 4) a_l = a_r = 0;
 
             // Collect all non-zero neighbor labels
             uint16_t neighbors[4] = { left, above, a_l, a_r };
@@ -109,13 +195,19 @@ void detect_blobs(const uint8_t *pixels, int width, int height,
 
             if (min_lbl == 0) {
                 // New blob
-                if (next_label < MAX_LABELS) {
-                    labels[ri] = next_label++;
+                if (next_label < label_limit) {
+                    labels[ri] = (label_t)next_label++;
+                } else if (label_limit < MAX_LABELS) {
+                    // Out of 8-bit labels: undo this row's new labels (they
+                    // only ever became union children) and hand over
+                    for (int i = row_first_label; i < next_label; i++) parent[i] = i;
+                    sc->next_label = row_first_label;
+                    return ry;
                 } else {
                     labels[ri] = 0; // Too many labels, skip
                 }
             } else {
-                labels[ri] = min_lbl;
+                labels[ri] = (label_t)min_lbl;
                 // Union all neighbor labels together
                 for (int k = 0; k < 4; k++) {
                     if (neighbors[k] != 0 && neighbors[k] != min_lbl) {
@@ -124,54 +216,443 @@ void detect_blobs(const uint8_t *pixels, int width, int height,
                 }
             }
         }
+        sc->next_label = next_label;
+    }
+    return sc->roi_height;
+}
+
+// ---------------------------------------------------------------------------
+// Specialised PASS 1 kernels
+// ---------------------------------------------------------------------------
+// Same labels as the generic kernel, with the border tests peeled out: the
+// first ROI row, first column and last column get their own instantiations
+// of label_pixel(), so the interior loop reads all four neighbours
+// unconditionally. WIDTH != 0 makes the row length (and every neighbour
+// offset) a compile-time constant; CONN is 4 or 8; THR is a threshold
+// policy with get().
+//
+// Like the rest of the label-map path these only run with
+// DETECTOR_BITPLANE 0; the default path's run labeller is untouched apart
+// from honouring DETECTOR_CONNECTIVITY.
+
+// Threshold from the runtime config, fixed for the frame
+struct threshold_value {
+    uint8_t t;
+    uint8_t get() const { return t; }
+};
+
+// Label one bright pixel at lp. Returns false when a new label is needed but
+// label_limit is reached in 8-bit mode (caller rolls back and promotes).
+template <typename label_t, int CONN, bool TOP, bool LEFT, bool RIGHT>
+static inline __attribute__((always_inline)) bool
+label_pixel(label_t *lp, int width, uint16_t *next_label, uint16_t label_limit)
+{
+    uint16_t left  = LEFT                               ? 0 : lp[-1];
+    uint16_t above = TOP                                ? 0 : lp[-width];
+    uint16_t a_l   = (TOP || LEFT  || CONN == 4)        ? 0 : lp[-width - 1];
+    uint16_t a_r   = (TOP || RIGHT || CONN == 4)        ? 0 : lp[-width + 1];
+
+    uint16_t neighbors[4] = { left, above, a_l, a_r };
+    uint16_t min_lbl = 0;
+    for (int k = 0; k < 4; k++) {
+        if (neighbors[k] != 0 && (min_lbl == 0 || neighbors[k] < min_lbl))
+            min_lbl = neighbors[k];
+    }
+
+    if (min_lbl == 0) {
+        if (*next_label < label_limit) {
+            *lp = (label_t)(*next_label)++;
+        } else if (label_limit < MAX_LABELS) {
+            return false;
+        } else {
+            *lp = 0; // Too many labels, skip
+        }
+    } else {
+        *lp = (label_t)min_lbl;
+        for (int k = 0; k < 4; k++) {
+            if (neighbors[k] != 0 && neighbors[k] != min_lbl) uf_union(min_lbl, neighbors[k]);
+        }
     }
+    return true;
+}
 
-    // Scene brightness
-    uint32_t total_roi_pixels = (uint32_t)roi_pixels;
-    result->scene_brightness = (uint32_t)(scene_sum / total_roi_pixels);
+// One row; needs width >= 2. Returns false on 8-bit label exhaustion.
+template <typename label_t, int WIDTH, int CONN, typename THR, bool TOP>
+static inline __attribute__((always_inline)) bool
+label_row(const uint8_t *prow, label_t *lrow, int width, THR thr,
+          uint16_t *next_label, uint16_t label_limit)
+{
+    const int w = WIDTH ? WIDTH : width;
+    const uint8_t t = thr.get();
 
-    // --- PASS 2: Resolve labels and accumulate stats ---
-    // We only need accumulators for labels that actually exist
-    int num_labels = (next_label < MAX_LABELS) ? next_label : MAX_LABELS;
+    // Background pixels are not stored: the map comes zeroed from calloc and
+    // every pixel is visited once per map
+    if (prow[0] >= t &&
+        !label_pixel<label_t, CONN, TOP, true, false>(&lrow[0], w, next_label, label_limit)) return false;
 
-    label_acc_t *accs = (label_acc_t *)heap_caps_calloc(num_labels, sizeof(label_acc_t),
-                                                         MALLOC_CAP_SPIRAM);
-    if (!accs) {
-        accs = (label_acc_t *)calloc(num_labels, sizeof(label_acc_t));
-        if (!accs) {
-            heap_caps_free(labels);
-            return;
+    for (int x = 1; x < w - 1; x++) {
+        if (prow[x] < t) continue;
+        if (!label_pixel<label_t, CONN, TOP, false, false>(&lrow[x], w, next_label, label_limit)) return false;
+    }
+
+    if (prow[w - 1] >= t &&
+        !label_pixel<label_t, CONN, TOP, false, true>(&lrow[w - 1], w, next_label, label_limit)) return false;
+
+    return true;
+}
+
+template <typename label_t, int WIDTH, int CONN, typename THR>
+static HOT_FN int labelmap_pass1(labelmap_scan_t *sc, label_t *labels, int ry0, THR thr)
+{
+    const uint16_t label_limit = labelmap_label_limit<label_t>();
+    const int w = WIDTH ? WIDTH : sc->width;
+    uint16_t next_label = sc->next_label;
+
+    for (int ry = ry0; ry < sc->roi_height; ry++) {
+        const uint8_t *prow = &sc->pixels[(size_t)(ry + sc->y_start) * w];
+        label_t *lrow = &labels[(size_t)ry * w];
+        uint16_t row_first_label = next_label;
+
+        bool ok = ry == 0
+            ? label_row<label_t, WIDTH, CONN, THR, true >(prow, lrow, w, thr, &next_label, label_limit)
+            : label_row<label_t, WIDTH, CONN, THR, false>(prow, lrow, w, thr, &next_label, label_limit);
+        if (!ok) {
+            // Out of 8-bit labels: undo this row's new labels and hand over
+            for (int i = row_first_label; i < next_label; i++) parent[i] = i;
+            sc->next_label = row_first_label;
+            return ry;
         }
+        sc->next_label = next_label;
     }
+    return sc->roi_height;
+}
+
+// Pick the kernel for this frame: a constant-width instantiation for the
+// configured sensor width, a runtime-width peeled kernel otherwise. Each
+// instantiation is another copy in IRAM under CAMTEST_HOT_IRAM, so only
+// FRAME_WIDTH is specialised.
+template <typename label_t>
+static int labelmap_pass1_dispatch(labelmap_scan_t *sc, label_t *labels, int ry0, bool generic)
+{
+    threshold_value thr = { sc->threshold };
+    if (generic || sc->width < 2) {
+        return labelmap_pass1_generic<label_t, DETECTOR_CONNECTIVITY>(sc, labels, ry0);
+    }
+    if (sc->width == FRAME_WIDTH) {
+        return labelmap_pass1<label_t, FRAME_WIDTH, DETECTOR_CONNECTIVITY>(sc, labels, ry0, thr);
+    }
+    return labelmap_pass1<label_t, 0, DETECTOR_CONNECTIVITY>(sc, labels, ry0, thr);
+}
 
-    for (int ry = 0; ry < roi_height; ry++) {
-        int frame_y = ry + y_start;
+// PASS 2: resolve labels and accumulate stats into accs[root]
+template <typename label_t>
+static HOT_FN void labelmap_pass2(const labelmap_scan_t *sc, const label_t *labels,
+                                  label_acc_t *accs)
+{
+    const int width = sc->width;
+    for (int ry = 0; ry < sc->roi_height; ry++) {
+        int frame_y = ry + sc->y_start;
         for (int x = 0; x < width; x++) {
             int ri = ry * width + x;
             uint16_t lbl = labels[ri];
             if (lbl == 0) continue;
 
             uint16_t root = uf_find(lbl);
-            uint8_t pix = pixels[frame_y * width + x];
+            uint8_t pix = sc->pixels[frame_y * width + x];
 
             accs[root].sum_x          += x;
             accs[root].sum_y          += (frame_y);
             accs[root].pixel_count    += 1;
             accs[root].brightness_sum += pix;
+            accs[root].saturated      += pix >= SATURATION_LEVEL;
         }
     }
+}
+
+// Label maps live in PSRAM; fall back to the C heap without it
+static void *labelmap_alloc(size_t n, size_t size)
+{
+    return mem_frame_alloc(n, size, MALLOC_CAP_SPIRAM, true);
+}
+
+static HOT_FN void labelmap_detect(const uint8_t *pixels, int width, int height,
+                                   const detect_quality_t *q, const scene_stats_t *st,
+                                   detection_result_t *result, bool generic)
+{
+    result_begin(result, st);
+    if (width <= 0 || height <= 0) return;  // Nothing to scan (and no /0 below)
+
+    // Determine ROI bounds
+    const runtime_config_t *cfg = runtime_config_active();
+    int y_start, y_end;
+    roi_bounds(cfg, q, height, &y_start, &y_end);
+
+    int roi_height = y_end - y_start;
+    int roi_pixels = width * roi_height;
+
+    // Initialize union-find
+    for (int i = 0; i < MAX_LABELS; i++) parent[i] = i;
+
+    labelmap_scan_t sc;
+    sc.pixels     = pixels;
+    sc.width      = width;
+    sc.y_start    = y_start;
+    sc.roi_height = roi_height;
+    sc.threshold  = st->threshold;
+    sc.next_label = 1; // Label 0 = background
+
+    // --- PASS 1 in 8-bit labels, promoting to 16-bit if the frame needs it ---
+    // SVGA: 480,000 bytes (8-bit) or 960,000 bytes (16-bit) of PSRAM
+    uint8_t  *labels8  = (uint8_t *)labelmap_alloc(roi_pixels, sizeof(uint8_t));
+    uint16_t *labels16 = NULL;
+    if (!labels8) return; // Out of memory
+
+    int stop = labelmap_pass1_dispatch<uint8_t>(&sc, labels8, 0, generic);
+    if (stop < roi_height) {
+        labels16 = (uint16_t *)labelmap_alloc(roi_pixels, sizeof(uint16_t));
+        if (!labels16) {
+            mem_frame_free(labels8);
+            return;
+        }
+        for (int i = 0; i < stop * width; i++) labels16[i] = labels8[i];
+        mem_frame_free(labels8);
+        labels8 = NULL;
+        result->label_promotions = 1;
+        labelmap_pass1_dispatch<uint16_t>(&sc, labels16, stop, generic);
+    }
+    result->label_bits = labels16 ? 16 : 8;
+
+    // --- PASS 2: Resolve labels and accumulate stats ---
+    // We only need accumulators for labels that actually exist
+    int num_labels = (sc.next_label < MAX_LABELS) ? sc.next_label : MAX_LABELS;
+
+    // Randomly indexed for every labelled pixel — internal DRAM when
+    // CAMTEST_HOT_IRAM is set (at most MAX_LABELS * sizeof(label_acc_t))
+    label_acc_t *accs = (label_acc_t *)mem_frame_alloc(num_labels, sizeof(label_acc_t),
+                                                       HOT_HEAP_CAPS, true);
+    if (!accs) {
+        mem_frame_free(labels16 ? (void *)labels16 : (void *)labels8);
+        return;
+    }
+
+    if (labels16) labelmap_pass2<uint16_t>(&sc, labels16, accs);
+    else          labelmap_pass2<uint8_t>(&sc, labels8, accs);
 
     // Free label map — no longer needed
-    heap_caps_free(labels);
+    mem_frame_free(labels16 ? (void *)labels16 : (void *)labels8);
+
+    collect_blobs(cfg, q, accs, num_labels, height, result);
+    mem_frame_free(accs);
+}
+
+void detect_blobs_labelmap(const uint8_t *pixels, int width, int height,
+                           detection_result_t *result)
+{
+    detect_blobs_labelmap_q(pixels, width, height, &s_full_quality, result);
+}
+
+void detect_blobs_labelmap_q(const uint8_t *pixels, int width, int height,
+                             const detect_quality_t *q, detection_result_t *result)
+{
+    scene_stats_t st;
+    sample_scene(runtime_config_active(), q, pixels, width, height, &st);
+    labelmap_detect(pixels, width, height, q, &st, result, false);
+}
+
+void detect_blobs_labelmap_generic(const uint8_t *pixels, int width, int height,
+                                   detection_result_t *result)
+{
+    scene_stats_t st;
+    sample_scene(runtime_config_active(), &s_full_quality, pixels, width, height, &st);
+    labelmap_detect(pixels, width, height, &s_full_quality, &st, result, true);
+}
 
-    // --- Collect qualifying blobs sorted by size (largest first) ---
+// ---------------------------------------------------------------------------
+// Bitplane path — label runs of a packed threshold mask
+// ---------------------------------------------------------------------------
+// Runs on adjacent rows are connected when their x ranges overlap, or (with
+// 8-connectivity) touch diagonally. Stats are accumulated per run into the run's provisional label
+// and folded into the roots at the end, so there is no second pass over the
+// frame: the 8-bit pixels are only read for set bits (brightness sums and
+// clipped counts).
+#define RUN_DIAG  (DETECTOR_CONNECTIVITY == 8 ? 1 : 0)
+
+static HOT_FN void packed_detect(const bitplane_t *bp, const uint8_t *pixels, int height,
+                                 const detect_quality_t *q, const scene_stats_t *st,
+                                 detection_result_t *result)
+{
+    result_begin(result, st);
+    int width = bp->width;
+    if (width <= 0 || bp->height <= 0) return;
+
+    // Run buffers for the previous and current row, with their labels
+    int max_runs = (width + 1) / 2;
+    size_t run_bytes = (size_t)max_runs * (sizeof(bitplane_run_t) + sizeof(uint16_t));
+    uint8_t *scratch = (uint8_t *)mem_frame_alloc(2, run_bytes, HOT_HEAP_CAPS, false);
+    if (!scratch) return;
+    bitplane_run_t *prev = (bitplane_run_t *)scratch;
+    bitplane_run_t *cur  = prev + max_runs;
+    uint16_t *prev_lbl = (uint16_t *)(cur + max_runs);
+    uint16_t *cur_lbl  = prev_lbl + max_runs;
+
+    // Labels are only known after the scan, so size for the maximum. A label's
+    // accumulator and union-find slot are cleared when it is handed out, so a
+    // night frame with a handful of lights touches a handful of entries.
+    label_acc_t *accs = (label_acc_t *)mem_frame_alloc(MAX_LABELS, sizeof(label_acc_t),
+                                                       HOT_HEAP_CAPS, false);
+    if (!accs) {
+        mem_frame_free(scratch);
+        return;
+    }
+
+    uint16_t next_label = 1; // Label 0 = background / dropped run
+    int prev_n = 0;
+
+    for (int ry = 0; ry < bp->height; ry++) {
+        int frame_y = bp->y0 + ry * bp->ystep;
+        int cur_n = bitplane_row_runs(bitplane_row(bp, ry), width, cur);
+        const uint8_t *row = &pixels[(size_t)frame_y * width];
+
+        int j = 0;  // First previous-row run that can still touch a current run
+        for (int k = 0; k < cur_n; k++) {
+            int c0 = cur[k].x0;
+            int c1 = cur[k].x1;
+            while (j < prev_n && prev[j].x1 + RUN_DIAG <= c0) j++;
+
+            // Union every touching previous run; keep the first label
+            uint16_t lbl = 0;
+            for (int m = j; m < prev_n && prev[m].x0 < c1 + RUN_DIAG; m++) {
+                uint16_t pl = prev_lbl[m];
+                if (pl == 0) continue;
+                if (lbl == 0)       lbl = pl;
+                else if (pl != lbl) uf_union(lbl, pl);
+            }
+            if (lbl == 0) {
+                if (next_label >= MAX_LABELS) {
+                    cur_lbl[k] = 0; // Too many labels, skip
+                    continue;
+                }
+                lbl = next_label++;
+                parent[lbl] = lbl;
+                memset(&accs[lbl], 0, sizeof(accs[lbl]));
+            }
+            cur_lbl[k] = lbl;
+
+            uint32_t len = (uint32_t)(c1 - c0);
+            uint32_t bright = 0, sat = 0;
+            for (int x = c0; x < c1; x++) {
+                bright += row[x];
+                sat    += row[x] >= SATURATION_LEVEL;
+            }
+
+            label_acc_t *a = &accs[lbl];
+            a->sum_x          += (uint32_t)(c0 + c1 - 1) * len / 2;
+            a->sum_y          += (uint32_t)frame_y * len;
+            a->pixel_count    += len;
+            a->brightness_sum += bright;
+            a->saturated      += sat;
+        }
+
+        bitplane_run_t *tr = prev;  prev = cur;  cur = tr;
+        uint16_t *tl = prev_lbl;    prev_lbl = cur_lbl;  cur_lbl = tl;
+        prev_n = cur_n;
+    }
+    mem_frame_free(scratch);
+
+    // Decimated plane: each packed row stands for ystep source rows
+    int num_labels = next_label;
+    if (bp->ystep > 1) {
+        uint32_t k = (uint32_t)bp->ystep;
+        for (int i = 1; i < num_labels; i++) {
+            accs[i].sum_x          *= k;
+            accs[i].sum_y          *= k;
+            accs[i].pixel_count    *= k;
+            accs[i].brightness_sum *= k;
+            accs[i].saturated      *= k;
+        }
+    }
+
+    // Fold every provisional label into its root
+    for (int i = 1; i < num_labels; i++) {
+        uint16_t root = uf_find((uint16_t)i);
+        if (root == i) continue;
+        accs[root].sum_x          += accs[i].sum_x;
+        accs[root].sum_y          += accs[i].sum_y;
+        accs[root].pixel_count    += accs[i].pixel_count;
+        accs[root].brightness_sum += accs[i].brightness_sum;
+        accs[root].saturated      += accs[i].saturated;
+    }
+
+    collect_blobs(runtime_config_active(), q, accs, num_labels, height, result);
+    mem_frame_free(accs);
+}
+
+void detect_blobs_packed(const bitplane_t *bp, const uint8_t *pixels, int height,
+                         detection_result_t *result)
+{
+    detect_blobs_packed_q(bp, pixels, height, &s_full_quality, result);
+}
+
+void detect_blobs_packed_q(const bitplane_t *bp, const uint8_t *pixels, int height,
+                           const detect_quality_t *q, detection_result_t *result)
+{
+    // Sample the source rows the plane was packed from
+    int y_end = bp->height > 0 ? bp->y0 + (bp->height - 1) * bp->ystep + 1 : bp->y0;
+    scene_stats_t st;
+    scene_stats_sample(pixels, bp->width, bp->y0, y_end, SCENE_SAMPLE_STEP_X, SCENE_SAMPLE_STEP_Y,
+                       bp->threshold, &st);
+    packed_detect(bp, pixels, height, q, &st, result);
+}
+
+void detect_blobs_bitplane(const uint8_t *pixels, int width, int height,
+                           detection_result_t *result)
+{
+    detect_blobs_bitplane_q(pixels, width, height, &s_full_quality, result);
+}
+
+void detect_blobs_bitplane_q(const uint8_t *pixels, int width, int height,
+                             const detect_quality_t *q, detection_result_t *result)
+{
+    scene_stats_t st;
+    sample_scene(runtime_config_active(), q, pixels, width, height, &st);
+    bitplane_detect(pixels, width, height, q, &st, result);
+}
+
+static void bitplane_detect(const uint8_t *pixels, int width, int height,
+                            const detect_quality_t *q, const scene_stats_t *st,
+                            detection_result_t *result)
+{
+    result_begin(result, st);
+    if (width <= 0 || height <= 0) return;
+
+    const runtime_config_t *cfg = runtime_config_active();
+    int y_start, y_end;
+    roi_bounds(cfg, q, height, &y_start, &y_end);
+    int step = q->row_step > 1 ? q->row_step : 1;
+
+    bitplane_t bp;
+    int rows = (y_end - y_start + step - 1) / step;
+    if (!bitplane_alloc(&bp, width, rows)) return; // Out of memory
+    bitplane_pack_step(&bp, pixels, y_start, step, st->threshold);
+    packed_detect(&bp, pixels, height, q, st, result);
+    bitplane_free(&bp);
+}
+
+// ---------------------------------------------------------------------------
+// Collect qualifying root labels into result, sorted by size (largest first),
+// then merge nearby blobs. Roots are the labels with parent[i] == i.
+// ---------------------------------------------------------------------------
+static void collect_blobs(const runtime_config_t *cfg, const detect_quality_t *q,
+                          const label_acc_t *accs, int num_labels, int height,
+                          detection_result_t *result)
+{
     result->blob_count = 0;
 
     for (int i = 1; i < num_labels; i++) {
         if (parent[i] != i) continue; // Not a root label
-        label_acc_t *a = &accs[i];
-        if (a->pixel_count < MIN_BLOB_PIXELS)  continue;
-        if (a->pixel_count > MAX_BLOB_PIXELS)  continue;
+        const label_acc_t *a = &accs[i];
+        if (a->pixel_count < cfg->min_blob_pixels)  continue;
+        if (a->pixel_count > cfg->max_blob_pixels)  continue;
 
         if (result->blob_count < MAX_BLOBS) {
             uint16_t cx = (uint16_t)(a->sum_x / a->pixel_count);
@@ -186,6 +667,7 @@ void detect_blobs(const uint8_t *pixels, int width, int height,
             b->cy             = cy;
             b->pixel_count    = a->pixel_count;
             b->brightness_sum = a->brightness_sum;
+            b->saturated      = a->saturated;
             result->blob_count++;
         }
     }
@@ -203,14 +685,14 @@ void detect_blobs(const uint8_t *pixels, int width, int height,
 
     // --- Merge nearby blobs ---
     // Phone flashlights often have 2 LED dies that produce separate blobs.
-    // Merge any pair whose centroids are within BLOB_MERGE_DIST pixels.
-    for (int i = 0; i < result->blob_count; i++) {
+    // Merge any pair whose centroids are within blob_merge_dist pixels.
+    for (int i = 0; q->merge && i < result->blob_count; i++) {
         for (int j = i + 1; j < result->blob_count; ) {
             int dx = (int)result->blobs[i].cx - (int)result->blobs[j].cx;
             int dy = (int)result->blobs[i].cy - (int)result->blobs[j].cy;
             int dist = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
 
-            if (dist <= BLOB_MERGE_DIST) {
+            if (dist <= cfg->blob_merge_dist) {
                 // Weighted-average centroid merge into blob i
                 uint32_t total_pc = result->blobs[i].pixel_count +
                                     result->blobs[j].pixel_count;
@@ -223,6 +705,7 @@ void detect_blobs(const uint8_t *pixels, int width, int height,
                      (uint32_t)result->blobs[j].cy * result->blobs[j].pixel_count)
                     / total_pc);
                 result->blobs[i].brightness_sum += result->blobs[j].brightness_sum;
+                result->blobs[i].saturated      += result->blobs[j].saturated;
                 result->blobs[i].pixel_count = total_pc;
 
                 // Remove blob j by shifting remaining blobs down
@@ -237,7 +720,8 @@ void detect_blobs(const uint8_t *pixels, int width, int height,
         }
     }
 
-    heap_caps_free(accs);
+    // Under load, only the largest blobs go on to tracking and the link
+    if (result->blob_count > q->max_blobs) result->blob_count = q->max_blobs;
 }
 
 // ---------------------------------------------------------------------------
@@ -249,8 +733,10 @@ void tracker_reset(tracker_state_t *state)
     memset(state, 0, sizeof(*state));
 }
 
-void tracker_classify(tracker_state_t *state, detection_result_t *result)
+HOT_FN void tracker_classify(tracker_state_t *state, detection_result_t *result)
 {
+    const runtime_config_t *cfg = runtime_config_active();
+
     // matched[j] prevents two current blobs matching the same previous blob
     bool matched[MAX_BLOBS];
     memset(matched, 0, sizeof(matched));
@@ -270,7 +756,7 @@ void tracker_classify(tracker_state_t *state, detection_result_t *result)
         // certainly reflections of our own headlight off the road surface.
         // Classify immediately — no voting needed, geometry is conclusive.
         if ((int)b->cy > (FRAME_HEIGHT * 3 / 4) &&
-            b->pixel_count > (uint32_t)(MAX_BLOB_PIXELS / 2)) {
+            b->pixel_count > cfg->max_blob_pixels / 2) {
             b->classification = BLOB_CLASS_STATIC_LIGHT;
             b->dx = 0;
             b->dy = 0;
@@ -301,7 +787,7 @@ void tracker_classify(tracker_state_t *state, detection_result_t *result)
             }
         }
 
-        if (best_j < 0 || best_dist > TRACKER_MAX_MATCH_DIST) {
+        if (best_j < 0 || best_dist > cfg->tracker_max_match_dist) {
             // New blob — no history
             b->classification = BLOB_CLASS_UNKNOWN;
             b->dx = 0;
@@ -321,16 +807,16 @@ void tracker_classify(tracker_state_t *state, detection_result_t *result)
         // (accelerometer / hall-effect wheel sensor) before classifying.
 
         blob_class_t raw_class;
-        if (motion <= TRACKER_STATIC_THRESHOLD) {
+        if (motion <= cfg->tracker_static_threshold) {
             raw_class = BLOB_CLASS_STATIC_LIGHT;
-        } else if (motion >= TRACKER_VEHICLE_THRESHOLD) {
+        } else if (motion >= cfg->tracker_vehicle_threshold) {
             raw_class = BLOB_CLASS_VEHICLE;
         } else {
             raw_class = BLOB_CLASS_UNKNOWN;
         }
 
         // --- N-frame hysteresis ---
-        // Only update confirmed_class after TRACKER_CONFIRM_FRAMES consecutive
+        // Only update confirmed_class after tracker_confirm_frames consecutive
         // frames agreeing on the same raw_class.
         if (raw_class == state->pending_class[best_j]) {
             if (state->vote_count[best_j] < 255) {
@@ -342,7 +828,7 @@ void tracker_classify(tracker_state_t *state, detection_result_t *result)
             state->vote_count[best_j]    = 1;
         }
 
-        if (state->vote_count[best_j] >= TRACKER_CONFIRM_FRAMES) {
+        if (state->vote_count[best_j] >= cfg->tracker_confirm_frames) {
             state->confirmed_class[best_j] = state->pending_class[best_j];
         }
 
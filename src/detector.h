@@ -8,6 +8,8 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h>
 #include "config.h"
+#include "bitplane.h"
+#include "scene_stats.h"
 
 // ---------------------------------------------------------------------------
 // Blob classification
@@ -26,6 +28,7 @@ typedef struct {
     uint16_t     cy;              // Centroid Y
     uint32_t     pixel_count;     // Number of bright pixels in this blob
     uint32_t     brightness_sum;  // Sum of pixel values (for computing average)
+    uint32_t     saturated;       // Pixels >= SATURATION_LEVEL (clipped core)
     blob_class_t classification;  // Filled in by tracker_classify()
     int16_t      dx;              // Inter-frame centroid delta X (set by tracker)
     int16_t      dy;              // Inter-frame centroid delta Y (set by tracker)
@@ -34,12 +37,49 @@ typedef struct {
 // ---------------------------------------------------------------------------
 // Detection result
 // ---------------------------------------------------------------------------
+typedef enum {
+    DETECT_STATUS_OK       = 0,
+    DETECT_STATUS_DAYLIGHT = 1,   // Washed out — not labelled, no blobs (not applicable)
+} detect_status_t;
+
 typedef struct {
     blob_t   blobs[MAX_BLOBS];
     int      blob_count;        // How many blobs found (up to MAX_BLOBS)
-    uint32_t scene_brightness;  // Average brightness of entire frame (0-255)
+    uint32_t scene_brightness;  // Average ROI brightness (0-255), = scene.mean
+    uint8_t  label_bits;        // Label-map width used: 8, 16, or 0 (bitplane path)
+    uint8_t  label_promotions;  // 8 -> 16-bit promotions during this frame
+    uint8_t  status;            // detect_status_t
+    scene_stats_t scene;        // Sparse ROI sample: mean, histogram, bright share
 } detection_result_t;
 
+// ---------------------------------------------------------------------------
+// Detection quality — what detect_blobs_degraded() may skip under load
+// (see load_shed.h), plus a per-frame threshold override.
+// DETECT_QUALITY_FULL is what detect_blobs() runs.
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint8_t roi_percent;   // Central share of the ROI band scanned (100 = all)
+    uint8_t row_step;      // Label every row_step-th ROI row (1 = all; bitplane path)
+    uint8_t merge;         // Merge nearby blobs (blob_merge_dist)
+    uint8_t max_blobs;     // Keep at most this many blobs, largest first
+    uint8_t threshold;     // Brightness threshold, 0 = brightness_threshold (auto_threshold.h)
+} detect_quality_t;
+
+#define DETECT_QUALITY_FULL  { 100, 1, 1, MAX_BLOBS, 0 }
+
+// ---------------------------------------------------------------------------
+// Per-label accumulator for blob stats, one per provisional label while a
+// frame is labelled. Internal to detector.cpp; here so mem_budget.cpp can
+// size the scratch with sizeof.
+// ---------------------------------------------------------------------------
+typedef struct {
+    uint32_t sum_x;
+    uint32_t sum_y;
+    uint32_t pixel_count;
+    uint32_t brightness_sum;
+    uint32_t saturated;
+} label_acc_t;
+
 // ---------------------------------------------------------------------------
 // Tracker state — persists between frames
 // Holds previous-frame centroids plus per-slot hysteresis vote counters.
@@ -48,7 +88,7 @@ typedef struct {
 typedef struct {
     uint16_t     cx[MAX_BLOBS];             // Previous-frame centroid X
     uint16_t     cy[MAX_BLOBS];             // Previous-frame centroid Y
-    blob_class_t confirmed_class[MAX_BLOBS];// Last classification that reached TRACKER_CONFIRM_FRAMES
+    blob_class_t confirmed_class[MAX_BLOBS];// Last classification that reached tracker_confirm_frames
     blob_class_t pending_class[MAX_BLOBS];  // Classification being voted on right now
     uint8_t      vote_count[MAX_BLOBS];     // Consecutive frames agreeing on pending_class
     int          count;                     // Number of valid slots from last frame
@@ -60,8 +100,13 @@ typedef struct {
 
 /**
  * Detect bright blobs in a grayscale frame.
+ * A sparse pre-pass skips labelling on washed-out (daylight) frames: status
+ * is DETECT_STATUS_DAYLIGHT, no blobs, and scene_brightness is the sampled
+ * mean.
  * classification / dx / dy fields in result are left zeroed (BLOB_CLASS_UNKNOWN).
  * Call tracker_classify() afterward to fill them in.
+ * Threshold, blob size limits, merge distance and ROI come from
+ * runtime_config_active(), read once per call.
  *
  * @param pixels  Raw grayscale pixel data (row-major, 1 byte per pixel)
  * @param width   Frame width  (use fb->width, not FRAME_WIDTH macro)
@@ -71,9 +116,62 @@ typedef struct {
 void detect_blobs(const uint8_t *pixels, int width, int height,
                   detection_result_t *result);
 
+/**
+ * detect_blobs() with parts of the work skipped as `q` allows. With row
+ * decimation every labelled row stands for row_step rows, so pixel counts
+ * stay comparable with full-quality frames. A nonzero q->threshold replaces
+ * brightness_threshold for this frame.
+ */
+void detect_blobs_degraded(const uint8_t *pixels, int width, int height,
+                           const detect_quality_t *q, detection_result_t *result);
+
+/**
+ * detect_blobs() implementations, callable directly for benchmarking and
+ * cross-checking. detect_blobs() uses the one selected by DETECTOR_BITPLANE.
+ *
+ *   labelmap  Two passes over a label map: 8-bit (1 byte per ROI pixel),
+ *             promoted to 16-bit mid-frame past 255 provisional labels.
+ *             Pass 1 runs a kernel specialised for FRAME_WIDTH with border
+ *             handling peeled out of the inner loop; _generic forces the
+ *             reference kernel (same output) for benchmarking.
+ *   bitplane  Packs the ROI into a 1-bit mask (bitplane.h) and labels runs
+ *             of set bits; one pass, pixels re-read only inside runs.
+ *
+ * Both give identical blobs unless a frame exhausts the provisional label
+ * table, where the run path (one label per run, not per fragment) drops less.
+ * The _q variants take a detect_quality_t; the label-map path ignores
+ * row_step.
+ */
+void detect_blobs_labelmap(const uint8_t *pixels, int width, int height,
+                           detection_result_t *result);
+void detect_blobs_labelmap_q(const uint8_t *pixels, int width, int height,
+                             const detect_quality_t *q, detection_result_t *result);
+void detect_blobs_labelmap_generic(const uint8_t *pixels, int width, int height,
+                                   detection_result_t *result);
+void detect_blobs_bitplane(const uint8_t *pixels, int width, int height,
+                           detection_result_t *result);
+void detect_blobs_bitplane_q(const uint8_t *pixels, int width, int height,
+                             const detect_quality_t *q, detection_result_t *result);
+
+/**
+ * Bitplane path on a mask the caller already packed (bitplane_pack() with
+ * the active brightness_threshold over the ROI rows), so other stages can
+ * share it.
+ *
+ * @param bp      Packed ROI; scene statistics are sampled from its source rows
+ * @param pixels  The full source frame (bp->width wide), for brightness sums
+ * @param height  Full frame height (for the edge-row rejection)
+ * @param result  Output, as detect_blobs()
+ */
+void detect_blobs_packed(const bitplane_t *bp, const uint8_t *pixels, int height,
+                         detection_result_t *result);
+void detect_blobs_packed_q(const bitplane_t *bp, const uint8_t *pixels, int height,
+                           const detect_quality_t *q, detection_result_t *result);
+
 /**
  * Match current blobs to previous frame, compute dx/dy, apply N-frame
  * hysteresis, and set the classification field on each blob.
+ * Thresholds come from runtime_config_active(), read once per call.
  * Updates state with current-frame centroids ready for the next call.
  *
  * @param state   Persistent tracker state (caller owns; zero-init before first call)
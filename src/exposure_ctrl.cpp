@@ -0,0 +1,76 @@
+#include "exposure_ctrl.h"
+#include <string.h>
+#include "config.h"
+
+#define LEVEL_MIN  ((uint32_t)EXPOSURE_AEC_MIN)
+#define LEVEL_MAX  ((uint32_t)EXPOSURE_AEC_MAX * (1 + EXPOSURE_GAIN_MAX))
+
+void exposure_ctrl_init(exposure_ctrl_t *x)
+{
+    memset(x, 0, sizeof(*x));
+    x->enabled = EXPOSURE_CTRL != 0;
+    x->level   = EXPOSURE_AEC_START;
+}
+
+void exposure_ctrl_split(uint32_t level, camera_exposure_t *out)
+{
+    if (level < LEVEL_MIN) level = LEVEL_MIN;
+    if (level > LEVEL_MAX) level = LEVEL_MAX;
+
+    // Least gain that keeps the exposure time within the sensor's limit
+    uint32_t gain = (level + EXPOSURE_AEC_MAX - 1) / EXPOSURE_AEC_MAX - 1;
+    out->manual    = 1;
+    out->gain      = (uint8_t)gain;
+    out->aec_lines = (uint16_t)(level / (1 + gain));
+}
+
+bool exposure_ctrl_update(exposure_ctrl_t *x, const detection_result_t *r, bool day_mode)
+{
+    x->changed = false;
+    if (!x->enabled) return false;
+
+    // Day: the sensor's AEC is built for that. Resume at the old level.
+    if (day_mode) {
+        if (!x->manual) return false;
+        x->manual = false;
+        memset(&x->out, 0, sizeof(x->out));
+        return x->changed = true;
+    }
+    if (r->status == DETECT_STATUS_DAYLIGHT) return false;
+    if (!x->manual) {
+        x->manual = true;
+        x->settle = EXPOSURE_SETTLE_FRAMES;
+        exposure_ctrl_split(x->level, &x->out);
+        return x->changed = true;
+    }
+    if (x->settle) {
+        x->settle--;
+        return false;
+    }
+
+    uint32_t worst = 0;
+    for (int i = 0; i < r->blob_count; i++) {
+        if (r->blobs[i].saturated > worst) worst = r->blobs[i].saturated;
+    }
+    x->worst_sat = worst;
+
+    uint32_t bright = r->scene.bright_permille;
+    uint32_t level  = x->level;
+    if (worst > EXPOSURE_SAT_HIGH_PX || bright > EXPOSURE_BRIGHT_HIGH_PERMILLE) {
+        // Far over (a bloomed light right after an empty road): halve
+        uint32_t pct = worst > 4 * EXPOSURE_SAT_HIGH_PX ? 50 : EXPOSURE_STEP_DOWN_PCT;
+        level = level * pct / 100;
+        if (level < LEVEL_MIN) level = LEVEL_MIN;
+    } else if (worst < EXPOSURE_SAT_LOW_PX && bright < EXPOSURE_BRIGHT_LOW_PERMILLE) {
+        level = level * EXPOSURE_STEP_UP_PCT / 100 + 1;
+        if (level > LEVEL_MAX) level = LEVEL_MAX;
+    }
+    if (level == x->level) return false;
+
+    if (level < x->level) x->steps_down++;
+    else                  x->steps_up++;
+    x->level  = level;
+    x->settle = EXPOSURE_SETTLE_FRAMES;
+    exposure_ctrl_split(level, &x->out);
+    return x->changed = true;
+}
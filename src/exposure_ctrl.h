@@ -0,0 +1,67 @@
+#ifndef EXPOSURE_CTRL_H
+#define EXPOSURE_CTRL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "camera.h"
+#include "detector.h"
+
+// ---------------------------------------------------------------------------
+// Exposure control — closed loop on the detector's own statistics
+//
+// The OV2640's AEC/AGC exposes for the average scene, which at night is
+// nearly black, so it runs to its ceiling and every headlight blooms into a
+// large clipped blob: pixel_count, labelling work and centroid error all
+// grow with it. This loop instead watches the clipped core of each blob
+// (blob_t.saturated) and the bright share of the ROI (scene_stats.h) and
+// keeps the brightest light just clipping (limits in config.h):
+//
+//   too bright  most clipped blob > EXPOSURE_SAT_HIGH_PX, or bright share
+//               > EXPOSURE_BRIGHT_HIGH_PERMILLE: step down
+//   too dim     every blob < EXPOSURE_SAT_LOW_PX and bright share
+//               < EXPOSURE_BRIGHT_LOW_PERMILLE (an empty road too): step up
+//
+// The level is one number, AEC lines x (1 + gain index), split into the
+// longest exposure time the sensor allows before any gain. After a write
+// the loop waits EXPOSURE_SETTLE_FRAMES frames for the sensor to latch it.
+// Washed-out frames are not judged; in day mode the sensor gets its own
+// AEC/AGC back, and manual control resumes at the old level on the first
+// night frame.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    bool     enabled;       // EXPOSURE_CTRL, cleared if the backend cannot set exposure
+    bool     manual;        // Controller owns the sensor (false: sensor AEC/AGC)
+    bool     changed;       // out changed on the last update
+    uint8_t  settle;        // Frames left before the next judgement
+    uint32_t level;         // AEC lines x (1 + gain)
+    uint32_t worst_sat;     // Last judged frame: most clipped pixels in one blob
+    camera_exposure_t out;  // Settings for camera_set_exposure()
+    uint32_t steps_down;    // Totals since exposure_ctrl_init()
+    uint32_t steps_up;
+    uint32_t write_errors;
+} exposure_ctrl_t;
+
+/** Start on the sensor's own AEC/AGC; the first night frame takes over. */
+void exposure_ctrl_init(exposure_ctrl_t *x);
+
+/**
+ * Account one detection result. Returns true when x->out changed and
+ * should be written with camera_set_exposure().
+ *
+ * @param day_mode  The pipeline is in day mode (pipeline.h)
+ */
+bool exposure_ctrl_update(exposure_ctrl_t *x, const detection_result_t *r, bool day_mode);
+
+/** AEC lines and gain index for a level (clamped to the configured range). */
+void exposure_ctrl_split(uint32_t level, camera_exposure_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EXPOSURE_CTRL_H
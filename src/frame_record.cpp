@@ -0,0 +1,250 @@
+#include "frame_record.h"
+#include <string.h>
+#include "bitplane.h"
+
+// ---------------------------------------------------------------------------
+// RLE — PackBits variant
+//   ctrl 0..127   : ctrl+1 literal bytes follow
+//   ctrl 128..255 : next byte repeats (ctrl - 125) times  (3..130)
+// ---------------------------------------------------------------------------
+#define RLE_MIN_RUN   3
+#define RLE_MAX_RUN   130
+#define RLE_MAX_LIT   128
+
+static size_t rle_encode(const uint8_t *src, size_t n, uint8_t *out)
+{
+    size_t o = 0;
+    size_t i = 0;
+    size_t lit_start = 0;
+
+    while (i < n) {
+        // Measure the run starting at i
+        size_t run = 1;
+        while (i + run < n && run < RLE_MAX_RUN && src[i + run] == src[i]) run++;
+
+        if (run >= RLE_MIN_RUN) {
+            // Flush pending literals, then the run
+            while (lit_start < i) {
+                size_t len = i - lit_start;
+                if (len > RLE_MAX_LIT) len = RLE_MAX_LIT;
+                out[o++] = (uint8_t)(len - 1);
+                memcpy(&out[o], &src[lit_start], len);
+                o += len;
+                lit_start += len;
+            }
+            out[o++] = (uint8_t)(run + 125);
+            out[o++] = src[i];
+            i += run;
+            lit_start = i;
+        } else {
+            i += run;
+        }
+    }
+    while (lit_start < n) {
+        size_t len = n - lit_start;
+        if (len > RLE_MAX_LIT) len = RLE_MAX_LIT;
+        out[o++] = (uint8_t)(len - 1);
+        memcpy(&out[o], &src[lit_start], len);
+        o += len;
+        lit_start += len;
+    }
+    return o;
+}
+
+static bool rle_decode(const uint8_t *src, size_t n, uint8_t *out, size_t out_n)
+{
+    size_t i = 0, o = 0;
+    while (i < n) {
+        uint8_t ctrl = src[i++];
+        if (ctrl < 128) {
+            size_t len = (size_t)ctrl + 1;
+            if (i + len > n || o + len > out_n) return false;
+            memcpy(&out[o], &src[i], len);
+            i += len;
+            o += len;
+        } else {
+            size_t len = (size_t)ctrl - 125;
+            if (i >= n || o + len > out_n) return false;
+            memset(&out[o], src[i++], len);
+            o += len;
+        }
+    }
+    return o == out_n;
+}
+
+// ---------------------------------------------------------------------------
+// BITPLANE
+//   row_map  : ceil(height/32) words, bit y set if row y has any stored pixel
+//   masks    : ceil(width/32) words for each set row, bit x = pixel stored
+//   values   : stored pixel values in raster order
+// Bits are LSB-first within each 32-bit word.
+// ---------------------------------------------------------------------------
+static inline uint32_t load_u32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store_u32(uint8_t *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static size_t bitplane_encode(const uint8_t *pixels, int width, int height,
+                              uint8_t threshold, uint8_t *fill_out, uint8_t *out)
+{
+    int words_w = (width + 31) / 32;
+    int words_h = (height + 31) / 32;
+
+    // Background mean becomes the fill value for every unstored pixel
+    uint64_t bg_sum = 0;
+    uint32_t bg_count = 0;
+    for (int i = 0; i < width * height; i++) {
+        if (pixels[i] < threshold) {
+            bg_sum += pixels[i];
+            bg_count++;
+        }
+    }
+    uint8_t fill = bg_count ? (uint8_t)((bg_sum + bg_count / 2) / bg_count) : 0;
+    if (fill_out) *fill_out = fill;
+
+    uint8_t *row_map = out;
+    memset(row_map, 0, (size_t)words_h * 4);
+    size_t o = (size_t)words_h * 4;
+
+    // Values go after all masks; compute mask bytes first, then back-fill
+    uint8_t *masks = out + o;
+    size_t mask_bytes = 0;
+    // Rows are packed by the detector's bitplane stage in chunks through an
+    // aligned buffer, since `out` carries no alignment guarantee
+    uint32_t chunk[64];
+    const int chunk_px = 32 * (int)(sizeof(chunk) / sizeof(chunk[0]));
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = &pixels[y * width];
+        bool any = false;
+        for (int x0 = 0; x0 < width; x0 += chunk_px) {
+            int n = width - x0 < chunk_px ? width - x0 : chunk_px;
+            bitplane_pack_row(&row[x0], n, threshold, chunk);
+            for (int w = 0; w < bitplane_stride(n); w++) {
+                store_u32(&masks[mask_bytes + (size_t)(x0 / 32 + w) * 4], chunk[w]);
+                if (chunk[w]) any = true;
+            }
+        }
+        if (any) {
+            mask_bytes += (size_t)words_w * 4;
+            uint32_t rm = load_u32(&row_map[(y / 32) * 4]);
+            store_u32(&row_map[(y / 32) * 4], rm | (1u << (y & 31)));
+        }
+    }
+    o += mask_bytes;
+
+    uint8_t *vals = out + o;
+    size_t v = 0;
+    for (int i = 0; i < width * height; i++) {
+        if (pixels[i] >= threshold) vals[v++] = pixels[i];
+    }
+    return o + v;
+}
+
+static bool bitplane_decode(const uint8_t *src, size_t n, uint8_t fill,
+                            int width, int height, uint8_t *out)
+{
+    int words_w = (width + 31) / 32;
+    int words_h = (height + 31) / 32;
+    if (n < (size_t)words_h * 4) return false;
+
+    memset(out, fill, (size_t)width * height);
+
+    // Count set rows to locate the value stream
+    size_t set_rows = 0;
+    for (int w = 0; w < words_h; w++) {
+        set_rows += (size_t)__builtin_popcount(load_u32(&src[w * 4]));
+    }
+    size_t masks_off = (size_t)words_h * 4;
+    size_t vals_off  = masks_off + set_rows * (size_t)words_w * 4;
+    if (vals_off > n) return false;
+
+    const uint8_t *mask = src + masks_off;
+    const uint8_t *vals = src + vals_off;
+    const uint8_t *vals_end = src + n;
+
+    for (int wh = 0; wh < words_h; wh++) {
+        uint32_t rows = load_u32(&src[wh * 4]);
+        while (rows) {
+            int y = wh * 32 + __builtin_ctz(rows);
+            rows &= rows - 1;
+            if (y >= height) return false;
+            uint8_t *row = &out[y * width];
+            for (int w = 0; w < words_w; w++) {
+                uint32_t bits = load_u32(mask);
+                mask += 4;
+                while (bits) {
+                    int x = w * 32 + __builtin_ctz(bits);
+                    bits &= bits - 1;
+                    if (x >= width || vals >= vals_end) return false;
+                    row[x] = *vals++;
+                }
+            }
+        }
+    }
+    return vals == vals_end;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+size_t frec_encode_bound(frec_codec_t codec, int width, int height)
+{
+    size_t n = (size_t)width * (size_t)height;
+    switch (codec) {
+        case FREC_CODEC_RAW:
+            return n;
+        case FREC_CODEC_RLE:
+            return n + n / RLE_MAX_LIT + 1;
+        case FREC_CODEC_BITPLANE:
+            return (size_t)((height + 31) / 32) * 4 +
+                   (size_t)height * (size_t)((width + 31) / 32) * 4 + n;
+        default:
+            return 0;
+    }
+}
+
+size_t frec_encode(frec_codec_t codec, const uint8_t *pixels, int width, int height,
+                   uint8_t threshold, uint8_t *fill_out, uint8_t *out)
+{
+    size_t n = (size_t)width * (size_t)height;
+    if (fill_out) *fill_out = 0;
+
+    switch (codec) {
+        case FREC_CODEC_RAW:
+            memcpy(out, pixels, n);
+            return n;
+        case FREC_CODEC_RLE:
+            return rle_encode(pixels, n, out);
+        case FREC_CODEC_BITPLANE:
+            return bitplane_encode(pixels, width, height, threshold, fill_out, out);
+        default:
+            return 0;
+    }
+}
+
+bool frec_decode(const frec_frame_header_t *fh, const uint8_t *payload,
+                 int width, int height, uint8_t *out)
+{
+    size_t n = (size_t)width * (size_t)height;
+
+    switch (fh->codec) {
+        case FREC_CODEC_RAW:
+            if (fh->payload_size != n) return false;
+            memcpy(out, payload, n);
+            return true;
+        case FREC_CODEC_RLE:
+            return rle_decode(payload, fh->payload_size, out, n);
+        case FREC_CODEC_BITPLANE:
+            return bitplane_decode(payload, fh->payload_size, fh->fill,
+                                   width, height, out);
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef FRAME_RECORD_H
+#define FRAME_RECORD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// ---------------------------------------------------------------------------
+// Recorded-frame container (.cfr) — grayscale frame sequences for tuning and
+// benchmarking the detector on real night rides.
+//
+// Layout (all fields little-endian, every record 8-byte aligned):
+//
+//   frec_file_header_t                     32 bytes
+//   { frec_frame_header_t + payload } * N  payload padded to 8 bytes
+//   frec_index_entry_t * N                 seek index (offset, timestamp)
+//   frec_trailer_t                         16 bytes, last in file
+//
+// The trailing index lets a reader seek by frame number or timestamp without
+// scanning; the header's index_offset is patched in when the writer closes,
+// and the trailer repeats it so truncated-header files can still be opened.
+//
+// Payload codecs:
+//   RAW       width*height bytes, readable in place (zero-copy through mmap)
+//   RLE       PackBits-style byte runs — lossless; good on clipped black skies
+//   BITPLANE  1 bit per pixel for pixels >= threshold, plus their values;
+//             all other pixels decode to the frame's `fill` value. Lossy
+//             below threshold but exact for everything the detector labels.
+// ---------------------------------------------------------------------------
+
+#define FREC_MAGIC          0x31524643u   // "CFR1"
+#define FREC_TRAILER_MAGIC  0x58524643u   // "CFRX"
+#define FREC_VERSION        1
+
+typedef enum {
+    FREC_CODEC_RAW      = 0,
+    FREC_CODEC_RLE      = 1,
+    FREC_CODEC_BITPLANE = 2,
+} frec_codec_t;
+
+typedef struct {
+    uint32_t magic;          // FREC_MAGIC
+    uint16_t version;        // FREC_VERSION
+    uint16_t header_size;    // sizeof(frec_file_header_t)
+    uint16_t width;
+    uint16_t height;
+    uint32_t fps_milli;      // Nominal capture rate * 1000
+    uint32_t frame_count;
+    uint32_t flags;          // Reserved, 0
+    uint64_t index_offset;   // Byte offset of the seek index (0 while writing)
+} frec_file_header_t;
+
+// Sensor state at capture time — lets replays reproduce exposure conditions
+typedef struct {
+    uint16_t aec_value;      // Exposure (sensor AEC units), 0 if unknown
+    uint8_t  agc_gain;       // Analog gain code, 0 if unknown
+    uint8_t  flags;          // FREC_META_* bits
+    uint32_t sensor_seq;     // Sensor / driver frame counter, 0 if unknown
+} frec_meta_t;
+
+#define FREC_META_AEC_AUTO  0x01   // Sensor auto-exposure was enabled
+#define FREC_META_AGC_AUTO  0x02   // Sensor auto-gain was enabled
+
+typedef struct {
+    uint64_t    timestamp_us;   // Capture time, microseconds since recording start
+    uint32_t    payload_size;   // Encoded bytes following this header (unpadded)
+    uint8_t     codec;          // frec_codec_t
+    uint8_t     threshold;      // BITPLANE: lowest stored value
+    uint8_t     fill;           // BITPLANE: value of all sub-threshold pixels
+    uint8_t     reserved;
+    frec_meta_t meta;
+} frec_frame_header_t;
+
+typedef struct {
+    uint64_t offset;            // Byte offset of the frec_frame_header_t
+    uint64_t timestamp_us;
+} frec_index_entry_t;
+
+typedef struct {
+    uint64_t index_offset;
+    uint32_t frame_count;
+    uint32_t magic;             // FREC_TRAILER_MAGIC
+} frec_trailer_t;
+
+/** Records are padded so every header and index entry stays 8-byte aligned. */
+static inline size_t frec_align(size_t n)
+{
+    return (n + 7u) & ~(size_t)7u;
+}
+
+/** Worst-case encoded size for a width x height frame with the given codec. */
+size_t frec_encode_bound(frec_codec_t codec, int width, int height);
+
+/**
+ * Encode one frame.
+ *
+ * @param codec      Payload codec
+ * @param pixels     Grayscale frame (row-major, 1 byte per pixel)
+ * @param threshold  BITPLANE only: pixels >= threshold are stored exactly
+ * @param fill_out   BITPLANE only: receives the fill value (may be NULL otherwise)
+ * @param out        Destination, at least frec_encode_bound() bytes
+ * @return           Encoded size in bytes, or 0 on an unknown codec
+ */
+size_t frec_encode(frec_codec_t codec, const uint8_t *pixels, int width, int height,
+                   uint8_t threshold, uint8_t *fill_out, uint8_t *out);
+
+/**
+ * Decode one frame payload into `out` (width * height bytes).
+ * Returns false if the payload is malformed or truncated.
+ */
+bool frec_decode(const frec_frame_header_t *fh, const uint8_t *payload,
+                 int width, int height, uint8_t *out);
+
+#ifdef __cplusplus
+}
+
+static_assert(sizeof(frec_file_header_t)  == 32, "frec_file_header_t layout");
+static_assert(sizeof(frec_frame_header_t) == 24, "frec_frame_header_t layout");
+static_assert(sizeof(frec_index_entry_t)  == 16, "frec_index_entry_t layout");
+static_assert(sizeof(frec_trailer_t)      == 16, "frec_trailer_t layout");
+#endif
+
+#endif // FRAME_RECORD_H
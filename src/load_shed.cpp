@@ -0,0 +1,114 @@
+#include "load_shed.h"
+#include <string.h>
+#include "config.h"
+#include "esp_log.h"
+
+static const char *TAG = "load";
+
+#define CALM_MAX  (LOAD_SHED_CALM_FRAMES * 8)
+
+void load_shed_init(load_shed_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->calm_needed = LOAD_SHED_CALM_FRAMES;
+    s->since_relax = UINT32_MAX;   // No step up to relapse from yet
+}
+
+void load_shed_quality(load_shed_level_t level, detect_quality_t *q)
+{
+    static const detect_quality_t full = DETECT_QUALITY_FULL;
+    *q = full;
+    if (level >= LOAD_SHED_ROI)       q->roi_percent = LOAD_SHED_ROI_PERCENT;
+    if (level >= LOAD_SHED_NO_MERGE)  q->merge       = 0;
+    if (level >= LOAD_SHED_FEW_BLOBS) q->max_blobs   = LOAD_SHED_MAX_BLOBS;
+    if (level >= LOAD_SHED_DECIMATE)  q->row_step    = 2;
+}
+
+// Scaled by pct: under the limits at 100, calm at LOAD_SHED_CALM_PCT
+static bool within(const uint32_t stage_us[LOAD_STAGE_COUNT], uint32_t latency_us,
+                   uint32_t pct)
+{
+    return (uint64_t)stage_us[LOAD_STAGE_DETECT] * 100 <= (uint64_t)LOAD_BUDGET_DETECT_US * pct &&
+           (uint64_t)stage_us[LOAD_STAGE_TRACK]  * 100 <= (uint64_t)LOAD_BUDGET_TRACK_US  * pct &&
+           (uint64_t)latency_us                  * 100 <= (uint64_t)LOAD_DEADLINE_US      * pct;
+}
+
+bool load_shed_update(load_shed_t *s, const uint32_t stage_us[LOAD_STAGE_COUNT],
+                      uint32_t age_us)
+{
+    memcpy(s->stage_us, stage_us, sizeof(s->stage_us));
+    s->latency_us = age_us + stage_us[LOAD_STAGE_DETECT] + stage_us[LOAD_STAGE_TRACK];
+    s->frames_at[s->level]++;
+    if (s->since_relax < UINT32_MAX) s->since_relax++;
+    s->changed = false;
+
+    if (LOAD_DEADLINE_US == 0) return false;
+
+    s->missed = !within(stage_us, s->latency_us, 100);
+    if (s->missed) {
+        s->misses++;
+        s->calm_run = 0;
+        if (++s->miss_run < LOAD_SHED_MISS_FRAMES) return false;
+        s->miss_run = 0;
+        if (s->level + 1 >= LOAD_SHED_LEVELS) return false;
+
+        // Relapse: the level we gave back was still needed
+        if (s->since_relax <= s->calm_needed && s->calm_needed < CALM_MAX) {
+            s->calm_needed *= 2;
+        }
+        s->since_relax = UINT32_MAX;
+        s->level++;
+        s->steps_down++;
+        s->changed = true;
+        return true;
+    }
+
+    s->miss_run = 0;
+    if (s->level == LOAD_SHED_NONE) {
+        // A long spell at full quality forgives earlier relapses
+        if (s->since_relax > CALM_MAX) s->calm_needed = LOAD_SHED_CALM_FRAMES;
+        return false;
+    }
+    if (!within(stage_us, s->latency_us, LOAD_SHED_CALM_PCT)) {
+        s->calm_run = 0;
+        return false;
+    }
+    if (++s->calm_run < s->calm_needed) return false;
+
+    s->calm_run    = 0;
+    s->since_relax = 0;
+    s->level--;
+    s->steps_up++;
+    s->changed = true;
+    return true;
+}
+
+const char *load_shed_level_str(load_shed_level_t level)
+{
+    switch (level) {
+        case LOAD_SHED_NONE:      return "full";
+        case LOAD_SHED_ROI:       return "roi";
+        case LOAD_SHED_NO_MERGE:  return "no-merge";
+        case LOAD_SHED_FEW_BLOBS: return "few-blobs";
+        case LOAD_SHED_DECIMATE:  return "decimate";
+        default:                  return "?";
+    }
+}
+
+void load_shed_log(const load_shed_t *s)
+{
+    ESP_LOGI(TAG, "LOAD level=%s capture=%lu detect=%lu track=%lu latency=%lu us "
+                  "misses=%lu down=%lu up=%lu calm=%u frames=%lu/%lu/%lu/%lu/%lu",
+             load_shed_level_str((load_shed_level_t)s->level),
+             (unsigned long)s->stage_us[LOAD_STAGE_CAPTURE],
+             (unsigned long)s->stage_us[LOAD_STAGE_DETECT],
+             (unsigned long)s->stage_us[LOAD_STAGE_TRACK],
+             (unsigned long)s->latency_us,
+             (unsigned long)s->misses, (unsigned long)s->steps_down,
+             (unsigned long)s->steps_up, (unsigned)s->calm_needed,
+             (unsigned long)s->frames_at[LOAD_SHED_NONE],
+             (unsigned long)s->frames_at[LOAD_SHED_ROI],
+             (unsigned long)s->frames_at[LOAD_SHED_NO_MERGE],
+             (unsigned long)s->frames_at[LOAD_SHED_FEW_BLOBS],
+             (unsigned long)s->frames_at[LOAD_SHED_DECIMATE]);
+}
@@ -0,0 +1,90 @@
+#ifndef LOAD_SHED_H
+#define LOAD_SHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "detector.h"
+
+// ---------------------------------------------------------------------------
+// Load shedding — per-frame deadline scheduler for the detect task
+//
+// A scene full of lights (rain, a city centre, oncoming high beams) makes
+// detection slower, and with GRAB_LATEST every output then ages with it.
+// pipeline_process_frame() times each stage and hands the times, plus the
+// frame's age at dequeue (camera.h), to load_shed_update(). A frame misses
+// its deadline when a stage overruns its budget or the result is ready
+// later than LOAD_DEADLINE_US after capture (limits in config.h).
+//
+// Sustained misses step quality down one level at a time; each level keeps
+// the savings of the ones before it:
+//
+//   ROI       scan only the central LOAD_SHED_ROI_PERCENT of the ROI band
+//   NO_MERGE  skip the nearby-blob merge
+//   FEW_BLOBS keep the largest LOAD_SHED_MAX_BLOBS blobs for tracking
+//   DECIMATE  label every other row (bitplane path)
+//
+// A level is given back after a calm spell. Relapsing soon after doubles
+// the calm spell needed next time (up to 8x), so a load that sits right at
+// the edge probes full quality every few hundred frames instead of flapping.
+// ---------------------------------------------------------------------------
+
+typedef enum {
+    LOAD_SHED_NONE = 0,
+    LOAD_SHED_ROI,
+    LOAD_SHED_NO_MERGE,
+    LOAD_SHED_FEW_BLOBS,
+    LOAD_SHED_DECIMATE,
+    LOAD_SHED_LEVELS
+} load_shed_level_t;
+
+typedef enum {
+    LOAD_STAGE_CAPTURE = 0,   // Waiting for a frame (not held to a budget)
+    LOAD_STAGE_DETECT,        // detect_blobs + release
+    LOAD_STAGE_TRACK,         // tracker_classify
+    LOAD_STAGE_COUNT
+} load_stage_t;
+
+typedef struct {
+    uint8_t  level;                       // load_shed_level_t in force
+    uint8_t  miss_run;                    // Consecutive missed frames
+    uint16_t calm_run;                    // Consecutive calm frames
+    uint16_t calm_needed;                 // Calm frames to step back up
+    uint32_t since_relax;                 // Frames since the last step up (UINT32_MAX: none since the last step down)
+    uint32_t stage_us[LOAD_STAGE_COUNT];  // Last frame
+    uint32_t latency_us;                  // Last frame: age + detect + track
+    bool     missed;                      // Last frame missed its deadline
+    bool     changed;                     // Level changed on the last update
+    uint32_t misses;                      // Totals since load_shed_init()
+    uint32_t steps_down;
+    uint32_t steps_up;
+    uint32_t frames_at[LOAD_SHED_LEVELS];
+} load_shed_t;
+
+/** Start at full quality with cleared counters. */
+void load_shed_init(load_shed_t *s);
+
+/** Detection settings for `level`. */
+void load_shed_quality(load_shed_level_t level, detect_quality_t *q);
+
+/**
+ * Account one processed frame and pick the level for the next one.
+ * Returns true if the level changed.
+ */
+bool load_shed_update(load_shed_t *s, const uint32_t stage_us[LOAD_STAGE_COUNT],
+                      uint32_t age_us);
+
+/** Short name of a level for logs. */
+const char *load_shed_level_str(load_shed_level_t level);
+
+/** Log one "LOAD ..." line: level, last frame's stage times, totals. */
+void load_shed_log(const load_shed_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOAD_SHED_H
@@ -5,9 +5,15 @@
 #include "esp_timer.h"
 
 #include "config.h"
+#include "boot_time.h"
 #include "camera.h"
+#include "config_cmd.h"
 #include "detector.h"
-#include "triangulation.h"
+#include "mem_budget.h"
+#include "mem_telemetry.h"
+#include "pipeline.h"
+#include "runtime_config.h"
+#include "uart_link.h"
 
 // Compile-time role check — must define exactly one of CAM_ROLE_PRIMARY or
 // CAM_ROLE_SECONDARY via build flags in platformio.ini.
@@ -16,33 +22,7 @@
 #endif
 
 #define ONBOARD_LED  33  // AI-Thinker ESP32-CAM onboard LED (active low)
-
-// ---------------------------------------------------------------------------
-// UART packet format: secondary -> primary
-//
-// Fixed-size binary frame for minimum overhead:
-//   Byte 0:      0xAA  (header / sync byte)
-//   Byte 1:      blob_count  (0..MAX_BLOBS_TX)
-//   Bytes 2..N:  MAX_BLOBS_TX slots * 6 bytes each:
-//                  [cx_hi][cx_lo][cy_hi][cy_lo][pc_hi][pc_lo]
-//
-// Packet size = 2 + MAX_BLOBS_TX * 6 = 20 bytes
-// At 115200 baud: ~20 * 10 / 115200 ≈ 1.7 ms — negligible vs frame time.
-//
-// NOTE: 0xAA can appear in blob data (e.g. cx = 170).  If sync is lost,
-//       the primary discards bytes until it sees 0xAA, then reads a full
-//       packet.  For a bench test this is fine.  If repeated sync loss
-//       occurs, switch to a two-byte header (0xAA 0x55).
-// ---------------------------------------------------------------------------
-#define UART_PACKET_HEADER  0xAA
-#define MAX_BLOBS_TX        3        // Blobs per packet (3 is plenty for test)
-#define UART_PACKET_SIZE    (2 + MAX_BLOBS_TX * 6)   // = 20 bytes
-
-typedef struct {
-    uint16_t cx;
-    uint16_t cy;
-    uint16_t pixel_count;  // Capped at 65535 — fine for SVGA
-} uart_blob_t;
+#define MEM_REPORT_FRAME  100  // Primary: log budget vs. high-water marks once warmed up
 
 // ---------------------------------------------------------------------------
 // HardwareSerial for inter-camera link (primary side only)
@@ -57,116 +37,122 @@ static HardwareSerial CamSerial(1);  // UART1, remapped to GPIO13 RX
 #ifdef CAM_ROLE_SECONDARY
 static void send_blobs_uart(const detection_result_t *result)
 {
-    int n = result->blob_count;
-    if (n > MAX_BLOBS_TX) n = MAX_BLOBS_TX;
-
-    Serial.write((uint8_t)UART_PACKET_HEADER);
-    Serial.write((uint8_t)n);
-
-    for (int i = 0; i < MAX_BLOBS_TX; i++) {
-        uint8_t buf[6] = {0};
-        if (i < n) {
-            const blob_t *b = &result->blobs[i];
-            buf[0] = (uint8_t)(b->cx >> 8);
-            buf[1] = (uint8_t)(b->cx & 0xFF);
-            buf[2] = (uint8_t)(b->cy >> 8);
-            buf[3] = (uint8_t)(b->cy & 0xFF);
-            uint16_t pc = (b->pixel_count > 65535u) ? 65535u
-                                                     : (uint16_t)b->pixel_count;
-            buf[4] = (uint8_t)(pc >> 8);
-            buf[5] = (uint8_t)(pc & 0xFF);
-        }
-        Serial.write(buf, 6);
-    }
+    uint8_t pkt[UART_PACKET_SIZE];
+    size_t len = uart_link_encode(result, pkt);
+    Serial.write(pkt, len);
 }
 #endif  // CAM_ROLE_SECONDARY
 
 // ---------------------------------------------------------------------------
-// Primary: receive a blob packet from secondary via CamSerial (UART1 / GPIO13)
-// Returns true when a complete packet was parsed.
+// Primary: receive blob packets from secondary via CamSerial (UART1 / GPIO13)
+// Consumes every byte waiting in the UART buffer and keeps the newest
+// complete packet, so a slow primary never falls behind a backlog of stale
+// packets. A corrupt packet clears the secondary blob list.
+// Returns true when at least one complete packet was parsed.
 // ---------------------------------------------------------------------------
 #ifdef CAM_ROLE_PRIMARY
+static uart_link_parser_t s_link_parser;
+
 static bool recv_blobs_uart(uart_blob_t out_blobs[], int *out_count)
 {
-    // Drain until we find the header byte
-    while (CamSerial.available() > 0 && CamSerial.peek() != UART_PACKET_HEADER) {
-        CamSerial.read();
+    bool got = false;
+    while (CamSerial.available() > 0) {
+        int c = CamSerial.read();
+        if (c < 0) break;
+        uart_link_status_t st = uart_link_parser_feed(&s_link_parser, (uint8_t)c,
+                                                      out_blobs, out_count);
+        if (st == UART_LINK_PACKET) {
+            got = true;
+        } else if (st == UART_LINK_CORRUPT) {
+            *out_count = 0;
+        }
     }
+    return got;
+}
+#endif  // CAM_ROLE_PRIMARY
 
-    if (CamSerial.available() < UART_PACKET_SIZE) {
-        return false;  // Incomplete packet — try next frame
-    }
+// ---------------------------------------------------------------------------
+// Config commands on the debug UART (Serial RX, both roles) — see config_cmd.h
+// Runs in loop(), never in the detect task: edits a staged copy and posts it
+// to the detect task, retrying while the previous post is still pending.
+// ---------------------------------------------------------------------------
+static config_cmd_parser_t s_cmd_parser;
+static runtime_config_t    s_cmd_staged;
+static bool                s_cmd_post_due;
 
-    CamSerial.read();  // Consume header
+static void send_cmd_reply(const uint8_t reply[CONFIG_CMD_SIZE])
+{
+#ifdef CAM_ROLE_PRIMARY
+    Serial.write(reply, CONFIG_CMD_SIZE);
+#else
+    (void)reply;  // Serial TX carries blob packets
+#endif
+}
 
-    int n = CamSerial.read();
-    if (n < 0 || n > MAX_BLOBS_TX) {
-        // Corrupt count byte — flush and give up this packet
-        while (CamSerial.available()) CamSerial.read();
-        *out_count = 0;
-        return false;
-    }
+static void poll_config_cmds(void)
+{
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c < 0) break;
+
+        config_cmd_t cmd;
+        uint8_t reply[CONFIG_CMD_SIZE];
+        config_cmd_status_t st = config_cmd_parser_feed(&s_cmd_parser, (uint8_t)c, &cmd);
+        if (st == CONFIG_CMD_CORRUPT) {
+            config_cmd_encode(CONFIG_CMD_NAK, CONFIG_CMD_ERR_CHECKSUM, 0, reply);
+            send_cmd_reply(reply);
+            continue;
+        }
+        if (st != CONFIG_CMD_FRAME) continue;
 
-    *out_count = n;
-    for (int i = 0; i < MAX_BLOBS_TX; i++) {
-        uint8_t buf[6];
-        CamSerial.readBytes(buf, 6);
-        if (i < n) {
-            out_blobs[i].cx          = ((uint16_t)buf[0] << 8) | buf[1];
-            out_blobs[i].cy          = ((uint16_t)buf[2] << 8) | buf[3];
-            out_blobs[i].pixel_count = ((uint16_t)buf[4] << 8) | buf[5];
+        config_cmd_action_t action = config_cmd_execute(&cmd, &s_cmd_staged, reply);
+        if (action == CONFIG_CMD_ACTION_SAVE && runtime_config_save(&s_cmd_staged) != ESP_OK) {
+            config_cmd_encode(CONFIG_CMD_NAK, CONFIG_CMD_ERR_STORAGE, cmd.op, reply);
         }
+        if (action != CONFIG_CMD_ACTION_NONE) s_cmd_post_due = true;
+        send_cmd_reply(reply);
     }
-    return true;
+
+    if (s_cmd_post_due && runtime_config_post(&s_cmd_staged)) s_cmd_post_due = false;
 }
-#endif  // CAM_ROLE_PRIMARY
 
 // ---------------------------------------------------------------------------
 // FreeRTOS detection task — runs on core 0
 // ---------------------------------------------------------------------------
 static void detection_task(void *arg)
 {
-    uint32_t frame_num   = 0;
-    int64_t  fps_timer   = esp_timer_get_time();
-    uint32_t fps_count   = 0;
-    float    current_fps = 0.0f;
+    boot_time_mark(BOOT_STAGE_TASK);
 
-    tracker_state_t tracker;
-    tracker_reset(&tracker);
+    pipeline_t pipe;
+    pipeline_init(&pipe);
 
 #ifdef CAM_ROLE_PRIMARY
     uart_blob_t secondary_blobs[MAX_BLOBS_TX];
     int         secondary_count = 0;
+    uint16_t    config_gen      = runtime_config_active()->generation;
 #endif
 
     while (1) {
-        // --- Capture ---
-        camera_fb_t *fb = camera_capture_frame();
-        if (!fb) {
-            vTaskDelay(pdMS_TO_TICKS(100));
+        // --- Capture, detect, classify ---
+        detection_result_t result;
+        if (!pipeline_process_frame(&pipe, &result)) {
+            // camera_capture_frame() escalates to sensor / driver resets on
+            // its own; tracker state in pipe survives the outage
+            vTaskDelay(pdMS_TO_TICKS(10));
             continue;
         }
 
-        // --- Detect blobs ---
-        detection_result_t result;
-        detect_blobs(fb->buf, fb->width, fb->height, &result);
-        camera_release_frame(fb);
-
-        // --- Classify blobs with inter-frame tracking ---
-        tracker_classify(&tracker, &result);
-
-        // --- FPS (updated every second) ---
-        fps_count++;
-        int64_t now        = esp_timer_get_time();
-        int64_t elapsed_us = now - fps_timer;
-        if (elapsed_us >= 1000000LL) {
-            current_fps = (float)fps_count * 1000000.0f / (float)elapsed_us;
-            fps_count   = 0;
-            fps_timer   = now;
+        // Time to first detection. Only the primary prints it: the
+        // secondary's TX (GPIO1) is the blob link, and text on it costs the
+        // primary's parser a resync. The secondary still marks its stages
+        // for a bench build to read.
+        if (pipe.frame_num == 1) {
+            boot_time_mark(BOOT_STAGE_FIRST_RESULT);
+#ifdef CAM_ROLE_PRIMARY
+            boot_time_log();
+#endif
         }
 
-        frame_num++;
-
         // ================================================================
         // SECONDARY role: send blob data, no verbose serial
         // ================================================================
@@ -178,7 +164,7 @@ static void detection_task(void *arg)
         // (bench calibration mode):
         //
         // Serial.printf("SEC #%lu | FPS:%.1f | blobs:%d\n",
-        //               (unsigned long)frame_num, current_fps,
+        //               (unsigned long)pipe.frame_num, pipe.current_fps,
         //               result.blob_count);
 #endif
 
@@ -189,53 +175,71 @@ static void detection_task(void *arg)
         // Non-blocking read — use whatever is in the UART buffer
         recv_blobs_uart(secondary_blobs, &secondary_count);
 
-        // Triangulate: match primary blobs to secondary.
-        // Uses 2D proximity + positive X-disparity check.
-        // No strict cy-only epipolar — works when bike leans and baseline tilts.
-        float distance_m = -1.0f;
-        int   match_pri  = -1;
-        int   match_sec  = -1;
-        if (result.blob_count > 0 && secondary_count > 0) {
-            int best_score = 0x7FFFFFFF;
-            for (int pi = 0; pi < result.blob_count; pi++) {
-                for (int si = 0; si < secondary_count; si++) {
-                    // X-disparity must be positive (secondary LEFT sees blob
-                    // further right than primary RIGHT for forward objects)
-                    int dx = (int)secondary_blobs[si].cx - (int)result.blobs[pi].cx;
-                    if (dx < STEREO_MIN_DISPARITY) continue;
-
-                    // Total 2D distance between centroids — cap at reasonable max
-                    int dy = (int)secondary_blobs[si].cy - (int)result.blobs[pi].cy;
-                    int dist2d = dx + (dy < 0 ? -dy : dy);  // Manhattan approx
-                    if (dist2d > 200) continue;  // Too far apart — not same object
-
-                    // Score: prefer close 2D match, then large blobs
-                    int size_bonus = (int)(result.blobs[pi].pixel_count > 10000
-                                          ? 10000 : result.blobs[pi].pixel_count);
-                    int score = dist2d * 10 - size_bonus;
-                    if (score < best_score) {
-                        best_score = score;
-                        match_pri  = pi;
-                        match_sec  = si;
-                    }
-                }
-            }
-            if (match_pri >= 0) {
-                distance_m = triangulate_distance(
-                    result.blobs[match_pri].cx,
-                    result.blobs[match_pri].cy,
-                    secondary_blobs[match_sec].cx,
-                    secondary_blobs[match_sec].cy);
-            }
+        if (pipe.frame_num == MEM_REPORT_FRAME) mem_budget_report();
+#if MEM_TELEMETRY_PERIOD > 0
+        // Heap/stack drift over a long ride; the secondary cannot print (GPIO1)
+        if (pipe.frame_num % MEM_TELEMETRY_PERIOD == 0) {
+            mem_sample_t ms;
+            mem_telemetry_sample(pipe.frame_num, &ms);
+            mem_telemetry_log(&ms);
+            load_shed_log(&pipe.shed);
         }
+#endif
+
+        // Triangulate: match primary blobs to secondary.
+        stereo_match_t match = pipeline_stereo_match(&result, secondary_blobs,
+                                                     secondary_count);
+        float distance_m = match.distance_m;
+        int   match_pri  = match.pri;
+        int   match_sec  = match.sec;
 
         // --- Serial report ---
         Serial.printf("\n--- Frame #%lu | FPS: %.1f | Brightness: %lu ---\n",
-                      (unsigned long)frame_num,
-                      current_fps,
+                      (unsigned long)pipe.frame_num,
+                      pipe.current_fps,
                       (unsigned long)result.scene_brightness);
+        // Age at dequeue and sensor frames the driver overwrote (GRAB_LATEST)
+        uint32_t period_us = pipe.frame_clock.period_us;
+        Serial.printf("  Age: %lu ms | Dropped: %lu (total %lu) | Sensor: %.1f fps\n",
+                      (unsigned long)(pipe.last_frame.age_us / 1000),
+                      (unsigned long)pipe.last_frame.dropped,
+                      (unsigned long)pipe.frames_dropped,
+                      period_us ? 1000000.0f / (float)period_us : 0.0f);
+        if (pipe.shed.changed) {
+            Serial.printf("  Load: quality -> %s (detect %lu ms, latency %lu ms)\n",
+                          load_shed_level_str((load_shed_level_t)pipe.shed.level),
+                          (unsigned long)(pipe.shed.stage_us[LOAD_STAGE_DETECT] / 1000),
+                          (unsigned long)(pipe.shed.latency_us / 1000));
+        }
+
+        if (pipe.exposure.changed) {
+            if (pipe.exposure.out.manual) {
+                Serial.printf("  Exposure: %u lines, gain %u (worst core %lu px)\n",
+                              (unsigned)pipe.exposure.out.aec_lines,
+                              (unsigned)pipe.exposure.out.gain,
+                              (unsigned long)pipe.exposure.worst_sat);
+            } else {
+                Serial.println("  Exposure: sensor AEC/AGC (day mode)");
+            }
+        }
+        if (pipe.thr.threshold) {
+            Serial.printf("  Threshold: %u (cut %u, bright %u.%u%%)\n",
+                          (unsigned)pipe.thr.threshold, (unsigned)pipe.thr.target,
+                          (unsigned)(result.scene.bright_permille / 10),
+                          (unsigned)(result.scene.bright_permille % 10));
+        }
 
-        if (result.blob_count == 0) {
+        const runtime_config_t *cfg = runtime_config_active();
+        if (cfg->generation != config_gen) {
+            config_gen = cfg->generation;
+            Serial.printf("  Config gen %u applied (threshold %u)\n",
+                          (unsigned)cfg->generation, (unsigned)cfg->brightness_threshold);
+        }
+
+        if (result.status == DETECT_STATUS_DAYLIGHT) {
+            Serial.println(pipe.day_mode ? "  Daylight: detection paused"
+                                         : "  Daylight: frame not labelled");
+        } else if (result.blob_count == 0) {
             Serial.println("  No blobs");
         } else {
             Serial.printf("  Blobs: %d\n", result.blob_count);
@@ -290,6 +294,14 @@ static void detection_task(void *arg)
             Serial.println("  Distance: N/A (no match)");
         }
 #endif  // CAM_ROLE_PRIMARY
+
+        // Day mode: nothing to range, so look only now and then until a
+        // night frame comes back (frees the CPU; GRAB_LATEST hands us a
+        // fresh frame after the wait). The frames slept through are not drops.
+        if (pipe.day_mode) {
+            vTaskDelay(pdMS_TO_TICKS(DAY_MODE_FRAME_MS));
+            camera_frame_clock_pause(&pipe.frame_clock);
+        }
     }
 }
 
@@ -298,8 +310,11 @@ static void detection_task(void *arg)
 // ---------------------------------------------------------------------------
 void setup()
 {
+    boot_time_mark(BOOT_STAGE_SETUP);
     Serial.begin(UART_BAUD);
-    delay(500);
+#if !CAMTEST_FAST_BOOT
+    delay(500);  // Give a serial monitor time to attach before the banner
+#endif
 
     gpio_set_direction((gpio_num_t)ONBOARD_LED, GPIO_MODE_OUTPUT);
     gpio_set_level((gpio_num_t)ONBOARD_LED, 0);  // Active low — ON
@@ -318,28 +333,42 @@ void setup()
     // Verbose Serial.print calls after this point will corrupt packets.
 #endif
 
+    // Tuning from NVS if saved, else config.h; active from the first frame
+    esp_err_t cfg_err = runtime_config_load(&s_cmd_staged);
+    runtime_config_post(&s_cmd_staged);
+
+#if !CAMTEST_FAST_BOOT
     Serial.printf("Resolution target: %dx%d SVGA\n", FRAME_WIDTH, FRAME_HEIGHT);
     Serial.printf("CPU: %lu MHz\n", (unsigned long)getCpuFrequencyMhz());
-    Serial.printf("Brightness threshold: %d\n", BRIGHTNESS_THRESHOLD);
-    Serial.printf("Blob size: %d - %d px\n", MIN_BLOB_PIXELS, MAX_BLOB_PIXELS);
+    Serial.printf("Config: %s v%d\n", cfg_err == ESP_OK ? "NVS" : "defaults",
+                  RUNTIME_CONFIG_VERSION);
+    Serial.printf("Brightness threshold: %u\n", (unsigned)s_cmd_staged.brightness_threshold);
+    Serial.printf("Blob size: %lu - %lu px\n", (unsigned long)s_cmd_staged.min_blob_pixels,
+                  (unsigned long)s_cmd_staged.max_blob_pixels);
+#else
+    (void)cfg_err;
+#endif
 
+    // Keep retrying with a power-cycled sensor instead of halting; the LED
+    // blinks once per attempt
     esp_err_t err = camera_init();
-    if (err != ESP_OK) {
-        Serial.printf("Camera FAILED (0x%x) — halting\n", err);
-        while (1) {
-            gpio_set_level((gpio_num_t)ONBOARD_LED, 1);
-            delay(200);
-            gpio_set_level((gpio_num_t)ONBOARD_LED, 0);
-            delay(200);
-        }
+    while (err != ESP_OK) {
+        Serial.printf("Camera FAILED (0x%x) — power-cycling and retrying\n", err);
+        gpio_set_level((gpio_num_t)ONBOARD_LED, 1);
+        delay(200);
+        gpio_set_level((gpio_num_t)ONBOARD_LED, 0);
+        err = camera_recover(CAMERA_RECOVER_FULL);
     }
 
+    boot_time_mark(BOOT_STAGE_CAMERA);
+#if !CAMTEST_FAST_BOOT
     Serial.println("Camera OK. Starting detection task on core 0...");
+#endif
 
     xTaskCreatePinnedToCore(
         detection_task,
         "detect",
-        8192,   // Increased from 4096: tracker state + UART buffers
+        DETECT_TASK_STACK,  // Sized by mem_budget.cpp (was 4096: too small)
         NULL,
         5,
         NULL,
@@ -349,5 +378,6 @@ void setup()
 
 void loop()
 {
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    poll_config_cmds();
+    vTaskDelay(pdMS_TO_TICKS(20));
 }
@@ -0,0 +1,132 @@
+#include "mem_budget.h"
+#include "config.h"
+#include "bitplane.h"
+#include "detector.h"
+#include "pipeline.h"
+#include "uart_link.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+static const char *TAG = "mem";
+
+// ---------------------------------------------------------------------------
+// Compile-time accounting
+// Sizes mirror the allocations in the modules; keep them in step when an
+// allocation changes. Allowances (marked) cover code we do not own.
+// ---------------------------------------------------------------------------
+namespace {
+
+constexpr uint32_t FRAME_PX = (uint32_t)FRAME_WIDTH * FRAME_HEIGHT;
+
+// --- camera: grayscale frame buffers, plus the driver's DMA line buffers ---
+constexpr uint32_t CAMERA_PSRAM = CAMERA_FB_COUNT * FRAME_PX;
+constexpr uint32_t CAMERA_DRAM  = 16u * 1024u +     // Allowance: esp32-camera DMA descriptors/buffers
+                                  CAMERA_GRAB_TASK_STACK;
+
+// --- detector: per-frame scratch, peak of whichever path detect_blobs() runs ---
+constexpr uint32_t BITPLANE_BYTES   = (FRAME_WIDTH + 31) / 32 * 4u * FRAME_HEIGHT;
+constexpr uint32_t RUN_SCRATCH      = 2u * ((FRAME_WIDTH + 1) / 2) *
+                                      (uint32_t)(sizeof(bitplane_run_t) + sizeof(uint16_t));
+constexpr uint32_t ACCS_BYTES       = (uint32_t)(MAX_LABELS * sizeof(label_acc_t));
+// Label map: 8-bit map, plus the 16-bit map while a promotion widens it
+constexpr uint32_t LABELMAP_BYTES   = FRAME_PX * (1u + 2u);
+
+#if defined(ESP_PLATFORM) && defined(CAMTEST_HOT_IRAM)
+constexpr bool HOT_IN_DRAM = true;                  // placement.h: HOT_HEAP_CAPS internal
+#else
+constexpr bool HOT_IN_DRAM = false;
+#endif
+
+#if DETECTOR_BITPLANE
+constexpr uint32_t DETECT_HOT   = RUN_SCRATCH + ACCS_BYTES;
+constexpr uint32_t DETECT_PSRAM = BITPLANE_BYTES + (HOT_IN_DRAM ? 0 : DETECT_HOT);
+#else
+constexpr uint32_t DETECT_HOT   = ACCS_BYTES;
+constexpr uint32_t DETECT_PSRAM = LABELMAP_BYTES + (HOT_IN_DRAM ? 0 : DETECT_HOT);
+#endif
+constexpr uint32_t DETECT_DRAM  = (uint32_t)MAX_LABELS * sizeof(uint16_t) +   // parent[]
+                                  (HOT_IN_DRAM ? DETECT_HOT : 0);
+
+// --- detect task stack: locals on the deepest path, plus call frames ---
+constexpr uint32_t STACK_TASK      = sizeof(pipeline_t) + sizeof(detection_result_t) +
+                                     MAX_BLOBS_TX * sizeof(uart_blob_t) + UART_PACKET_SIZE;
+constexpr uint32_t STACK_DETECT    = sizeof(bitplane_t) + sizeof(blob_t) + 128;
+constexpr uint32_t STACK_TRACKER   = MAX_BLOBS * (sizeof(bool) + sizeof(int) +
+                                                  2 * sizeof(blob_class_t) + sizeof(uint8_t));
+constexpr uint32_t STACK_FRAMES    = 1536;          // Allowance: Xtensa window spills, ~16 frames x 96 B
+constexpr uint32_t STACK_PRINTF    = 2048;          // Allowance: newlib vfprintf (Serial.printf)
+
+// --- uart link: parser state is static ---
+constexpr uint32_t UART_DRAM = sizeof(uart_link_parser_t);
+
+constexpr uint32_t TOTAL_PSRAM = CAMERA_PSRAM + DETECT_PSRAM;
+constexpr uint32_t TOTAL_DRAM  = CAMERA_DRAM + DETECT_DRAM + UART_DRAM;
+constexpr uint32_t TOTAL_STACK = STACK_TASK + STACK_DETECT + STACK_TRACKER +
+                                 STACK_FRAMES + STACK_PRINTF;
+
+static_assert(TOTAL_PSRAM <= MEM_BUDGET_PSRAM_BYTES,
+              "config.h exceeds the PSRAM budget (frame size / CAMERA_FB_COUNT / labelling path)");
+static_assert(TOTAL_DRAM <= MEM_BUDGET_DRAM_BYTES,
+              "config.h exceeds the internal DRAM budget (MAX_LABELS / CAMTEST_HOT_IRAM)");
+static_assert(TOTAL_STACK <= DETECT_TASK_STACK,
+              "detect task stack too small for MAX_BLOBS; raise DETECT_TASK_STACK");
+
+} // namespace
+
+static const mem_budget_entry_t k_budget[] = {
+    { "camera",   CAMERA_PSRAM, CAMERA_DRAM, 0 },
+    { "detector", DETECT_PSRAM, DETECT_DRAM, STACK_DETECT },
+    { "tracker",  0,            0,           STACK_TRACKER },
+    { "task",     0,            0,           STACK_TASK + STACK_FRAMES + STACK_PRINTF },
+    { "uart",     0,            UART_DRAM,   0 },
+    { "total",    TOTAL_PSRAM,  TOTAL_DRAM,  TOTAL_STACK },
+};
+
+int mem_budget_table(const mem_budget_entry_t **rows)
+{
+    *rows = k_budget;
+    return (int)(sizeof(k_budget) / sizeof(k_budget[0]));
+}
+
+// ---------------------------------------------------------------------------
+// Runtime report
+// ---------------------------------------------------------------------------
+void mem_budget_report(void)
+{
+    const mem_budget_entry_t *rows;
+    int n = mem_budget_table(&rows);
+
+    ESP_LOGI(TAG, "Memory budget: %dx%d, %d frame buffers, MAX_BLOBS=%d, MAX_LABELS=%d",
+             FRAME_WIDTH, FRAME_HEIGHT, CAMERA_FB_COUNT, MAX_BLOBS, MAX_LABELS);
+    ESP_LOGI(TAG, "  %-8s %9s %9s %7s", "module", "psram", "dram", "stack");
+    for (int i = 0; i < n; i++) {
+        ESP_LOGI(TAG, "  %-8s %9lu %9lu %7lu", rows[i].module,
+                 (unsigned long)rows[i].psram, (unsigned long)rows[i].dram,
+                 (unsigned long)rows[i].stack);
+    }
+    ESP_LOGI(TAG, "  limits   %9lu %9lu %7lu",
+             (unsigned long)MEM_BUDGET_PSRAM_BYTES, (unsigned long)MEM_BUDGET_DRAM_BYTES,
+             (unsigned long)DETECT_TASK_STACK);
+
+#ifdef ESP_PLATFORM
+    // Peaks include every heap user (Arduino core, drivers), not just ours
+    size_t psram_total = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+    size_t psram_peak  = psram_total - heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+    size_t dram_total  = heap_caps_get_total_size(MALLOC_CAP_INTERNAL);
+    size_t dram_peak   = dram_total - heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    size_t stack_peak  = DETECT_TASK_STACK - uxTaskGetStackHighWaterMark(NULL);
+
+    ESP_LOGI(TAG, "  measured %9lu %9lu %7lu  (peak since boot, all users)",
+             (unsigned long)psram_peak, (unsigned long)dram_peak,
+             (unsigned long)stack_peak);
+    if (stack_peak > TOTAL_STACK) {
+        ESP_LOGW(TAG, "detect stack peak %lu exceeds the %lu budget — revisit STACK_* allowances",
+                 (unsigned long)stack_peak, (unsigned long)TOTAL_STACK);
+    }
+#endif
+}
@@ -0,0 +1,43 @@
+#ifndef MEM_BUDGET_H
+#define MEM_BUDGET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Static memory budget
+//
+// mem_budget.cpp derives, at compile time, the peak PSRAM, internal DRAM and
+// detect-task stack each module needs for the current config.h (resolution,
+// CAMERA_FB_COUNT, MAX_BLOBS, MAX_LABELS, labelling path, placement) and
+// static_asserts the totals against MEM_BUDGET_PSRAM_BYTES,
+// MEM_BUDGET_DRAM_BYTES and DETECT_TASK_STACK. The same table is kept at
+// runtime so the firmware can print it next to measured high-water marks.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const char *module;
+    uint32_t    psram;      // Peak PSRAM bytes
+    uint32_t    dram;       // Peak internal DRAM bytes (heap + static)
+    uint32_t    stack;      // Peak detect-task stack bytes
+} mem_budget_entry_t;
+
+/** Per-module budget rows; returns the row count. Last row is "total". */
+int mem_budget_table(const mem_budget_entry_t **rows);
+
+/**
+ * Log the budget table, then the measured high-water marks: PSRAM and
+ * internal heap used at their low points since boot, and the calling task's
+ * stack high-water mark (call it from the detect task). Host builds, which
+ * have no such counters, log the table only.
+ */
+void mem_budget_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_BUDGET_H
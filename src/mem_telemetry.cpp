@@ -0,0 +1,127 @@
+#include "mem_telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+static const char *TAG = "mem";
+
+// Tasks whose stack high-water marks are sampled, when they exist
+static const char *const k_tasks[MEM_TELEMETRY_MAX_TASKS] = {
+    "detect",       // main.cpp detection task
+    "loopTask",     // Arduino loop()
+    "cam_task",     // esp32-camera DMA task
+    "esp_timer",    // IDF timer task (esp_timer callbacks)
+};
+
+// Allocation counters (frame scratch is only allocated by the detect task)
+static uint32_t s_allocs;
+static uint64_t s_bytes;
+static uint32_t s_fallbacks;
+static uint32_t s_failures;
+
+// Previous sample, for per-frame rates
+static uint32_t s_last_frame;
+static uint32_t s_last_allocs;
+static uint64_t s_last_bytes;
+static uint32_t s_min_spiram_largest = UINT32_MAX;
+
+// ---------------------------------------------------------------------------
+// Counted allocation
+// ---------------------------------------------------------------------------
+void *mem_frame_alloc(size_t n, size_t size, uint32_t caps, bool zero)
+{
+    s_allocs++;
+    s_bytes += (uint64_t)n * size;
+
+    void *p = zero ? heap_caps_calloc(n, size, caps) : heap_caps_malloc(n * size, caps);
+    if (!p) {
+        p = zero ? calloc(n, size) : malloc(n * size);
+        if (p) s_fallbacks++;
+        else   s_failures++;
+    }
+    return p;
+}
+
+void mem_frame_free(void *p)
+{
+    if (p) heap_caps_free(p);
+}
+
+// ---------------------------------------------------------------------------
+// Sampling
+// ---------------------------------------------------------------------------
+#ifdef ESP_PLATFORM
+static void heap_sample(uint32_t caps, mem_heap_sample_t *h)
+{
+    h->free     = (uint32_t)heap_caps_get_free_size(caps);
+    h->largest  = (uint32_t)heap_caps_get_largest_free_block(caps);
+    h->min_free = (uint32_t)heap_caps_get_minimum_free_size(caps);
+    h->frag_permille = h->free ? (uint16_t)(1000u - (uint32_t)((uint64_t)h->largest * 1000u / h->free))
+                               : 0;
+}
+#endif
+
+void mem_telemetry_sample(uint32_t frame, mem_sample_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->frame = frame;
+
+#ifdef ESP_PLATFORM
+    heap_sample(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, &out->internal);
+    heap_sample(MALLOC_CAP_SPIRAM, &out->spiram);
+    if (out->spiram.largest < s_min_spiram_largest) s_min_spiram_largest = out->spiram.largest;
+    out->min_spiram_largest = s_min_spiram_largest;
+
+    for (int i = 0; i < MEM_TELEMETRY_MAX_TASKS; i++) {
+        TaskHandle_t t = xTaskGetHandle(k_tasks[i]);
+        if (!t) continue;
+        mem_task_sample_t *ts = &out->tasks[out->task_count++];
+        ts->name      = k_tasks[i];
+        ts->stack_hwm = (uint32_t)uxTaskGetStackHighWaterMark(t);  // Bytes on ESP-IDF
+    }
+#else
+    (void)k_tasks;
+    (void)s_min_spiram_largest;
+#endif
+
+    uint32_t frames = frame - s_last_frame;
+    if (frames > 0) {
+        out->allocs_per_frame = (float)(s_allocs - s_last_allocs) / (float)frames;
+        out->kbytes_per_frame = (float)(s_bytes - s_last_bytes) / 1024.0f / (float)frames;
+    }
+    out->fallbacks = s_fallbacks;
+    out->failures  = s_failures;
+
+    s_last_frame  = frame;
+    s_last_allocs = s_allocs;
+    s_last_bytes  = s_bytes;
+}
+
+void mem_telemetry_log(const mem_sample_t *s)
+{
+    char stacks[96];
+    int o = 0;
+    stacks[0] = '\0';
+    for (int i = 0; i < s->task_count && o < (int)sizeof(stacks); i++) {
+        o += snprintf(stacks + o, sizeof(stacks) - (size_t)o, " %s=%lu",
+                      s->tasks[i].name, (unsigned long)s->tasks[i].stack_hwm);
+    }
+
+    ESP_LOGI(TAG, "MEM frame=%lu int=%lu/%lu/%lu frag=%u ps=%lu/%lu/%lu frag=%u ps_big_min=%lu "
+                  "allocs/f=%.1f kb/f=%.1f fallback=%lu fail=%lu stack_free:%s",
+             (unsigned long)s->frame,
+             (unsigned long)s->internal.free, (unsigned long)s->internal.largest,
+             (unsigned long)s->internal.min_free, (unsigned)s->internal.frag_permille,
+             (unsigned long)s->spiram.free, (unsigned long)s->spiram.largest,
+             (unsigned long)s->spiram.min_free, (unsigned)s->spiram.frag_permille,
+             (unsigned long)(s->min_spiram_largest == UINT32_MAX ? 0 : s->min_spiram_largest),
+             s->allocs_per_frame, s->kbytes_per_frame,
+             (unsigned long)s->fallbacks, (unsigned long)s->failures, stacks);
+}
@@ -0,0 +1,69 @@
+#ifndef MEM_TELEMETRY_H
+#define MEM_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// ---------------------------------------------------------------------------
+// Runtime memory telemetry
+//
+// Per-frame scratch buffers (label maps, bitplanes, accumulators) go through
+// mem_frame_alloc() so allocations can be counted; mem_telemetry_sample()
+// snapshots the heaps and task stacks and turns the counters into per-frame
+// rates since the previous sample. Logged periodically, the samples show
+// whether free memory or the largest free block erode over a long ride.
+// ---------------------------------------------------------------------------
+
+#define MEM_TELEMETRY_MAX_TASKS  4
+
+typedef struct {
+    uint32_t free;              // Free bytes
+    uint32_t largest;           // Largest free block
+    uint32_t min_free;          // Lowest free bytes since boot
+    uint16_t frag_permille;     // 1000 * (1 - largest / free)
+} mem_heap_sample_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    stack_hwm;      // Unused stack bytes at the deepest point so far
+} mem_task_sample_t;
+
+typedef struct {
+    uint32_t          frame;          // Frame number the sample was taken at
+    mem_heap_sample_t internal;       // Internal DRAM heap
+    mem_heap_sample_t spiram;         // PSRAM heap
+    uint32_t          min_spiram_largest; // Smallest PSRAM largest-block seen in any sample
+    mem_task_sample_t tasks[MEM_TELEMETRY_MAX_TASKS];
+    int               task_count;
+    float             allocs_per_frame;   // mem_frame_alloc() calls per frame since last sample
+    float             kbytes_per_frame;   // ... and KB requested per frame
+    uint32_t          fallbacks;      // Total: requested caps failed, served by the C heap
+    uint32_t          failures;       // Total: no heap could serve the request
+} mem_sample_t;
+
+/**
+ * Allocate per-frame scratch from heap_caps `caps` (falling back to the C
+ * heap), zeroed if `zero`. Counted for telemetry. Free with mem_frame_free().
+ */
+void *mem_frame_alloc(size_t n, size_t size, uint32_t caps, bool zero);
+void  mem_frame_free(void *p);
+
+/**
+ * Take a sample at frame `frame`. Allocation rates cover the frames since
+ * the previous call. Heap and stack fields are zero on the host.
+ */
+void mem_telemetry_sample(uint32_t frame, mem_sample_t *out);
+
+/** Log a sample as one "MEM ..." line. */
+void mem_telemetry_log(const mem_sample_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_TELEMETRY_H
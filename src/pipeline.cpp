@@ -0,0 +1,135 @@
+#include "pipeline.h"
+#include "camera.h"
+#include "runtime_config.h"
+#include "triangulation.h"
+#include "esp_timer.h"
+
+void pipeline_init(pipeline_t *p)
+{
+    tracker_reset(&p->tracker);
+    p->frame_num    = 0;
+    p->fps_timer_us = esp_timer_get_time();
+    p->fps_count    = 0;
+    p->current_fps  = 0.0f;
+    camera_frame_clock_reset(&p->frame_clock,
+                             CAMERA_SENSOR_FPS ? 1000000u / CAMERA_SENSOR_FPS : 0);
+    p->last_frame.dropped = 0;
+    p->last_frame.age_us  = 0;
+    p->frames_dropped     = 0;
+    p->max_age_us         = 0;
+    load_shed_init(&p->shed);
+    p->daylight_run = 0;
+    p->day_mode     = false;
+    auto_threshold_init(&p->thr, runtime_config_active()->brightness_threshold);
+    exposure_ctrl_init(&p->exposure);
+}
+
+bool pipeline_process_frame(pipeline_t *p, detection_result_t *result)
+{
+    // --- Pick up a posted runtime config (frame boundary) ---
+    runtime_config_frame_begin();
+
+    // --- Capture ---
+    uint32_t stage_us[LOAD_STAGE_COUNT];
+    int64_t t0 = esp_timer_get_time();
+    camera_fb_t *fb = camera_capture_frame();
+    if (!fb) {
+        return false;
+    }
+    int64_t t1 = esp_timer_get_time();
+    camera_frame_clock_update(&p->frame_clock, fb, t1, &p->last_frame);
+    p->frames_dropped += p->last_frame.dropped;
+    if (p->last_frame.age_us > p->max_age_us) p->max_age_us = p->last_frame.age_us;
+
+    // --- Detect blobs, at the quality the load allows ---
+    detect_quality_t q;
+    load_shed_quality((load_shed_level_t)p->shed.level, &q);
+    q.threshold = p->thr.threshold;
+    detect_blobs_degraded(fb->buf, fb->width, fb->height, &q, result);
+    camera_release_frame(fb);
+    int64_t t2 = esp_timer_get_time();
+
+    // --- Day mode: entered after a run of washed-out frames, left on the first night frame ---
+    if (result->status == DETECT_STATUS_DAYLIGHT) {
+        if (p->daylight_run < UINT16_MAX) p->daylight_run++;
+    } else {
+        p->daylight_run = 0;
+    }
+    p->day_mode = p->daylight_run >= DAY_MODE_ENTER_FRAMES;
+
+    // --- Next frame's threshold from this frame's histogram (off at 0 permille) ---
+    const runtime_config_t *cfg = runtime_config_active();
+    auto_threshold_update(&p->thr, &result->scene, cfg->auto_threshold_permille,
+                          cfg->brightness_threshold, result->status == DETECT_STATUS_DAYLIGHT);
+
+    // --- Exposure for the frames to come; off for good if the backend has no control ---
+    if (exposure_ctrl_update(&p->exposure, result, p->day_mode)) {
+        esp_err_t err = camera_set_exposure(&p->exposure.out);
+        if (err == ESP_ERR_NOT_SUPPORTED) p->exposure.enabled = p->exposure.changed = false;
+        else if (err != ESP_OK)           p->exposure.write_errors++;
+    }
+
+    // --- Classify blobs with inter-frame tracking ---
+    tracker_classify(&p->tracker, result);
+    int64_t now = esp_timer_get_time();
+
+    // --- Deadline accounting; may change the next frame's quality ---
+    stage_us[LOAD_STAGE_CAPTURE] = (uint32_t)(t1 - t0);
+    stage_us[LOAD_STAGE_DETECT]  = (uint32_t)(t2 - t1);
+    stage_us[LOAD_STAGE_TRACK]   = (uint32_t)(now - t2);
+    load_shed_update(&p->shed, stage_us, p->last_frame.age_us);
+
+    // --- FPS (updated every second) ---
+    p->fps_count++;
+    int64_t elapsed_us = now - p->fps_timer_us;
+    if (elapsed_us >= 1000000LL) {
+        p->current_fps  = (float)p->fps_count * 1000000.0f / (float)elapsed_us;
+        p->fps_count    = 0;
+        p->fps_timer_us = now;
+    }
+
+    p->frame_num++;
+    return true;
+}
+
+stereo_match_t pipeline_stereo_match(const detection_result_t *result,
+                                     const uart_blob_t *sec, int sec_count)
+{
+    stereo_match_t m = { -1, -1, -1.0f };
+    if (result->blob_count == 0 || sec_count == 0) {
+        return m;
+    }
+
+    int best_score = 0x7FFFFFFF;
+    for (int pi = 0; pi < result->blob_count; pi++) {
+        for (int si = 0; si < sec_count; si++) {
+            // X-disparity must be positive (secondary LEFT sees blob
+            // further right than primary RIGHT for forward objects)
+            int dx = (int)sec[si].cx - (int)result->blobs[pi].cx;
+            if (dx < STEREO_MIN_DISPARITY) continue;
+
+            // Total 2D distance between centroids — cap at reasonable max
+            int dy = (int)sec[si].cy - (int)result->blobs[pi].cy;
+            int dist2d = dx + (dy < 0 ? -dy : dy);  // Manhattan approx
+            if (dist2d > 200) continue;  // Too far apart — not same object
+
+            // Score: prefer close 2D match, then large blobs
+            int size_bonus = (int)(result->blobs[pi].pixel_count > 10000
+                                  ? 10000 : result->blobs[pi].pixel_count);
+            int score = dist2d * 10 - size_bonus;
+            if (score < best_score) {
+                best_score = score;
+                m.pri      = pi;
+                m.sec      = si;
+            }
+        }
+    }
+    if (m.pri >= 0) {
+        m.distance_m = triangulate_distance(
+            result->blobs[m.pri].cx,
+            result->blobs[m.pri].cy,
+            sec[m.sec].cx,
+            sec[m.sec].cy);
+    }
+    return m;
+}
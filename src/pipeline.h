@@ -0,0 +1,75 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "auto_threshold.h"
+#include "camera.h"
+#include "detector.h"
+#include "exposure_ctrl.h"
+#include "load_shed.h"
+#include "uart_link.h"
+
+// ---------------------------------------------------------------------------
+// Per-frame detection pipeline — the body of detection_task without the
+// FreeRTOS / Serial plumbing, so the same code runs on the board and on a
+// Linux host against any capture backend (see camera.h).
+//
+//   config swap -> capture (+ drop/age accounting) -> detect_blobs -> release
+//   -> adaptive threshold (scene histogram picks the next frame's
+//   threshold, see auto_threshold.h) -> exposure control (clipped blob
+//   cores set the sensor exposure, see exposure_ctrl.h) -> tracker_classify
+//   -> FPS -> load shedding (stage times and frame age pick the next
+//   frame's detection quality, see load_shed.h)
+//   (primary) + stereo match against the latest secondary packet
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    tracker_state_t tracker;
+    uint32_t        frame_num;     // Frames processed since pipeline_init()
+    int64_t         fps_timer_us;  // Start of the current FPS window
+    uint32_t        fps_count;     // Frames in the current FPS window
+    float           current_fps;   // Updated once per second
+    camera_frame_clock_t frame_clock;
+    camera_frame_info_t  last_frame;   // Drops before / age of the latest frame
+    uint32_t        frames_dropped;    // Sensor frames never processed, total
+    uint32_t        max_age_us;        // Oldest frame at dequeue so far
+    load_shed_t     shed;
+    uint16_t        daylight_run;      // Consecutive DETECT_STATUS_DAYLIGHT frames
+    bool            day_mode;          // daylight_run >= DAY_MODE_ENTER_FRAMES
+    auto_threshold_t thr;              // Next frame's threshold (0: brightness_threshold)
+    exposure_ctrl_t exposure;          // Sensor exposure driven by the detector
+} pipeline_t;
+
+typedef struct {
+    int   pri;          // Index into the primary result, -1 if no match
+    int   sec;          // Index into the secondary blobs, -1 if no match
+    float distance_m;   // triangulate_distance() result, -1.0f if N/A
+} stereo_match_t;
+
+/** Reset tracker and counters. */
+void pipeline_init(pipeline_t *p);
+
+/**
+ * Capture one frame from the active camera backend, detect and classify.
+ * Returns false (result untouched) if the capture failed.
+ */
+bool pipeline_process_frame(pipeline_t *p, detection_result_t *result);
+
+/**
+ * Match primary blobs to secondary blobs and triangulate the best pair.
+ * Uses 2D proximity + positive X-disparity check.
+ * No strict cy-only epipolar — works when bike leans and baseline tilts.
+ */
+stereo_match_t pipeline_stereo_match(const detection_result_t *result,
+                                     const uart_blob_t *sec, int sec_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PIPELINE_H
@@ -0,0 +1,35 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+// ---------------------------------------------------------------------------
+// Hot-path memory placement (build option CAMTEST_HOT_IRAM)
+//
+// By default every function runs from flash through the instruction cache,
+// which the ESP32 shares with PSRAM traffic — and detect_blobs() streams a
+// whole frame plus its label map from PSRAM, evicting code as it goes.
+// With -DCAMTEST_HOT_IRAM the per-pixel and per-frame hot paths are linked
+// into IRAM and their small working tables kept in internal DRAM, so neither
+// competes with frame data for cache lines.
+//
+//   HOT_FN            function placed in IRAM (IRAM_ATTR)
+//   HOT_DATA          static data pinned in internal DRAM (DRAM_ATTR) —
+//                     needed for const tables, which otherwise go to flash
+//   HOT_HEAP_CAPS     heap_caps flags for small per-frame hot buffers
+//
+// Without the option (and on the host build) all three are no-ops / the
+// historical PSRAM-first allocation. Budget: see qemu/run_bench.sh, which
+// lists the IRAM bytes each HOT_FN symbol costs.
+// ---------------------------------------------------------------------------
+
+#if defined(ESP_PLATFORM) && defined(CAMTEST_HOT_IRAM)
+  #include "esp_attr.h"
+  #define HOT_FN         IRAM_ATTR
+  #define HOT_DATA       DRAM_ATTR
+  #define HOT_HEAP_CAPS  (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#else
+  #define HOT_FN
+  #define HOT_DATA
+  #define HOT_HEAP_CAPS  MALLOC_CAP_SPIRAM
+#endif
+
+#endif // PLACEMENT_H
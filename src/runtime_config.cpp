@@ -0,0 +1,212 @@
+#include "runtime_config.h"
+#include <string.h>
+#include <atomic>
+#include "config.h"
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "nvs.h"
+#endif
+
+static const char *TAG = "rcfg";
+
+#define RCFG_NVS_NAMESPACE  "camtest"
+#define RCFG_NVS_KEY        "rcfg"
+
+// Largest sensible pixel distance (Manhattan, across the whole frame)
+#define RCFG_MAX_DIST  (FRAME_WIDTH + FRAME_HEIGHT)
+
+static const runtime_config_t k_defaults = {
+    RUNTIME_CONFIG_VERSION,
+    0,
+    BRIGHTNESS_THRESHOLD,
+    TRACKER_STATIC_THRESHOLD,
+    TRACKER_VEHICLE_THRESHOLD,
+    TRACKER_CONFIRM_FRAMES,
+    TRACKER_MAX_MATCH_DIST,
+    BLOB_MERGE_DIST,
+    ROI_Y_START,
+    ROI_Y_END,
+    MIN_BLOB_PIXELS,
+    MAX_BLOB_PIXELS,
+    AUTO_THRESHOLD_PERMILLE,
+};
+
+// Detect-task side: the active copy. Writer side: one pending slot, owned by
+// whichever side s_pending_full says (false: writer, true: detect task).
+static runtime_config_t  s_active = k_defaults;
+static runtime_config_t  s_pending;
+static std::atomic<bool> s_pending_full(false);
+static uint16_t          s_generation;   // Writer-owned
+
+// ---------------------------------------------------------------------------
+// Values
+// ---------------------------------------------------------------------------
+void runtime_config_defaults(runtime_config_t *c)
+{
+    *c = k_defaults;
+}
+
+bool runtime_config_valid(const runtime_config_t *c)
+{
+    if (c->version != RUNTIME_CONFIG_VERSION) return false;
+    if (c->brightness_threshold == 0) return false;
+    if (c->min_blob_pixels == 0 || c->min_blob_pixels > c->max_blob_pixels) return false;
+    if (c->max_blob_pixels > (uint32_t)FRAME_WIDTH * FRAME_HEIGHT) return false;
+    if (c->blob_merge_dist > RCFG_MAX_DIST) return false;
+    if (c->roi_y_start >= FRAME_HEIGHT || c->roi_y_end > FRAME_HEIGHT) return false;
+    if (c->roi_y_end != 0 && c->roi_y_start >= c->roi_y_end) return false;
+    if (c->tracker_static_threshold >= c->tracker_vehicle_threshold) return false;
+    if (c->tracker_max_match_dist > RCFG_MAX_DIST) return false;
+    if (c->tracker_confirm_frames == 0) return false;
+    if (c->auto_threshold_permille >= DAY_BRIGHT_PERMILLE) return false;  // Would read as daylight
+    return true;
+}
+
+bool runtime_config_get(const runtime_config_t *c, int param, uint32_t *value)
+{
+    switch (param) {
+        case RCFG_INFO:                      *value = (uint32_t)c->version << 16 | c->generation; break;
+        case RCFG_BRIGHTNESS_THRESHOLD:      *value = c->brightness_threshold;      break;
+        case RCFG_MIN_BLOB_PIXELS:           *value = c->min_blob_pixels;           break;
+        case RCFG_MAX_BLOB_PIXELS:           *value = c->max_blob_pixels;           break;
+        case RCFG_BLOB_MERGE_DIST:           *value = c->blob_merge_dist;           break;
+        case RCFG_ROI_Y_START:               *value = c->roi_y_start;               break;
+        case RCFG_ROI_Y_END:                 *value = c->roi_y_end;                 break;
+        case RCFG_TRACKER_STATIC_THRESHOLD:  *value = c->tracker_static_threshold;  break;
+        case RCFG_TRACKER_VEHICLE_THRESHOLD: *value = c->tracker_vehicle_threshold; break;
+        case RCFG_TRACKER_MAX_MATCH_DIST:    *value = c->tracker_max_match_dist;    break;
+        case RCFG_TRACKER_CONFIRM_FRAMES:    *value = c->tracker_confirm_frames;    break;
+        case RCFG_AUTO_THRESHOLD_PERMILLE:   *value = c->auto_threshold_permille;   break;
+        default: return false;
+    }
+    return true;
+}
+
+esp_err_t runtime_config_set(runtime_config_t *c, int param, uint32_t value)
+{
+    runtime_config_t n = *c;
+
+    // Field-width checks here; cross-field checks in runtime_config_valid()
+    switch (param) {
+        case RCFG_BRIGHTNESS_THRESHOLD:
+            if (value > 255) return ESP_ERR_INVALID_ARG;
+            n.brightness_threshold = (uint8_t)value;
+            break;
+        case RCFG_MIN_BLOB_PIXELS:           n.min_blob_pixels = value; break;
+        case RCFG_MAX_BLOB_PIXELS:           n.max_blob_pixels = value; break;
+        case RCFG_BLOB_MERGE_DIST:
+            if (value > 0xFFFF) return ESP_ERR_INVALID_ARG;
+            n.blob_merge_dist = (uint16_t)value;
+            break;
+        case RCFG_ROI_Y_START:
+            if (value > 0xFFFF) return ESP_ERR_INVALID_ARG;
+            n.roi_y_start = (uint16_t)value;
+            break;
+        case RCFG_ROI_Y_END:
+            if (value > 0xFFFF) return ESP_ERR_INVALID_ARG;
+            n.roi_y_end = (uint16_t)value;
+            break;
+        case RCFG_TRACKER_STATIC_THRESHOLD:
+            if (value > 255) return ESP_ERR_INVALID_ARG;
+            n.tracker_static_threshold = (uint8_t)value;
+            break;
+        case RCFG_TRACKER_VEHICLE_THRESHOLD:
+            if (value > 255) return ESP_ERR_INVALID_ARG;
+            n.tracker_vehicle_threshold = (uint8_t)value;
+            break;
+        case RCFG_TRACKER_MAX_MATCH_DIST:
+            if (value > 0xFFFF) return ESP_ERR_INVALID_ARG;
+            n.tracker_max_match_dist = (uint16_t)value;
+            break;
+        case RCFG_TRACKER_CONFIRM_FRAMES:
+            if (value > 255) return ESP_ERR_INVALID_ARG;
+            n.tracker_confirm_frames = (uint8_t)value;
+            break;
+        case RCFG_AUTO_THRESHOLD_PERMILLE:
+            if (value > 0xFFFF) return ESP_ERR_INVALID_ARG;
+            n.auto_threshold_permille = (uint16_t)value;
+            break;
+        default:
+            return ESP_ERR_NOT_FOUND;   // Unknown, or RCFG_INFO (read-only)
+    }
+
+    if (!runtime_config_valid(&n)) return ESP_ERR_INVALID_ARG;
+    *c = n;
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Hand-over between frames
+// ---------------------------------------------------------------------------
+const runtime_config_t *runtime_config_active(void)
+{
+    return &s_active;
+}
+
+bool runtime_config_frame_begin(void)
+{
+    // A single atomic load per frame when nothing was posted
+    if (!s_pending_full.load(std::memory_order_acquire)) return false;
+    s_active = s_pending;
+    s_pending_full.store(false, std::memory_order_release);
+    return true;
+}
+
+bool runtime_config_post(const runtime_config_t *c)
+{
+    if (!runtime_config_valid(c)) return false;
+    if (s_pending_full.load(std::memory_order_acquire)) return false;  // Not consumed yet
+    s_pending = *c;
+    s_pending.generation = ++s_generation;
+    s_pending_full.store(true, std::memory_order_release);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Persistence
+// ---------------------------------------------------------------------------
+esp_err_t runtime_config_load(runtime_config_t *c)
+{
+    runtime_config_defaults(c);
+#ifdef ESP_PLATFORM
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(RCFG_NVS_NAMESPACE, NVS_READONLY, &h);
+    if (err != ESP_OK) return err;   // Namespace absent: nothing saved yet
+
+    runtime_config_t saved;
+    memset(&saved, 0, sizeof(saved));
+    size_t len = sizeof(saved);
+    err = nvs_get_blob(h, RCFG_NVS_KEY, &saved, &len);
+    nvs_close(h);
+    if (err != ESP_OK) return err;
+
+    if (len != sizeof(saved) || !runtime_config_valid(&saved)) {
+        ESP_LOGW(TAG, "Saved config v%u (%u bytes) not usable — using defaults",
+                 (unsigned)saved.version, (unsigned)len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *c = saved;
+    return ESP_OK;
+#else
+    (void)TAG;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t runtime_config_save(const runtime_config_t *c)
+{
+    if (!runtime_config_valid(c)) return ESP_ERR_INVALID_ARG;
+#ifdef ESP_PLATFORM
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(RCFG_NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+    err = nvs_set_blob(h, RCFG_NVS_KEY, c, sizeof(*c));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err != ESP_OK) ESP_LOGE(TAG, "NVS save failed: 0x%x", err);
+    return err;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
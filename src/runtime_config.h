@@ -0,0 +1,111 @@
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// ---------------------------------------------------------------------------
+// Runtime configuration — the tuning knobs of detect_blobs() and
+// tracker_classify(), adjustable without a rebuild
+//
+// config.h still provides the defaults. The detect task owns the active copy
+// and reads it once per frame; another task (the serial command handler)
+// posts a complete replacement, which runtime_config_frame_begin() swaps in
+// between frames. The hand-over is a single-slot mailbox guarded by one
+// atomic flag, so the hot loop never takes a lock and never sees a
+// half-written config.
+//
+// The struct is persisted to NVS as a blob tagged with
+// RUNTIME_CONFIG_VERSION; bump the version whenever the layout changes so a
+// stale blob falls back to the defaults instead of being misread.
+// ---------------------------------------------------------------------------
+#define RUNTIME_CONFIG_VERSION  2
+
+typedef struct {
+    uint16_t version;                   // RUNTIME_CONFIG_VERSION
+    uint16_t generation;                // Bumped by every runtime_config_post()
+    uint8_t  brightness_threshold;      // BRIGHTNESS_THRESHOLD
+    uint8_t  tracker_static_threshold;  // TRACKER_STATIC_THRESHOLD
+    uint8_t  tracker_vehicle_threshold; // TRACKER_VEHICLE_THRESHOLD
+    uint8_t  tracker_confirm_frames;    // TRACKER_CONFIRM_FRAMES
+    uint16_t tracker_max_match_dist;    // TRACKER_MAX_MATCH_DIST
+    uint16_t blob_merge_dist;           // BLOB_MERGE_DIST
+    uint16_t roi_y_start;               // ROI_Y_START
+    uint16_t roi_y_end;                 // ROI_Y_END (0 = full frame)
+    uint32_t min_blob_pixels;           // MIN_BLOB_PIXELS
+    uint32_t max_blob_pixels;           // MAX_BLOB_PIXELS
+    uint16_t auto_threshold_permille;   // AUTO_THRESHOLD_PERMILLE (0 = fixed threshold)
+} runtime_config_t;
+
+// Parameter ids used by the command protocol (config_cmd.h). Append only:
+// ids are part of the wire format.
+typedef enum {
+    RCFG_INFO                      = 0,   // Read-only: version << 16 | generation
+    RCFG_BRIGHTNESS_THRESHOLD      = 1,
+    RCFG_MIN_BLOB_PIXELS           = 2,
+    RCFG_MAX_BLOB_PIXELS           = 3,
+    RCFG_BLOB_MERGE_DIST           = 4,
+    RCFG_ROI_Y_START               = 5,
+    RCFG_ROI_Y_END                 = 6,
+    RCFG_TRACKER_STATIC_THRESHOLD  = 7,
+    RCFG_TRACKER_VEHICLE_THRESHOLD = 8,
+    RCFG_TRACKER_MAX_MATCH_DIST    = 9,
+    RCFG_TRACKER_CONFIRM_FRAMES    = 10,
+    RCFG_AUTO_THRESHOLD_PERMILLE   = 11,
+    RCFG_PARAM_COUNT
+} runtime_config_param_t;
+
+/** Fill with the config.h defaults. */
+void runtime_config_defaults(runtime_config_t *c);
+
+/** True if every field is in range and the pairs (min/max blob size,
+ *  static/vehicle threshold) are ordered. */
+bool runtime_config_valid(const runtime_config_t *c);
+
+/** Read parameter `param`. Returns false for an unknown id. */
+bool runtime_config_get(const runtime_config_t *c, int param, uint32_t *value);
+
+/**
+ * Set parameter `param`. The change is kept only if the whole config stays
+ * valid. Returns ESP_OK, ESP_ERR_NOT_FOUND (unknown or read-only id) or
+ * ESP_ERR_INVALID_ARG (out of range).
+ */
+esp_err_t runtime_config_set(runtime_config_t *c, int param, uint32_t value);
+
+// --- Hand-over between frames ---
+
+/** The config the detector and tracker use. Detect task only. */
+const runtime_config_t *runtime_config_active(void);
+
+/**
+ * Swap in a posted config, if any. Call from the detect task between
+ * frames (pipeline_process_frame() does). Returns true if it changed.
+ */
+bool runtime_config_frame_begin(void);
+
+/**
+ * Hand a complete config to the detect task; it takes effect at the next
+ * frame boundary. Returns false if `c` is invalid or the previous post has
+ * not been picked up yet (retry later). Single writer task only.
+ */
+bool runtime_config_post(const runtime_config_t *c);
+
+// --- Persistence (NVS; ESP_ERR_NOT_SUPPORTED on the host) ---
+
+/**
+ * Load the saved config into `c`. On any failure (nothing saved, version
+ * or size mismatch, invalid contents) `c` holds the defaults.
+ */
+esp_err_t runtime_config_load(runtime_config_t *c);
+esp_err_t runtime_config_save(const runtime_config_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RUNTIME_CONFIG_H
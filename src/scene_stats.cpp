@@ -0,0 +1,46 @@
+#include "scene_stats.h"
+#include <string.h>
+
+void scene_stats_sample(const uint8_t *pixels, int width, int y0, int y1,
+                        int step_x, int step_y, uint8_t threshold, scene_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->threshold = threshold;
+    if (step_x < 1) step_x = 1;
+    if (step_y < 1) step_y = 1;
+
+    // Half a step in, or the middle of a band / row shorter than a step
+    int oy = step_y / 2, ox = step_x / 2;
+    if (y1 - y0 <= oy) oy = (y1 - y0 - 1) / 2;
+    if (width <= ox)   ox = (width - 1) / 2;
+
+    uint32_t sum = 0, bright = 0, n = 0;
+    for (int y = y0 + oy; y < y1; y += step_y) {
+        const uint8_t *row = &pixels[(size_t)y * width];
+        if (step_x == 1) {
+            // Contiguous: branch-free sum / count, then the histogram
+            uint32_t rs = 0, rb = 0;
+            for (int x = 0; x < width; x++) {
+                rs += row[x];
+                rb += row[x] >= threshold;
+            }
+            for (int x = 0; x < width; x++) out->hist[row[x] >> 4]++;
+            sum += rs;
+            bright += rb;
+            n += (uint32_t)width;
+        } else {
+            for (int x = ox; x < width; x += step_x) {
+                uint8_t v = row[x];
+                sum    += v;
+                bright += v >= threshold;
+                out->hist[v >> 4]++;
+                n++;
+            }
+        }
+    }
+    if (n == 0) return;
+
+    out->samples         = n;
+    out->mean            = (uint8_t)(sum / n);
+    out->bright_permille = (uint16_t)((uint64_t)bright * 1000 / n);
+}
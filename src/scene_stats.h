@@ -0,0 +1,45 @@
+#ifndef SCENE_STATS_H
+#define SCENE_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// ---------------------------------------------------------------------------
+// Sparse scene statistics
+//
+// Scene brightness used to be a by-product of labelling: every ROI pixel was
+// summed into a 64-bit accumulator inside the threshold loop. A grid sample
+// (every step_x-th pixel of every step_y-th row, SCENE_SAMPLE_STEP_X/Y in
+// config.h) gives the same mean to within a level or two, plus a coarse
+// histogram and the bright share, for a few thousand loads per frame — and
+// the labelling loops are left with threshold work only.
+//
+// With step_x == 1 the sum / bright count runs over contiguous bytes in a
+// loop the host compiler vectorises; the histogram is always scalar.
+// ---------------------------------------------------------------------------
+#define SCENE_HIST_BINS   16    // 16 levels per bin
+
+typedef struct {
+    uint32_t samples;                   // Pixels sampled (0: nothing to sample)
+    uint8_t  mean;                      // Mean sampled value (0-255)
+    uint8_t  threshold;                 // Threshold bright_permille was counted at
+    uint16_t bright_permille;           // Share of samples >= threshold, 0-1000
+    uint32_t hist[SCENE_HIST_BINS];     // Sample counts, bin = value >> 4
+} scene_stats_t;
+
+/**
+ * Sample rows [y0, y1) of a width-wide frame. Sampling starts half a step
+ * in on both axes so the grid stays off the frame border; a band or row
+ * shorter than a step is sampled in its middle.
+ */
+void scene_stats_sample(const uint8_t *pixels, int width, int y0, int y1,
+                        int step_x, int step_y, uint8_t threshold, scene_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCENE_STATS_H
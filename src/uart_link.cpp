@@ -0,0 +1,65 @@
+#include "uart_link.h"
+#include <string.h>
+
+size_t uart_link_encode(const detection_result_t *result, uint8_t out[UART_PACKET_SIZE])
+{
+    int n = result->blob_count;
+    if (n < 0) n = 0;
+    if (n > MAX_BLOBS_TX) n = MAX_BLOBS_TX;
+
+    memset(out, 0, UART_PACKET_SIZE);
+    out[0] = (uint8_t)UART_PACKET_HEADER;
+    out[1] = (uint8_t)n;
+
+    for (int i = 0; i < n; i++) {
+        const blob_t *b = &result->blobs[i];
+        uint8_t *buf = &out[2 + i * 6];
+        buf[0] = (uint8_t)(b->cx >> 8);
+        buf[1] = (uint8_t)(b->cx & 0xFF);
+        buf[2] = (uint8_t)(b->cy >> 8);
+        buf[3] = (uint8_t)(b->cy & 0xFF);
+        uint16_t pc = (b->pixel_count > 65535u) ? 65535u
+                                                 : (uint16_t)b->pixel_count;
+        buf[4] = (uint8_t)(pc >> 8);
+        buf[5] = (uint8_t)(pc & 0xFF);
+    }
+    return UART_PACKET_SIZE;
+}
+
+void uart_link_parser_reset(uart_link_parser_t *p)
+{
+    p->len = 0;
+}
+
+uart_link_status_t uart_link_parser_feed(uart_link_parser_t *p, uint8_t byte,
+                                         uart_blob_t out_blobs[MAX_BLOBS_TX],
+                                         int *out_count)
+{
+    // Drain until we find the header byte
+    if (p->len == 0) {
+        if (byte == UART_PACKET_HEADER) p->buf[p->len++] = byte;
+        return UART_LINK_NONE;
+    }
+
+    if (p->len == 1 && byte > MAX_BLOBS_TX) {
+        // Corrupt count byte — drop this packet. The byte may itself be the
+        // header of the next packet if the previous 0xAA was blob data.
+        p->len = 0;
+        if (byte == UART_PACKET_HEADER) p->buf[p->len++] = byte;
+        return UART_LINK_CORRUPT;
+    }
+
+    p->buf[p->len++] = byte;
+    if (p->len < UART_PACKET_SIZE) return UART_LINK_NONE;
+
+    int n = p->buf[1];
+    for (int i = 0; i < n; i++) {
+        const uint8_t *buf = &p->buf[2 + i * 6];
+        out_blobs[i].cx          = ((uint16_t)buf[0] << 8) | buf[1];
+        out_blobs[i].cy          = ((uint16_t)buf[2] << 8) | buf[3];
+        out_blobs[i].pixel_count = ((uint16_t)buf[4] << 8) | buf[5];
+    }
+    *out_count = n;
+    p->len = 0;
+    return UART_LINK_PACKET;
+}
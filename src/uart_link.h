@@ -0,0 +1,75 @@
+#ifndef UART_LINK_H
+#define UART_LINK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "detector.h"
+
+// ---------------------------------------------------------------------------
+// UART packet format: secondary -> primary
+//
+// Fixed-size binary frame for minimum overhead:
+//   Byte 0:      0xAA  (header / sync byte)
+//   Byte 1:      blob_count  (0..MAX_BLOBS_TX)
+//   Bytes 2..N:  MAX_BLOBS_TX slots * 6 bytes each:
+//                  [cx_hi][cx_lo][cy_hi][cy_lo][pc_hi][pc_lo]
+//
+// Packet size = 2 + MAX_BLOBS_TX * 6 = 20 bytes
+// At 115200 baud: ~20 * 10 / 115200 ≈ 1.7 ms — negligible vs frame time.
+//
+// NOTE: 0xAA can appear in blob data (e.g. cx = 170).  If sync is lost,
+//       the primary discards bytes until it sees 0xAA, then reads a full
+//       packet.  For a bench test this is fine.  If repeated sync loss
+//       occurs, switch to a two-byte header (0xAA 0x55).
+//
+// The receiver is an incremental byte parser: it never assumes a read
+// returns a whole packet, so short reads and line noise cannot desync it
+// for longer than one packet.
+// ---------------------------------------------------------------------------
+#define UART_PACKET_HEADER  0xAA
+#define MAX_BLOBS_TX        3        // Blobs per packet (3 is plenty for test)
+#define UART_PACKET_SIZE    (2 + MAX_BLOBS_TX * 6)   // = 20 bytes
+
+typedef struct {
+    uint16_t cx;
+    uint16_t cy;
+    uint16_t pixel_count;  // Capped at 65535 — fine for SVGA
+} uart_blob_t;
+
+typedef enum {
+    UART_LINK_NONE    = 0,   // Byte consumed, no packet complete yet
+    UART_LINK_PACKET  = 1,   // A packet was decoded into the output arrays
+    UART_LINK_CORRUPT = 2,   // Bad count byte — packet dropped, resyncing
+} uart_link_status_t;
+
+typedef struct {
+    uint8_t buf[UART_PACKET_SIZE];
+    int     len;             // Bytes of the current packet (0 = hunting for header)
+} uart_link_parser_t;
+
+/**
+ * Serialise up to MAX_BLOBS_TX blobs (largest first, as detect_blobs() sorts
+ * them) into one packet. Returns UART_PACKET_SIZE.
+ */
+size_t uart_link_encode(const detection_result_t *result, uint8_t out[UART_PACKET_SIZE]);
+
+/** Start hunting for a header byte. Zero-initialisation is equivalent. */
+void uart_link_parser_reset(uart_link_parser_t *p);
+
+/**
+ * Feed one received byte. On UART_LINK_PACKET, out_blobs[0..*out_count) hold
+ * the decoded blobs; on any other status the outputs are untouched.
+ */
+uart_link_status_t uart_link_parser_feed(uart_link_parser_t *p, uint8_t byte,
+                                         uart_blob_t out_blobs[MAX_BLOBS_TX],
+                                         int *out_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_LINK_H